@@ -176,8 +176,6 @@ static const Bit8u ch_slot[18] = {
 // Envelope generator
 //
 
-using envelope_sinfunc = Bit16s (*)(Bit16u, Bit16u);
-
 static Bit16s OPL3_EnvelopeCalcExp(Bit32u level)
 {
     if (level > 0x1fff)
@@ -323,17 +321,6 @@ static Bit16s OPL3_EnvelopeCalcSin7(Bit16u phase, Bit16u envelope)
     return static_cast<Bit16s>(OPL3_EnvelopeCalcExp(static_cast<Bit32u>(out + (envelope << 3))) ^ neg);
 }
 
-static const envelope_sinfunc envelope_sin[8] = {
-    OPL3_EnvelopeCalcSin0,
-    OPL3_EnvelopeCalcSin1,
-    OPL3_EnvelopeCalcSin2,
-    OPL3_EnvelopeCalcSin3,
-    OPL3_EnvelopeCalcSin4,
-    OPL3_EnvelopeCalcSin5,
-    OPL3_EnvelopeCalcSin6,
-    OPL3_EnvelopeCalcSin7
-};
-
 enum envelope_gen_num
 {
     envelope_gen_num_attack = 0,
@@ -357,6 +344,14 @@ static void OPL3_EnvelopeCalc(opl3_slot *slot)
     Bit8u reg_rate = 0;
     Bit8u reset = 0;
     slot->eg_out = static_cast<Bit16s>(slot->eg_rout + (slot->reg_tl << 2) + (slot->eg_ksl >> kslshift[slot->reg_ksl]) + *slot->trem);
+    // A keyed off slot whose envelope has run out stays like that until
+    // it is keyed on again, which is most of them most of the time.
+    // Nothing below would change.
+    if (!slot->key && slot->eg_gen == envelope_gen_num_release && slot->eg_rout == 0x1ff)
+    {
+        slot->pg_reset = 0;
+        return;
+    }
     if (slot->key && slot->eg_gen == envelope_gen_num_release)
     {
         reset = 1;
@@ -637,7 +632,38 @@ static void OPL3_SlotWriteE0(opl3_slot *slot, Bit8u data)
 
 static void OPL3_SlotGenerate(opl3_slot *slot)
 {
-    slot->out = envelope_sin[slot->reg_wf](static_cast<Bit16u>(slot->pg_phase_out + *slot->mod), static_cast<Bit16u>(slot->eg_out));
+    auto phase = static_cast<Bit16u>(slot->pg_phase_out + *slot->mod);
+    auto envelope = static_cast<Bit16u>(slot->eg_out);
+
+    // A switch rather than a table of function pointers, so that the
+    // waveforms can be inlined
+    switch (slot->reg_wf)
+    {
+    case 0:
+        slot->out = OPL3_EnvelopeCalcSin0(phase, envelope);
+        break;
+    case 1:
+        slot->out = OPL3_EnvelopeCalcSin1(phase, envelope);
+        break;
+    case 2:
+        slot->out = OPL3_EnvelopeCalcSin2(phase, envelope);
+        break;
+    case 3:
+        slot->out = OPL3_EnvelopeCalcSin3(phase, envelope);
+        break;
+    case 4:
+        slot->out = OPL3_EnvelopeCalcSin4(phase, envelope);
+        break;
+    case 5:
+        slot->out = OPL3_EnvelopeCalcSin5(phase, envelope);
+        break;
+    case 6:
+        slot->out = OPL3_EnvelopeCalcSin6(phase, envelope);
+        break;
+    default:
+        slot->out = OPL3_EnvelopeCalcSin7(phase, envelope);
+        break;
+    }
 }
 
 static void OPL3_SlotCalcFB(opl3_slot *slot)
@@ -653,6 +679,17 @@ static void OPL3_SlotCalcFB(opl3_slot *slot)
     slot->prout = slot->out;
 }
 
+static inline void OPL3_ProcessSlots(opl3_chip *chip, Bit8u first, Bit8u last)
+{
+    for (Bit8u ii = first; ii < last; ii++)
+    {
+        OPL3_SlotCalcFB(&chip->slot[ii]);
+        OPL3_EnvelopeCalc(&chip->slot[ii]);
+        OPL3_PhaseGenerate(&chip->slot[ii]);
+        OPL3_SlotGenerate(&chip->slot[ii]);
+    }
+}
+
 //
 // Channel
 //
@@ -1013,13 +1050,7 @@ void OPL3_Generate(opl3_chip *chip, Bit16s *buf)
 {
     buf[1] = OPL3_ClipSample(chip->mixbuff[1]);
 
-    for (Bit8u ii = 0; ii < 15; ii++)
-    {
-        OPL3_SlotCalcFB(&chip->slot[ii]);
-        OPL3_EnvelopeCalc(&chip->slot[ii]);
-        OPL3_PhaseGenerate(&chip->slot[ii]);
-        OPL3_SlotGenerate(&chip->slot[ii]);
-    }
+    OPL3_ProcessSlots(chip, 0, 15);
 
     chip->mixbuff[0] = 0;
     for (auto &channel : chip->channel)
@@ -1032,23 +1063,11 @@ void OPL3_Generate(opl3_chip *chip, Bit16s *buf)
         chip->mixbuff[0] += static_cast<Bit16s>(accm & channel.cha);
     }
 
-    for (Bit8u ii = 15; ii < 18; ii++)
-    {
-        OPL3_SlotCalcFB(&chip->slot[ii]);
-        OPL3_EnvelopeCalc(&chip->slot[ii]);
-        OPL3_PhaseGenerate(&chip->slot[ii]);
-        OPL3_SlotGenerate(&chip->slot[ii]);
-    }
+    OPL3_ProcessSlots(chip, 15, 18);
 
     buf[0] = OPL3_ClipSample(chip->mixbuff[0]);
 
-    for (Bit8u ii = 18; ii < 33; ii++)
-    {
-        OPL3_SlotCalcFB(&chip->slot[ii]);
-        OPL3_EnvelopeCalc(&chip->slot[ii]);
-        OPL3_PhaseGenerate(&chip->slot[ii]);
-        OPL3_SlotGenerate(&chip->slot[ii]);
-    }
+    OPL3_ProcessSlots(chip, 18, 33);
 
     chip->mixbuff[1] = 0;
     for (auto &channel : chip->channel)
@@ -1061,13 +1080,7 @@ void OPL3_Generate(opl3_chip *chip, Bit16s *buf)
         chip->mixbuff[1] += static_cast<Bit16s>(accm & channel.chb);
     }
 
-    for (Bit8u ii = 33; ii < 36; ii++)
-    {
-        OPL3_SlotCalcFB(&chip->slot[ii]);
-        OPL3_EnvelopeCalc(&chip->slot[ii]);
-        OPL3_PhaseGenerate(&chip->slot[ii]);
-        OPL3_SlotGenerate(&chip->slot[ii]);
-    }
+    OPL3_ProcessSlots(chip, 33, 36);
 
     if ((chip->timer & 0x3f) == 0x3f)
     {
@@ -1322,11 +1335,87 @@ void OPL3_WriteRegBuffered(opl3_chip *chip, Bit16u reg, Bit8u v)
     chip->writebuf_last = (chip->writebuf_last + 1) % OPL_WRITEBUF_SIZE;
 }
 
+// Native rate samples generated at a time by OPL3_GenerateStream()
+constexpr auto OPL_BLOCK_SIZE = 256;
+
+// Same output as calling OPL3_GenerateResampled() numsamples times, but
+// the chip runs for a block of samples at a time before they are all
+// resampled in one go.
 void OPL3_GenerateStream(opl3_chip *chip, Bit16s *sndptr, Bit32u numsamples)
 {
-    for(Bit32u i = 0; i < numsamples; i++)
+    // block[0] holds the sample before the block, chip->samples
+    Bit16s block[2 * (OPL_BLOCK_SIZE + 1)];
+    const Bit32s rateratio = chip->rateratio;
+
+    while (numsamples > 0)
     {
-        OPL3_GenerateResampled(chip, sndptr);
-        sndptr += 2;
+        // How many output samples do the next OPL_BLOCK_SIZE native
+        // ones cover?
+        Bit32s samplecnt = chip->samplecnt;
+        Bit32u count = 0;
+        int native = 0;
+
+        while (count < numsamples)
+        {
+            int need = 0;
+            Bit32s cnt = samplecnt;
+            while (cnt >= rateratio)
+            {
+                cnt -= rateratio;
+                need++;
+            }
+            if (native + need > OPL_BLOCK_SIZE)
+            {
+                break;
+            }
+            native += need;
+            samplecnt = cnt + (1 << RSM_FRAC);
+            count++;
+        }
+
+        // An output rate this far below the chip's isn't worth blocking
+        if (count == 0)
+        {
+            OPL3_GenerateResampled(chip, sndptr);
+            sndptr += 2;
+            numsamples--;
+            continue;
+        }
+
+        block[0] = chip->samples[0];
+        block[1] = chip->samples[1];
+        for (int i = 1; i <= native; i++)
+        {
+            OPL3_Generate(chip, &block[2 * i]);
+        }
+
+        samplecnt = chip->samplecnt;
+        int idx = 0;
+        for (Bit32u i = 0; i < count; i++)
+        {
+            while (samplecnt >= rateratio)
+            {
+                samplecnt -= rateratio;
+                idx++;
+            }
+            const Bit16s *cur = &block[2 * idx];
+            const Bit16s *old = idx > 0 ? &block[2 * (idx - 1)] : chip->oldsamples;
+            sndptr[0] = static_cast<Bit16s>((old[0] * (rateratio - samplecnt)
+                            + cur[0] * samplecnt) / rateratio);
+            sndptr[1] = static_cast<Bit16s>((old[1] * (rateratio - samplecnt)
+                            + cur[1] * samplecnt) / rateratio);
+            samplecnt += 1 << RSM_FRAC;
+            sndptr += 2;
+        }
+
+        if (idx > 0)
+        {
+            chip->oldsamples[0] = block[2 * (idx - 1)];
+            chip->oldsamples[1] = block[2 * (idx - 1) + 1];
+        }
+        chip->samples[0] = block[2 * idx];
+        chip->samples[1] = block[2 * idx + 1];
+        chip->samplecnt = samplecnt;
+        numsamples -= count;
     }
 }
@@ -0,0 +1,413 @@
+//
+// Copyright(C) 1993-1996 Id Software, Inc.
+// Copyright(C) 2005-2014 Simon Howard
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//	Timedemo benchmark with per-tic phase timings.
+//
+//	A list of demos is played back as with -timedemo, one tic per
+//	frame.  For every frame the time spent in each phase is recorded,
+//	and once a demo ends the min/median/p99/max of each phase are
+//	kept.  After the last demo the results are written to a JSON or
+//	CSV file and the game quits.
+//
+//	-savebench times saving and loading a level stuffed with
+//	monsters that all point at each other, -thinkbench times running
+//	their thinkers.
+//
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "d_bench.hpp"
+
+#include "doomstat.hpp"
+#include "g_game.hpp"
+#include "i_system.hpp"
+#include "m_argv.hpp"
+#include "m_misc.hpp"
+#include "p_local.hpp"
+#include "p_saveg.hpp"
+#include "p_tick.hpp"
+
+#define BENCHSTATS 4 // min, median, p99, max
+
+#define THINKBENCHTICS (10 * TICRATE)
+
+struct benchresult_t
+{
+    char     lumpname[9];
+    int      tics;
+    uint64_t realtime;
+    uint64_t stats[NUMBENCHPHASES][BENCHSTATS];
+    int      sightcounts[3];
+};
+
+bool     benchmarking;
+uint64_t benchphasetime[NUMBENCHPHASES];
+
+static const char *benchphasenames[NUMBENCHPHASES] = {
+    "playsim",
+    "bsp",
+    "planes",
+    "masked",
+    "blit",
+    "total",
+};
+
+static const char *benchstatnames[BENCHSTATS] = {
+    "min",
+    "median",
+    "p99",
+    "max",
+};
+
+static benchresult_t *benchresults;
+static int            numbenchdemos;
+static int            currentbenchdemo;
+
+// frame timings of the demo currently playing, one array per phase
+static uint64_t *benchsamples[NUMBENCHPHASES];
+static int       numbenchsamples;
+static int       maxbenchsamples;
+static uint64_t  benchdemostart;
+
+void D_BenchAddDemo(const char *lumpname)
+{
+    benchresults = static_cast<decltype(benchresults)>(I_Realloc(benchresults, (numbenchdemos + 1) * sizeof(*benchresults)));
+    std::memset(&benchresults[numbenchdemos], 0, sizeof(*benchresults));
+    M_StringCopy(benchresults[numbenchdemos].lumpname, lumpname, sizeof(benchresults[numbenchdemos].lumpname));
+    numbenchdemos++;
+}
+
+static void BenchStartDemo()
+{
+    numbenchsamples = 0;
+    benchdemostart  = I_GetTimeUS();
+    std::memset(benchphasetime, 0, sizeof(benchphasetime));
+    std::memset(sightcounts, 0, sizeof(sightcounts));
+
+    G_TimeDemo(benchresults[currentbenchdemo].lumpname);
+}
+
+void D_StartBenchmark()
+{
+    if (!numbenchdemos)
+        I_Error("D_StartBenchmark: No demos to benchmark");
+
+    benchmarking     = true;
+    currentbenchdemo = 0;
+
+    BenchStartDemo();
+}
+
+void D_BenchFrame(uint64_t framestart)
+{
+    int i;
+
+    if (!benchmarking)
+        return;
+
+    benchphasetime[bp_total] = I_GetTimeUS() - framestart;
+
+    if (numbenchsamples == maxbenchsamples)
+    {
+        maxbenchsamples = maxbenchsamples ? 2 * maxbenchsamples : 4096;
+
+        for (i = 0; i < NUMBENCHPHASES; i++)
+        {
+            benchsamples[i] = static_cast<uint64_t *>(I_Realloc(benchsamples[i], maxbenchsamples * sizeof(**benchsamples)));
+        }
+    }
+
+    for (i = 0; i < NUMBENCHPHASES; i++)
+    {
+        benchsamples[i][numbenchsamples] = benchphasetime[i];
+        benchphasetime[i]                = 0;
+    }
+
+    numbenchsamples++;
+}
+
+static int CompareSamples(const void *a, const void *b)
+{
+    uint64_t x = *static_cast<const uint64_t *>(a);
+    uint64_t y = *static_cast<const uint64_t *>(b);
+
+    return (x > y) - (x < y);
+}
+
+static void BenchSummarize(benchresult_t *result)
+{
+    result->tics     = numbenchsamples;
+    result->realtime = I_GetTimeUS() - benchdemostart;
+    std::memcpy(result->sightcounts, sightcounts, sizeof(result->sightcounts));
+
+    if (!numbenchsamples)
+        return;
+
+    for (int i = 0; i < NUMBENCHPHASES; i++)
+    {
+        uint64_t *samples = benchsamples[i];
+        int       p99     = (numbenchsamples * 99 + 99) / 100 - 1;
+
+        qsort(samples, numbenchsamples, sizeof(*samples), CompareSamples);
+
+        result->stats[i][0] = samples[0];
+        result->stats[i][1] = samples[(numbenchsamples - 1) / 2];
+        result->stats[i][2] = samples[p99];
+        result->stats[i][3] = samples[numbenchsamples - 1];
+    }
+}
+
+static void WriteBenchJSON(FILE *file)
+{
+    fprintf(file, "{\n  \"demos\": [\n");
+
+    for (int d = 0; d < numbenchdemos; d++)
+    {
+        const benchresult_t *result = &benchresults[d];
+
+        fprintf(file, "    {\n");
+        fprintf(file, "      \"demo\": \"%s\",\n", result->lumpname);
+        fprintf(file, "      \"tics\": %d,\n", result->tics);
+        fprintf(file, "      \"realtime_ms\": %.3f,\n", result->realtime / 1000.0);
+        fprintf(file, "      \"phases_ms\": {\n");
+
+        for (int i = 0; i < NUMBENCHPHASES; i++)
+        {
+            fprintf(file, "        \"%s\": {", benchphasenames[i]);
+
+            for (int j = 0; j < BENCHSTATS; j++)
+            {
+                fprintf(file, " \"%s\": %.3f%s", benchstatnames[j],
+                    result->stats[i][j] / 1000.0, j < BENCHSTATS - 1 ? "," : " ");
+            }
+
+            fprintf(file, "}%s\n", i < NUMBENCHPHASES - 1 ? "," : "");
+        }
+
+        fprintf(file, "      },\n");
+        fprintf(file, "      \"sight_checks\": { \"rejected\": %d, \"traced\": %d, \"cached\": %d }\n",
+            result->sightcounts[0], result->sightcounts[1], result->sightcounts[2]);
+        fprintf(file, "    }%s\n", d < numbenchdemos - 1 ? "," : "");
+    }
+
+    fprintf(file, "  ]\n}\n");
+}
+
+static void WriteBenchCSV(FILE *file)
+{
+    fprintf(file, "demo,tics,phase");
+
+    for (int j = 0; j < BENCHSTATS; j++)
+    {
+        fprintf(file, ",%s_ms", benchstatnames[j]);
+    }
+
+    fprintf(file, "\n");
+
+    for (int d = 0; d < numbenchdemos; d++)
+    {
+        const benchresult_t *result = &benchresults[d];
+
+        for (int i = 0; i < NUMBENCHPHASES; i++)
+        {
+            fprintf(file, "%s,%d,%s", result->lumpname, result->tics, benchphasenames[i]);
+
+            for (int j = 0; j < BENCHSTATS; j++)
+            {
+                fprintf(file, ",%.3f", result->stats[i][j] / 1000.0);
+            }
+
+            fprintf(file, "\n");
+        }
+    }
+}
+
+static void WriteBenchResults()
+{
+    const char *filename = "benchmark.json";
+    FILE *      file;
+    int         p;
+
+    //!
+    // @arg <file>
+    // @category demo
+    //
+    // Write the results of -benchmark to the given file, instead of
+    // benchmark.json.  A file name ending in .csv selects CSV output,
+    // anything else gets JSON.
+    //
+
+    p = M_CheckParmWithArgs("-benchout", 1);
+
+    if (p)
+        filename = myargv[p + 1];
+
+    file = fopen(filename, "w");
+
+    if (file == nullptr)
+        I_Error("D_BenchDemoDone: Failed to open %s", filename);
+
+    if (M_StringEndsWith(filename, ".csv") || M_StringEndsWith(filename, ".CSV"))
+        WriteBenchCSV(file);
+    else
+        WriteBenchJSON(file);
+
+    fclose(file);
+
+    printf("Benchmark results written to %s.\n", filename);
+}
+
+bool D_BenchDemoDone()
+{
+    benchresult_t *result;
+
+    if (!benchmarking)
+        return false;
+
+    result = &benchresults[currentbenchdemo];
+    BenchSummarize(result);
+
+    printf("%s: timed %i gametics in %.3f s (%.3f ms median per tic)\n",
+        result->lumpname, result->tics, result->realtime / 1000000.0,
+        result->stats[bp_total][1] / 1000.0);
+    printf("%s: sight checks: %d rejected, %d traced, %d cached\n",
+        result->lumpname, result->sightcounts[0], result->sightcounts[1],
+        result->sightcounts[2]);
+
+    if (++currentbenchdemo < numbenchdemos)
+    {
+        BenchStartDemo();
+        return true;
+    }
+
+    benchmarking = false;
+    WriteBenchResults();
+
+    I_Quit();
+}
+
+// Spawn count monsters on top of the console player, each with a
+// target and a tracer pointing at other ones.
+
+static void BenchSpawnMonsters(int count)
+{
+    const mobj_t *pmo = g_doomstat_globals->players[g_doomstat_globals->consoleplayer].mo;
+    mobj_t      **mobjs;
+
+    mobjs = static_cast<mobj_t **>(I_Realloc(nullptr, static_cast<size_t>(count) * sizeof(*mobjs)));
+
+    for (int i = 0; i < count; i++)
+    {
+        mobjs[i] = P_SpawnMobj(pmo->x, pmo->y, ONFLOORZ, MT_POSSESSED);
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        mobjs[i]->target = mobjs[(i + 1) % count];
+        mobjs[i]->tracer = mobjs[(i * 7 + 3) % count];
+    }
+
+    free(mobjs);
+}
+
+void D_SaveGameBenchmark(int count)
+{
+    char    *filename = P_TempSaveGameFile();
+    uint64_t start;
+    uint64_t savetime;
+    uint64_t loadtime;
+
+    if (count <= 0)
+        I_Error("D_SaveGameBenchmark: Invalid number of monsters %d", count);
+
+    BenchSpawnMonsters(count);
+
+    // The same steps as G_DoSaveGame() and G_DoLoadGame(), minus the
+    // header and reloading the level, which don't depend on the
+    // number of thinkers.
+
+    start = I_GetTimeUS();
+    P_OpenSaveGameWrite();
+    P_ArchivePlayers();
+    P_ArchiveWorld();
+    P_ArchiveThinkers();
+    P_ArchiveSpecials();
+    P_WriteSaveGameEOF();
+    P_ClearThinkerIndex();
+    savetime = I_GetTimeUS() - start;
+
+    if (!P_WriteSaveGameFile(filename))
+        I_Error("D_SaveGameBenchmark: Failed to write %s", filename);
+    P_CloseSaveGame();
+
+    if (!P_OpenSaveGameRead(filename))
+        I_Error("D_SaveGameBenchmark: Failed to read %s", filename);
+
+    start = I_GetTimeUS();
+    P_UnArchivePlayers();
+    P_UnArchiveWorld();
+    P_UnArchiveThinkers();
+    P_UnArchiveSpecials();
+    P_RestoreTargets();
+    P_ClearThinkerIndex();
+    loadtime = I_GetTimeUS() - start;
+
+    if (!P_ReadSaveGameEOF())
+        I_Error("D_SaveGameBenchmark: Bad savegame");
+    P_CloseSaveGame();
+    remove(filename);
+
+    printf("savebench: %d monsters, saved in %.3f ms, loaded in %.3f ms\n",
+        count, savetime / 1000.0, loadtime / 1000.0);
+
+    I_Quit();
+}
+
+void D_ThinkerBenchmark(int count)
+{
+    uint64_t   tictimes[THINKBENCHTICS];
+    int        numthinkers = 0;
+    thinker_t *th;
+
+    if (count <= 0)
+        I_Error("D_ThinkerBenchmark: Invalid number of monsters %d", count);
+
+    BenchSpawnMonsters(count);
+
+    for (th = g_p_local_globals->thinkercap.next; th != &g_p_local_globals->thinkercap; th = th->next)
+    {
+        numthinkers++;
+    }
+
+    for (int i = 0; i < THINKBENCHTICS; i++)
+    {
+        uint64_t start = I_GetTimeUS();
+
+        P_RunThinkers();
+        leveltime++;
+        tictimes[i] = I_GetTimeUS() - start;
+    }
+
+    qsort(tictimes, THINKBENCHTICS, sizeof(*tictimes), CompareSamples);
+
+    printf("thinkbench: %d thinkers, %d tics, %.3f ms min, %.3f ms median, %.3f ms max per tic\n",
+        numthinkers, THINKBENCHTICS, tictimes[0] / 1000.0,
+        tictimes[(THINKBENCHTICS - 1) / 2] / 1000.0,
+        tictimes[THINKBENCHTICS - 1] / 1000.0);
+
+    I_Quit();
+}
@@ -0,0 +1,77 @@
+//
+// Copyright(C) 1993-1996 Id Software, Inc.
+// Copyright(C) 2005-2014 Simon Howard
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//	Timedemo benchmark with per-tic phase timings.
+//
+
+
+#ifndef __D_BENCH__
+#define __D_BENCH__
+
+#include <cstdint>
+
+#include "i_timer.hpp"
+
+enum benchphase_t
+{
+    bp_playsim, // P_Ticker()
+    bp_bsp,     // R_RenderBSPNode() and the deferred wall columns
+    bp_planes,  // R_DrawPlanes()
+    bp_masked,  // R_DrawMasked()
+    bp_blit,    // I_FinishUpdate()
+    bp_total,   // the whole frame
+    NUMBENCHPHASES
+};
+
+extern bool     benchmarking;
+extern uint64_t benchphasetime[NUMBENCHPHASES];
+
+// Time a phase of the current frame:
+//   uint64_t start = D_BenchBegin();
+//   ...
+//   D_BenchEnd(bp_bsp, start);
+
+inline uint64_t D_BenchBegin()
+{
+    return benchmarking ? I_GetTimeUS() : 0;
+}
+
+inline void D_BenchEnd(benchphase_t phase, uint64_t start)
+{
+    if (benchmarking)
+        benchphasetime[phase] += I_GetTimeUS() - start;
+}
+
+// Add a demo lump to the list to be benchmarked.
+void D_BenchAddDemo(const char *lumpname);
+
+// Start playing back the first demo.
+void D_StartBenchmark();
+
+// Record the phase timings of a frame that has just been displayed.
+void D_BenchFrame(uint64_t framestart);
+
+// Called when a timedemo ends.  Moves on to the next demo and returns
+// true, or writes the results and quits if this was the last one.
+bool D_BenchDemoDone();
+
+// Spawn count monsters into the level that has just been loaded, time
+// saving and loading it, print the results and quit.
+void D_SaveGameBenchmark(int count);
+
+// The same, but time running the thinkers for a while.
+void D_ThinkerBenchmark(int count);
+
+#endif
@@ -53,7 +53,9 @@
 #include "i_endoom.hpp"
 #include "i_input.hpp"
 #include "i_joystick.hpp"
+#include "i_sound.hpp"
 #include "i_system.hpp"
+#include "i_thread.hpp"
 #include "i_timer.hpp"
 #include "i_video.hpp"
 
@@ -70,6 +72,7 @@
 #include "p_setup.hpp"
 #include "r_local.hpp"
 #include "statdump.hpp"
+#include "d_bench.hpp"
 
 #include "lump.hpp"
 #include "memory.hpp"
@@ -450,6 +453,7 @@ void D_RunFrame()
     int         tics      = 0;
     static int  wipestart = 0;
     static bool wipe      = false;
+    uint64_t    framestart;
 
     if (wipe)
     {
@@ -467,6 +471,8 @@ void D_RunFrame()
         return;
     }
 
+    framestart = D_BenchBegin();
+
     // frame syncronous IO operations
     I_StartFrame();
 
@@ -488,10 +494,15 @@ void D_RunFrame()
         else
         {
             // normal update
+            uint64_t blitstart = D_BenchBegin();
             I_FinishUpdate(); // page flip or blit buffer
+            D_BenchEnd(bp_blit, blitstart);
         }
     }
 
+    // [crispy] -benchmark per-tic timings
+    D_BenchFrame(framestart);
+
     // [crispy] post-rendering function pointer to apply config changes
     // that affect rendering and that are better applied after the current
     // frame has finished rendering
@@ -1480,6 +1491,134 @@ static void G_CheckDemoStatusAtExit()
     G_CheckDemoStatus();
 }
 
+// Load the demo file for -playdemo, -timedemo or -benchmark and
+// return the name of its lump.
+
+static void D_AddDemoFile(const char *name, char *lumpname)
+{
+    char  file[256];
+    char *uc_filename = strdup(name);
+    M_ForceUppercase(uc_filename);
+
+    // With Vanilla you have to specify the file without extension,
+    // but make that optional.
+    if (M_StringEndsWith(uc_filename, ".LMP"))
+    {
+        M_StringCopy(file, name, sizeof(file));
+    }
+    else
+    {
+        DEH_snprintf(file, sizeof(file), "%s.lmp", name);
+    }
+
+    free(uc_filename);
+
+    if (D_AddFile(file))
+    {
+        M_StringCopy(lumpname, lumpinfo[numlumps - 1]->name, 9);
+    }
+    else
+    {
+        // If file failed to load, still continue trying to play
+        // the demo in the same way as Vanilla Doom.  This makes
+        // tricks like "-playdemo demo1" possible.
+
+        M_StringCopy(lumpname, name, 9);
+    }
+
+    printf("Playing demo %s.\n", file);
+}
+
+//
+// [crispy] Startup task graph.
+// The sound effects are converted on the free workers while the
+// renderer is set up.  Everything else goes through the zone or the WAD cache, so
+// it stays on the main thread, in the original order.
+//
+enum
+{
+    su_minit,
+    su_loadsounds,
+    su_rinit,
+    su_convertsounds,
+    su_pinit,
+    su_releasesounds,
+    su_sinit,
+    NUMSTARTUPTASKS
+};
+
+#define AFTER(task) (1u << (task))
+
+static uint64_t startuptime;
+
+static void StartupMInit()
+{
+    DEH_printf("M_Init: Init miscellaneous info.\n");
+    M_Init();
+}
+
+static void StartupLoadSounds()
+{
+    I_LoadSounds(S_sfx, NUMSFX);
+}
+
+static void StartupRInit()
+{
+    DEH_printf("R_Init: Init DOOM refresh daemon - ");
+    R_Init();
+}
+
+static void StartupConvertSounds()
+{
+    I_ConvertSounds();
+}
+
+static void StartupPInit()
+{
+    DEH_printf("\nP_Init: Init Playloop state.\n");
+    P_Init();
+}
+
+static void StartupReleaseSounds()
+{
+    I_ReleaseSounds();
+}
+
+static void StartupSInit()
+{
+    DEH_printf("S_Init: Setting up sound.\n");
+    S_Init(g_doomstat_globals->sfxVolume * 8, g_doomstat_globals->musicVolume * 8);
+}
+
+static workertask_t startuptasks[NUMSTARTUPTASKS] = {
+    { "M_Init", StartupMInit, 0, true },
+    { "I_LoadSounds", StartupLoadSounds, AFTER(su_minit), true },
+    { "R_Init", StartupRInit, AFTER(su_loadsounds), true },
+    { "I_ConvertSounds", StartupConvertSounds, AFTER(su_loadsounds), false, true },
+    { "P_Init", StartupPInit, AFTER(su_rinit), true },
+    { "I_ReleaseSounds", StartupReleaseSounds, AFTER(su_convertsounds) | AFTER(su_pinit), true },
+    { "S_Init", StartupSInit, AFTER(su_releasesounds), true },
+};
+
+static void PrintStartupProfile()
+{
+    uint64_t end = I_GetTimeUS();
+
+    printf("Startup profile (ms since D_DoomMain):\n");
+
+    for (int i = 0; i < NUMSTARTUPTASKS; i++)
+    {
+        const workertask_t *task = &startuptasks[i];
+
+        printf("  %8.1f - %8.1f  worker %2d  %s\n",
+            (task->start - startuptime) / 1000.0,
+            (task->start + task->time - startuptime) / 1000.0,
+            task->worker, task->name);
+    }
+
+    printf("  %8.1f total\n", (end - startuptime) / 1000.0);
+}
+
 //
 // D_DoomMain
 //
@@ -1488,6 +1627,8 @@ void D_DoomMain()
     char file[256];
     char demolumpname[9];
 
+    startuptime = I_GetTimeUS();
+
     I_AtExit(D_Endoom, false);
 
     // print banner
@@ -1541,6 +1682,22 @@ void D_DoomMain()
         exit(0);
     }
 
+    //!
+    // @arg <address>
+    // @category net
+    //
+    // Query the statistics of each game hosted by the server running
+    // on the given IP address (see -sessions).
+    //
+
+    p = M_CheckParmWithArgs("-querysessions", 1);
+
+    if (p)
+    {
+        NET_QuerySessions(myargv[p + 1]);
+        exit(0);
+    }
+
     //!
     // @category net
     //
@@ -1924,37 +2081,29 @@ void D_DoomMain()
 
     if (p)
     {
-        char *uc_filename = strdup(myargv[p + 1]);
-        M_ForceUppercase(uc_filename);
+        D_AddDemoFile(myargv[p + 1], demolumpname);
+    }
 
-        // With Vanilla you have to specify the file without extension,
-        // but make that optional.
-        if (M_StringEndsWith(uc_filename, ".LMP"))
-        {
-            M_StringCopy(file, myargv[p + 1], sizeof(file));
-        }
-        else
-        {
-            DEH_snprintf(file, sizeof(file), "%s.lmp", myargv[p + 1]);
-        }
+    //!
+    // @arg <demo> [<demo> ...]
+    // @category demo
+    //
+    // Play back the given demos as with -timedemo, without showing a
+    // window, and write per-tic timings of the playsim, BSP, planes,
+    // masked and blit phases to benchmark.json (see -benchout).
+    //
 
-        free(uc_filename);
+    p = M_CheckParmWithArgs("-benchmark", 1);
 
-        if (D_AddFile(file))
-        {
-            M_StringCopy(demolumpname, lumpinfo[numlumps - 1]->name,
-                sizeof(demolumpname));
-        }
-        else
+    if (p)
+    {
+        while (++p != myargc && myargv[p][0] != '-')
         {
-            // If file failed to load, still continue trying to play
-            // the demo in the same way as Vanilla Doom.  This makes
-            // tricks like "-playdemo demo1" possible.
+            char benchlumpname[9];
 
-            M_StringCopy(demolumpname, myargv[p + 1], sizeof(demolumpname));
+            D_AddDemoFile(myargv[p], benchlumpname);
+            D_BenchAddDemo(benchlumpname);
         }
-
-        printf("Playing demo %s.\n", file);
     }
 
     I_AtExit(G_CheckDemoStatusAtExit, true);
@@ -2043,6 +2192,7 @@ void D_DoomMain()
     DEH_printf("I_Init: Setting up machine state.\n");
     I_CheckIsScreensaver();
     I_InitTimer();
+    I_InitWorkers();
     I_InitJoystick();
     I_InitSound(true);
     I_InitMusic();
@@ -2247,17 +2397,22 @@ void D_DoomMain()
         g_doomstat_globals->startloadgame = -1;
     }
 
-    DEH_printf("M_Init: Init miscellaneous info.\n");
-    M_Init();
+    // [crispy] M_Init(), R_Init(), P_Init() and S_Init()
+    I_RunTasks(startuptasks, NUMSTARTUPTASKS);
 
-    DEH_printf("R_Init: Init DOOM refresh daemon - ");
-    R_Init();
+    // [crispy] outside the graph, so that it composites on the workers
+    R_SaveTextureCache();
 
-    DEH_printf("\nP_Init: Init Playloop state.\n");
-    P_Init();
+    //!
+    // @category obscure
+    //
+    // Print when each step of the startup ran and how long it took.
+    //
 
-    DEH_printf("S_Init: Setting up sound.\n");
-    S_Init(g_doomstat_globals->sfxVolume * 8, g_doomstat_globals->musicVolume * 8);
+    if (M_ParmExists("-startupprofile"))
+    {
+        PrintStartupProfile();
+    }
 
     DEH_printf("D_CheckNetGame: Checking network game status.\n");
     D_CheckNetGame();
@@ -2315,6 +2470,46 @@ void D_DoomMain()
         D_DoomLoop(); // never returns
     }
 
+    if (M_CheckParmWithArgs("-benchmark", 1))
+    {
+        D_StartBenchmark();
+        D_DoomLoop(); // never returns
+    }
+
+    //!
+    // @arg <n>
+    // @category obscure
+    //
+    // Load the level given with -warp (or the first one), add n
+    // monsters that target each other, and print how long saving
+    // and loading the level takes.
+    //
+
+    p = M_CheckParmWithArgs("-savebench", 1);
+
+    if (p)
+    {
+        G_InitNew(g_doomstat_globals->startskill, g_doomstat_globals->startepisode, g_doomstat_globals->startmap);
+        D_SaveGameBenchmark(std::atoi(myargv[p + 1])); // never returns
+    }
+
+    //!
+    // @arg <n>
+    // @category obscure
+    //
+    // Load the level given with -warp (or the first one), add n
+    // monsters, and print how long running all of the level's
+    // thinkers takes per tic.
+    //
+
+    p = M_CheckParmWithArgs("-thinkbench", 1);
+
+    if (p)
+    {
+        G_InitNew(g_doomstat_globals->startskill, g_doomstat_globals->startepisode, g_doomstat_globals->startmap);
+        D_ThinkerBenchmark(std::atoi(myargv[p + 1])); // never returns
+    }
+
     if (g_doomstat_globals->startloadgame >= 0)
     {
         M_StringCopy(file, P_SaveGameFile(g_doomstat_globals->startloadgame), sizeof(file));
@@ -51,6 +51,7 @@
 #include "st_stuff.hpp"
 #include "am_map.hpp"
 #include "statdump.hpp"
+#include "d_bench.hpp"
 
 // Needs access to LFB.
 #include "v_video.hpp"
@@ -1036,6 +1037,7 @@ void G_Ticker()
     int       i;
     int       buf;
     ticcmd_t *cmd;
+    uint64_t  benchstart;
 
     // do player reborns if needed
     for (i = 0; i < MAXPLAYERS; i++)
@@ -1208,7 +1210,9 @@ void G_Ticker()
     switch (g_doomstat_globals->gamestate)
     {
     case GS_LEVEL:
+        benchstart = D_BenchBegin();
         P_Ticker();
+        D_BenchEnd(bp_playsim, benchstart);
         ST_Ticker();
         AM_Ticker();
         HU_Ticker();
@@ -1905,9 +1909,7 @@ void G_DoLoadGame()
     }
     gameaction = ga_nothing;
 
-    save_stream = fopen(savename, "rb");
-
-    if (save_stream == nullptr)
+    if (!P_OpenSaveGameRead(savename))
     {
         I_Error("Could not load savegame %s", savename);
     }
@@ -1927,7 +1929,7 @@ void G_DoLoadGame()
             strcasecmp(savewadfilename, W_WadNameForLump(savemaplumpinfo)))
         {
             M_ForceLoadGame();
-            fclose(save_stream);
+            P_CloseSaveGame();
             return;
         }
         else
@@ -1946,7 +1948,7 @@ void G_DoLoadGame()
         // [crispy] indicate game version mismatch
         extern void M_LoadGameVerMismatch();
         M_LoadGameVerMismatch();
-        fclose(save_stream);
+        P_CloseSaveGame();
         return;
     }
 
@@ -1974,7 +1976,9 @@ void G_DoLoadGame()
         P_ReadExtendedSaveGameData(1);
     }
 
-    fclose(save_stream);
+    P_ClearThinkerIndex();
+
+    P_CloseSaveGame();
 
     if (setsizeneeded)
         R_ExecuteSetViewSize();
@@ -2016,24 +2020,9 @@ void G_DoSaveGame()
     temp_savegame_file     = P_TempSaveGameFile();
     savegame_file          = P_SaveGameFile(savegameslot);
 
-    // Open the savegame file for writing.  We write to a temporary file
-    // and then rename it at the end if it was successfully written.
-    // This prevents an existing savegame from being overwritten by
-    // a corrupted one, or if a savegame buffer overrun occurs.
-    save_stream = fopen(temp_savegame_file, "wb");
-
-    if (save_stream == nullptr)
-    {
-        // Failed to save the game, so we're going to have to abort. But
-        // to be nice, save to somewhere else before we call I_Error().
-        recovery_savegame_file = M_TempFile("recovery.dsg");
-        save_stream            = fopen(recovery_savegame_file, "wb");
-        if (save_stream == nullptr)
-        {
-            I_Error("Failed to open either '%s' or '%s' to write savegame.",
-                temp_savegame_file, recovery_savegame_file);
-        }
-    }
+    // [crispy] The savegame is serialized into memory and written out
+    // in one go once it is complete.
+    P_OpenSaveGameWrite();
 
     savegame_error = false;
 
@@ -2063,20 +2052,37 @@ void G_DoSaveGame()
         P_WriteExtendedSaveGameData();
     }
 
+    P_ClearThinkerIndex();
+
     // [crispy] unconditionally disable savegame and demo limits
     /*
     // Enforce the same savegame size limit as in Vanilla Doom,
     // except if the vanilla_savegame_limit setting is turned off.
 
-    if (vanilla_savegame_limit && ftell(save_stream) > SAVEGAMESIZE)
+    if (vanilla_savegame_limit && mem_ftell(save_stream) > SAVEGAMESIZE)
     {
         I_Error("Savegame buffer overrun");
     }
     */
 
-    // Finish up, close the savegame file.
+    // Finish up, write out the savegame.  We write to a temporary file
+    // and then rename it at the end if it was successfully written.
+    // This prevents an existing savegame from being overwritten by
+    // a corrupted one, or if a savegame buffer overrun occurs.
 
-    fclose(save_stream);
+    if (!P_WriteSaveGameFile(temp_savegame_file))
+    {
+        // Failed to save the game, so we're going to have to abort. But
+        // to be nice, save to somewhere else before we call I_Error().
+        recovery_savegame_file = M_TempFile("recovery.dsg");
+        if (!P_WriteSaveGameFile(recovery_savegame_file))
+        {
+            I_Error("Failed to open either '%s' or '%s' to write savegame.",
+                temp_savegame_file, recovery_savegame_file);
+        }
+    }
+
+    P_CloseSaveGame();
 
     if (recovery_savegame_file != nullptr)
     {
@@ -2670,19 +2676,25 @@ void G_DoPlayDemo()
     bool olddemo = false;
 
     // [crispy] in demo continue mode free the obsolete demo buffer
-    // of size 'maxsize' previously allocated in G_RecordDemo()
-    if (g_doomstat_globals->demorecording)
+    // of size 'maxsize' previously allocated in G_RecordDemo(), else
+    // the copy of a demo whose playback was cut short by a new game
+    if (demobuffer != nullptr)
     {
         Z_Free(demobuffer);
     }
 
     lumpnum    = W_GetNumForName(defdemoname);
     gameaction = ga_nothing;
-    demobuffer = cache_lump_num<uint8_t *>(lumpnum, PU_STATIC);
+
+    // [crispy] play back from a copy of the lump: the buffer is freed
+    // with Z_Free() and recorded into when the demo is continued, and
+    // a lump in a memory-mapped WAD can be neither
+    size_t lumplength = W_LumpLength(lumpnum);
+    demobuffer = zmalloc<decltype(demobuffer)>(lumplength, PU_STATIC, nullptr);
+    W_ReadLump(lumpnum, demobuffer);
     demo_p     = demobuffer;
 
     // [crispy] ignore empty demo lumps
-    size_t lumplength = W_LumpLength(lumpnum);
     if (lumplength < 0xd)
     {
         g_doomstat_globals->demoplayback = true;
@@ -2846,6 +2858,12 @@ bool G_CheckDemoStatus()
 {
     int endtime;
 
+    // [crispy] -benchmark reports once all of its demos have played
+    if (timingdemo && benchmarking)
+    {
+        timingdemo = false;
+    }
+
     if (timingdemo)
     {
         float fps;
@@ -2865,7 +2883,13 @@ bool G_CheckDemoStatus()
 
     if (g_doomstat_globals->demoplayback)
     {
-        W_ReleaseLumpName(defdemoname);
+        // [crispy] done with the copy of the demo, unless recording
+        // continues into it
+        if (!g_doomstat_globals->demorecording)
+        {
+            Z_Free(demobuffer);
+            demobuffer = nullptr;
+        }
         g_doomstat_globals->demoplayback    = false;
         netdemo         = false;
         g_doomstat_globals->netgame         = false;
@@ -2899,6 +2923,10 @@ bool G_CheckDemoStatus()
             return true;
         }
 
+        // [crispy] move on to the next -benchmark demo, or quit
+        if (D_BenchDemoDone())
+            return true;
+
         if (g_doomstat_globals->singledemo)
             I_Quit();
         else
@@ -2912,6 +2940,7 @@ bool G_CheckDemoStatus()
         *demo_p++ = DEMOMARKER;
         M_WriteFile(demoname, demobuffer, static_cast<int>(demo_p - demobuffer));
         Z_Free(demobuffer);
+        demobuffer = nullptr;
         g_doomstat_globals->demorecording = false;
         // [crispy] if a new game is started during demo recording, start a new demo
         if (gameaction != ga_newgame)
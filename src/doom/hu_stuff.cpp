@@ -42,6 +42,7 @@
 #include "lump.hpp"
 #include "v_trans.hpp" // [crispy] colored kills/items/secret/etc. messages
 #include "v_video.hpp" // [crispy] V_DrawPatch() et al.
+#include "r_plane.hpp" // [crispy] visplanecount, visplaneprobes
 
 //
 // Locally used constants, shortcuts.
@@ -98,6 +99,8 @@ static hu_textline_t w_coordx;
 static hu_textline_t w_coordy;
 static hu_textline_t w_coorda;
 static hu_textline_t w_fps;
+static hu_textline_t w_vplanes; // [crispy] visplane statistics
+static hu_textline_t w_vprobes;
 bool              chat_on;
 static hu_itext_t    w_chat;
 static bool       always_off = false;
@@ -659,6 +662,16 @@ void HU_Start()
         hu_font,
         HU_FONTSTART);
 
+    HUlib_initTextLine(&w_vplanes,
+        HU_COORDX, HU_MSGY + 4 * 8,
+        hu_font,
+        HU_FONTSTART);
+
+    HUlib_initTextLine(&w_vprobes,
+        HU_COORDX, HU_MSGY + 5 * 8,
+        hu_font,
+        HU_FONTSTART);
+
 
     switch (logical_gamemission)
     {
@@ -854,6 +867,8 @@ void HU_Drawer()
     if (plr->powers[pw_showfps])
     {
         HUlib_drawTextLine(&w_fps, false);
+        HUlib_drawTextLine(&w_vplanes, false);
+        HUlib_drawTextLine(&w_vprobes, false);
     }
 
     if (crispy->crosshair == CROSSHAIR_STATIC)
@@ -896,6 +911,19 @@ void HU_Erase()
     HUlib_eraseTextLine(&w_coordy);
     HUlib_eraseTextLine(&w_coorda);
     HUlib_eraseTextLine(&w_fps);
+    HUlib_eraseTextLine(&w_vplanes);
+    HUlib_eraseTextLine(&w_vprobes);
+}
+
+// [crispy] move a statistics line left of HU_COORDX if its value has
+// grown too wide to fit on the screen
+
+static void HU_FitStatLine(hu_textline_t *t, const char *str)
+{
+    extern int M_StringWidth(const char *string);
+    const int  x = ORIGWIDTH + DELTAWIDTH - M_StringWidth(str);
+
+    t->x = x < HU_COORDX ? x : HU_COORDX;
 }
 
 void HU_Ticker()
@@ -1071,9 +1099,25 @@ void HU_Ticker()
     {
         M_snprintf(str, sizeof(str), "%s%-4d %sFPS", crstr[static_cast<int>(cr_t::CR_GRAY)], crispy->fps, cr_stat2);
         HUlib_clearTextLine(&w_fps);
+        HU_FitStatLine(&w_fps, str);
         s = str;
         while (*s)
             HUlib_addCharToTextLine(&w_fps, *(s++));
+
+        // [crispy] visplanes and hash probes spent finding them last frame
+        M_snprintf(str, sizeof(str), "%s%-4d %sVPL", crstr[static_cast<int>(cr_t::CR_GRAY)], visplanecount, cr_stat2);
+        HUlib_clearTextLine(&w_vplanes);
+        HU_FitStatLine(&w_vplanes, str);
+        s = str;
+        while (*s)
+            HUlib_addCharToTextLine(&w_vplanes, *(s++));
+
+        M_snprintf(str, sizeof(str), "%s%-4d %sPRB", crstr[static_cast<int>(cr_t::CR_GRAY)], visplaneprobes, cr_stat2);
+        HUlib_clearTextLine(&w_vprobes);
+        HU_FitStatLine(&w_vprobes, str);
+        s = str;
+        while (*s)
+            HUlib_addCharToTextLine(&w_vprobes, *(s++));
     }
 }
 
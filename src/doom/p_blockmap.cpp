@@ -26,6 +26,8 @@
 
 // [crispy] taken from mbfsrc/P_SETUP.C:547-707, slightly adapted
 
+static int32_t *createdblockmap;
+
 void P_CreateBlockMap()
 {
     fixed_t minx = INT_MAX, miny = INT_MAX, maxx = INT_MIN, maxy = INT_MIN;
@@ -149,7 +151,11 @@ void P_CreateBlockMap()
                     count += bmap[i].n + 2; // 1 header word + 1 trailer word + blocklist
 
             // Allocate blockmap lump with computed count
-            g_p_local_globals->blockmaplump = zmalloc<decltype(g_p_local_globals->blockmaplump)>(sizeof(*g_p_local_globals->blockmaplump) * static_cast<unsigned long>(count), PU_LEVEL, 0);
+            // [crispy] not from the zone, so that this can run on a worker
+            // thread during P_SetupLevel(); the buffer is reused by the
+            // next level that needs a blockmap built
+            createdblockmap                 = static_cast<int32_t *>(I_Realloc(createdblockmap, sizeof(*createdblockmap) * static_cast<unsigned long>(count)));
+            g_p_local_globals->blockmaplump = createdblockmap;
         }
 
         // Now compress the blockmap.
@@ -178,12 +184,7 @@ void P_CreateBlockMap()
     }
 
     // [crispy] copied over from P_LoadBlockMap()
-    {
-        int count  = static_cast<int>(sizeof(*g_p_local_globals->blocklinks)) * g_p_local_globals->bmapwidth * g_p_local_globals->bmapheight;
-        g_p_local_globals->blocklinks = zmalloc<decltype(g_p_local_globals->blocklinks)>(static_cast<size_t>(count), PU_LEVEL, 0);
-        std::memset(g_p_local_globals->blocklinks, 0, static_cast<size_t>(count));
-        g_p_local_globals->blockmap = g_p_local_globals->blockmaplump + 4;
-    }
+    g_p_local_globals->blockmap = g_p_local_globals->blockmaplump + 4;
 
     fprintf(stderr, "+BLOCKMAP)\n");
 }
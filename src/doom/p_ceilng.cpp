@@ -188,7 +188,7 @@ int EV_DoCeiling(line_t *line,
 
         // new door thinker
         rtn     = 1;
-        ceiling = zmalloc<decltype(ceiling)>(sizeof(*ceiling), PU_LEVSPEC, 0);
+        ceiling = thinkermalloc<decltype(ceiling)>(sizeof(*ceiling));
         P_AddThinker(&ceiling->thinker);
         sec->specialdata               = ceiling;
         ceiling->thinker.function      = T_MoveCeiling;
@@ -273,7 +273,7 @@ int EV_DoDoor(line_t *line,
 
         // new door thinker
         rtn  = 1;
-        door = zmalloc<decltype(door)>(sizeof(*door), PU_LEVSPEC, 0);
+        door = thinkermalloc<decltype(door)>(sizeof(*door));
         P_AddThinker(&door->thinker);
         sec->specialdata = door;
 
@@ -500,7 +500,7 @@ void EV_VerticalDoor(line_t *line,
 
 
     // new door thinker
-    door = zmalloc<decltype(door)>(sizeof(*door), PU_LEVSPEC, 0);
+    door = thinkermalloc<decltype(door)>(sizeof(*door));
     sec->specialdata            = door;
     door->thinker.function      = T_VerticalDoor;
     door->sector                = sec;
@@ -550,7 +550,7 @@ void P_SpawnDoorCloseIn30(sector_t *sec)
 {
     vldoor_t *door;
 
-    door = zmalloc<decltype(door)>(sizeof(*door), PU_LEVSPEC, 0);
+    door = thinkermalloc<decltype(door)>(sizeof(*door));
 
     P_AddThinker(&door->thinker);
 
@@ -572,7 +572,7 @@ void P_SpawnDoorRaiseIn5Mins(sector_t *sec, int)
 {
     vldoor_t *door;
 
-    door = zmalloc<decltype(door)>(sizeof(*door), PU_LEVSPEC, 0);
+    door = thinkermalloc<decltype(door)>(sizeof(*door));
 
     P_AddThinker(&door->thinker);
 
@@ -782,7 +782,7 @@ EV_SlidingDoor
     // Init sliding door vars
     if (!door)
     {
-	door = zmalloc<decltype(door)> (sizeof(*door), PU_LEVSPEC, 0);
+	door = thinkermalloc<decltype(door)>(sizeof(*door));
 	P_AddThinker (&door->thinker);
 	sec->specialdata = door;
 		
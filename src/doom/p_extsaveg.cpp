@@ -42,7 +42,7 @@ static char *line, *string;
 static void P_WritePackageTarname(const char *key)
 {
     M_snprintf(line, MAX_LINE_LEN, "%s %s\n", key, PACKAGE_VERSION);
-    fputs(line, save_stream);
+    mem_fputs(line, save_stream);
 }
 
 // maplumpinfo->wad_file->basename
@@ -52,7 +52,7 @@ char *savewadfilename = nullptr;
 static void P_WriteWadFileName(const char *key)
 {
     M_snprintf(line, MAX_LINE_LEN, "%s %s\n", key, W_WadNameForLump(maplumpinfo));
-    fputs(line, save_stream);
+    mem_fputs(line, save_stream);
 }
 
 static void P_ReadWadFileName(const char *key)
@@ -79,7 +79,7 @@ static void P_WriteExtraKills(const char *key)
     if (g_doomstat_globals->extrakills)
     {
         M_snprintf(line, MAX_LINE_LEN, "%s %d\n", key, g_doomstat_globals->extrakills);
-        fputs(line, save_stream);
+        mem_fputs(line, save_stream);
     }
 }
 
@@ -100,7 +100,7 @@ static void P_WriteTotalLevelTimes(const char *key)
     if (g_doomstat_globals->totalleveltimes)
     {
         M_snprintf(line, MAX_LINE_LEN, "%s %d\n", key, g_doomstat_globals->totalleveltimes);
-        fputs(line, save_stream);
+        mem_fputs(line, save_stream);
     }
 }
 
@@ -135,7 +135,7 @@ static void P_WriteFireFlicker(const char *key)
                 static_cast<int>(flick->count),
                 static_cast<int>(flick->maxlight),
                 static_cast<int>(flick->minlight));
-            fputs(line, save_stream);
+            mem_fputs(line, save_stream);
         }
     }
 }
@@ -155,7 +155,7 @@ static void P_ReadFireFlicker(const char *key)
     {
         fireflicker_t *flick;
 
-        flick = zmalloc<decltype(flick)>(sizeof(*flick), PU_LEVEL, nullptr);
+        flick = thinkermalloc<decltype(flick)>(sizeof(*flick));
 
         flick->sector   = &g_r_state_globals->sectors[sector];
         flick->count    = count;
@@ -183,7 +183,7 @@ static void P_WriteSoundTarget(const char *key)
                 key,
                 i,
                 P_ThinkerToIndex(reinterpret_cast<thinker_t *>(sector->soundtarget)));
-            fputs(line, save_stream);
+            mem_fputs(line, save_stream);
         }
     }
 }
@@ -218,7 +218,7 @@ static void P_WriteOldSpecial(const char *key)
                 key,
                 i,
                 sector->oldspecial);
-            fputs(line, save_stream);
+            mem_fputs(line, save_stream);
         }
     }
 }
@@ -259,7 +259,7 @@ static void P_WriteButton(const char *key)
                 static_cast<int>(button->where),
                 static_cast<int>(button->btexture),
                 static_cast<int>(button->btimer));
-            fputs(line, save_stream);
+            mem_fputs(line, save_stream);
         }
     }
 }
@@ -302,7 +302,7 @@ static void P_WriteBrainTarget(const char *key)
                     key,
                     numbraintargets,
                     braintargeton);
-                fputs(line, save_stream);
+                mem_fputs(line, save_stream);
 
                 // [crispy] return after the first brain spitter is found
                 return;
@@ -342,7 +342,7 @@ static void P_WriteMarkPoints(const char *key)
             p[5], p[6], p[7], p[8], p[9],
             p[10], p[11], p[12], p[13], p[14],
             p[15], p[16], p[17], p[18], p[19]);
-        fputs(line, save_stream);
+        mem_fputs(line, save_stream);
     }
 }
 
@@ -375,7 +375,7 @@ static void P_WritePlayersLookdir(const char *key)
         if (g_doomstat_globals->playeringame[i] && g_doomstat_globals->players[i].lookdir)
         {
             M_snprintf(line, MAX_LINE_LEN, "%s %d %d\n", key, i, g_doomstat_globals->players[i].lookdir);
-            fputs(line, save_stream);
+            mem_fputs(line, save_stream);
         }
     }
 }
@@ -402,7 +402,7 @@ static void P_WriteMusInfo(const char *key)
         strncpy(orig, lumpinfo[musinfo.items[0]]->name, 8);
 
         M_snprintf(line, MAX_LINE_LEN, "%s %s %s\n", key, lump, orig);
-        fputs(line, save_stream);
+        mem_fputs(line, save_stream);
     }
 }
 
@@ -470,7 +470,7 @@ void P_WriteExtendedSaveGameData()
 
 static void P_ReadKeyValuePairs(int pass)
 {
-    while (fgets(line, MAX_LINE_LEN, save_stream))
+    while (mem_fgets(line, MAX_LINE_LEN, save_stream))
     {
         if (sscanf(line, "%s", string) == 1)
         {
@@ -509,11 +509,11 @@ void P_ReadExtendedSaveGameData(int pass)
         return;
     }
 
-    curpos = ftell(save_stream);
+    curpos = mem_ftell(save_stream);
 
     // [crispy] check which map we would want to load
-    fseek(save_stream, SAVESTRINGSIZE + VERSIONSIZE + 1, SEEK_SET); // [crispy] + 1 for "gameskill"
-    if (fread(&episode, 1, 1, save_stream) == 1 && fread(&map, 1, 1, save_stream) == 1)
+    mem_fseek(save_stream, SAVESTRINGSIZE + VERSIONSIZE + 1, MEM_SEEK_SET); // [crispy] + 1 for "gameskill"
+    if (mem_fread(&episode, 1, 1, save_stream) == 1 && mem_fread(&map, 1, 1, save_stream) == 1)
     {
         lumpnum = P_GetNumForMap(static_cast<int>(episode), static_cast<int>(map), false);
     }
@@ -529,23 +529,23 @@ void P_ReadExtendedSaveGameData(int pass)
     }
 
     // [crispy] read key/value pairs past the end of the regular savegame data
-    fseek(save_stream, 0, SEEK_END);
-    endpos = ftell(save_stream);
+    mem_fseek(save_stream, 0, MEM_SEEK_END);
+    endpos = mem_ftell(save_stream);
 
     for (p = endpos - 1; p > 0; p--)
     {
         uint8_t curbyte;
 
-        fseek(save_stream, p, SEEK_SET);
+        mem_fseek(save_stream, p, MEM_SEEK_SET);
 
-        if (fread(&curbyte, 1, 1, save_stream) < 1)
+        if (mem_fread(&curbyte, 1, 1, save_stream) < 1)
         {
             break;
         }
 
         if (curbyte == SAVEGAME_EOF)
         {
-            if (!fgets(line, MAX_LINE_LEN, save_stream))
+            if (!mem_fgets(line, MAX_LINE_LEN, save_stream))
             {
                 continue;
             }
@@ -562,5 +562,5 @@ void P_ReadExtendedSaveGameData(int pass)
     free(string);
 
     // [crispy] back to where we started
-    fseek(save_stream, curpos, SEEK_SET);
+    mem_fseek(save_stream, curpos, MEM_SEEK_SET);
 }
@@ -56,6 +56,9 @@ result_e
     sector->oldceilingheight = sector->ceilingheight;
     sector->oldgametic       = gametic;
 
+    // [crispy] sight checks through this sector may change
+    P_InvalidateSightCache();
+
     switch (floorOrCeiling)
     {
     case 0:
@@ -292,7 +295,7 @@ void T_MoveGoobers(floormove_t *floor)
             sec->specialdata = nullptr;
         }
 
-        floor = zmalloc<decltype(floor)>(sizeof(*floor), PU_LEVSPEC, 0);
+        floor = thinkermalloc<decltype(floor)>(sizeof(*floor));
         P_AddThinker(&floor->thinker);
         sec->specialdata             = floor;
         floor->thinker.function      = T_MoveGoobers;
@@ -331,7 +334,7 @@ int EV_DoFloor(line_t *line,
 
         // new floor thinker
         rtn   = 1;
-        floor = zmalloc<decltype(floor)>(sizeof(*floor), PU_LEVSPEC, 0);
+        floor = thinkermalloc<decltype(floor)>(sizeof(*floor));
         P_AddThinker(&floor->thinker);
         sec->specialdata             = floor;
         floor->thinker.function      = T_MoveFloor;
@@ -524,7 +527,7 @@ int EV_BuildStairs(line_t *line,
 
         // new floor thinker
         rtn   = 1;
-        floor = zmalloc<decltype(floor)>(sizeof(*floor), PU_LEVSPEC, 0);
+        floor = thinkermalloc<decltype(floor)>(sizeof(*floor));
         P_AddThinker(&floor->thinker);
         sec->specialdata             = floor;
         floor->thinker.function      = T_MoveFloor;
@@ -583,7 +586,7 @@ int EV_BuildStairs(line_t *line,
 
                 sec    = tsec;
                 secnum = newsecnum;
-                floor  = zmalloc<decltype(floor)>(sizeof(*floor), PU_LEVSPEC, 0);
+                floor  = thinkermalloc<decltype(floor)>(sizeof(*floor));
 
                 P_AddThinker(&floor->thinker);
 
@@ -57,7 +57,7 @@ void P_SpawnFireFlicker(sector_t *sector)
     // Nothing special about it during gameplay.
     sector->special = 0;
 
-    fireflicker_t *flick = zmalloc<decltype(flick)>(sizeof(*flick), PU_LEVSPEC, 0);
+    fireflicker_t *flick = thinkermalloc<decltype(flick)>(sizeof(*flick));
 
     P_AddThinker(&flick->thinker);
 
@@ -106,7 +106,7 @@ void P_SpawnLightFlash(sector_t *sector)
     // nothing special about it during gameplay
     sector->special = 0;
 
-    lightflash_t *flash = zmalloc<decltype(flash)>(sizeof(*flash), PU_LEVSPEC, 0);
+    lightflash_t *flash = thinkermalloc<decltype(flash)>(sizeof(*flash));
 
     P_AddThinker(&flash->thinker);
 
@@ -156,7 +156,7 @@ void P_SpawnStrobeFlash(sector_t *sector,
     int                           fastOrSlow,
     int                           inSync)
 {
-    strobe_t *flash = zmalloc<decltype(flash)>(sizeof(*flash), PU_LEVSPEC, 0);
+    strobe_t *flash = thinkermalloc<decltype(flash)>(sizeof(*flash));
 
     P_AddThinker(&flash->thinker);
 
@@ -307,7 +307,7 @@ void T_Glow(glow_t *g)
 
 void P_SpawnGlowingLight(sector_t *sector)
 {
-    glow_t *g = zmalloc<decltype(g)>(sizeof(*g), PU_LEVSPEC, 0);
+    glow_t *g = thinkermalloc<decltype(g)>(sizeof(*g));
 
     P_AddThinker(&g->thinker);
 
@@ -63,6 +63,17 @@ void P_InitThinkers();
 void P_AddThinker(thinker_t *thinker);
 void P_RemoveThinker(thinker_t *thinker);
 
+// [crispy] pooled allocation of mobjs and special thinkers
+void *P_AllocThinker(size_t size);
+void  P_FreeThinker(thinker_t *thinker);
+void  P_ClearThinkerPools();
+
+template <typename DataType>
+auto thinkermalloc(size_t size)
+{
+    return static_cast<DataType>(P_AllocThinker(size));
+}
+
 
 //
 // P_PSPR
@@ -145,6 +156,15 @@ constexpr auto MAXINTERCEPTS          =(MAXINTERCEPTS_ORIGINAL + 61);
 
 using traverser_t = bool (*)(intercept_t *);
 
+// [crispy] the things in a mapblock, oldest first
+struct blockthings_t
+{
+    mobj_t **things; // nullptr entries are holes left while iterating
+    int      numthings;
+    int      maxthings;
+    bool     hasholes;
+};
+
 fixed_t P_AproxDistance(fixed_t dx, fixed_t dy);
 int     P_PointOnLineSide(fixed_t x, fixed_t y, line_t *line);
 int     P_PointOnDivlineSide(fixed_t x, fixed_t y, divline_t *line);
@@ -169,6 +189,7 @@ bool
         int                flags,
         bool (*trav)(intercept_t *));
 
+void P_InitBlockLinks(); // [crispy] once the blockmap and lines are loaded
 void P_UnsetThingPosition(mobj_t *thing);
 void P_SetThingPosition(mobj_t *thing);
 
@@ -188,6 +209,8 @@ bool P_TryMove(mobj_t *thing, fixed_t x, fixed_t y);
 bool P_TeleportMove(mobj_t *thing, fixed_t x, fixed_t y);
 void    P_SlideMove(mobj_t *mo);
 bool P_CheckSight(mobj_t *t1, mobj_t *t2);
+void    P_InvalidateSightCache(); // [crispy] call when a floor or ceiling moves
+extern int sightcounts[3]; // [crispy] REJECT rejections, traces, cache hits
 void    P_UseLines(player_t *player);
 
 bool P_ChangeSector(sector_t *sector, bool crunch);
@@ -302,7 +325,8 @@ struct p_local_t {
     // origin of block map
     fixed_t  bmaporgx{};
     fixed_t  bmaporgy{};   // origin of block map
-    mobj_t **blocklinks{}; // for thing chains
+    blockthings_t *blockthings{};    // [crispy] things in each block, replaces blocklinks
+    int *          linevalidcount{}; // [crispy] validcount of each line, for P_BlockLinesIterator()
     // [crispy] blinking key or skull in the status bar
     int st_keyorskull[3]{};
     //
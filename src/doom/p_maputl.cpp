@@ -22,7 +22,7 @@
 
 
 #include <cstdlib>
-
+#include <cstring>
 
 #include "i_system.hpp" // [crispy] I_Realloc()
 #include "m_bbox.hpp"
@@ -30,7 +30,9 @@
 #include "doomdef.hpp"
 #include "doomstat.hpp"
 #include "p_local.hpp"
+#include "z_zone.hpp"
 
+#include "memory.hpp"
 
 // State.
 #include "r_state.hpp"
@@ -303,6 +305,116 @@ void P_LineOpening(line_t *linedef_param)
 //
 
 
+//
+// Thing arrays
+// [crispy] Each mapblock keeps its things in a dense array, oldest
+// first, rather than in a chain of bnext/bprev links through the
+// mobjs, so that collision checks in crowded areas read one array
+// instead of hopping between mobjs all over the zone.
+//
+#define MINBLOCKTHINGS 8
+
+static int             blockiterating; // nesting depth of P_BlockThingsIterator()
+static blockthings_t **holeblocks;     // blocks with holes left by unlinking
+static int             numholeblocks;
+static int             maxholeblocks;
+
+void P_InitBlockLinks()
+{
+    int numblocks = g_p_local_globals->bmapwidth * g_p_local_globals->bmapheight;
+
+    g_p_local_globals->blockthings = zmalloc<decltype(g_p_local_globals->blockthings)>(static_cast<size_t>(numblocks) * sizeof(*g_p_local_globals->blockthings), PU_LEVEL, nullptr);
+    std::memset(g_p_local_globals->blockthings, 0, static_cast<size_t>(numblocks) * sizeof(*g_p_local_globals->blockthings));
+
+    g_p_local_globals->linevalidcount = zmalloc<decltype(g_p_local_globals->linevalidcount)>(static_cast<size_t>(g_r_state_globals->numlines) * sizeof(*g_p_local_globals->linevalidcount), PU_LEVEL, nullptr);
+    std::memset(g_p_local_globals->linevalidcount, 0, static_cast<size_t>(g_r_state_globals->numlines) * sizeof(*g_p_local_globals->linevalidcount));
+
+    blockiterating = 0;
+    numholeblocks  = 0;
+}
+
+static void LinkBlockThing(blockthings_t *block, mobj_t *thing)
+{
+    if (block->numthings == block->maxthings)
+    {
+        int      newmax    = block->maxthings ? 2 * block->maxthings : MINBLOCKTHINGS;
+        mobj_t **newthings = zmalloc<mobj_t **>(static_cast<size_t>(newmax) * sizeof(*newthings), PU_LEVEL, nullptr);
+
+        if (block->things != nullptr)
+        {
+            std::memcpy(newthings, block->things, static_cast<size_t>(block->numthings) * sizeof(*newthings));
+            Z_Free(block->things);
+        }
+
+        block->things    = newthings;
+        block->maxthings = newmax;
+    }
+
+    block->things[block->numthings++] = thing;
+}
+
+// Squeeze out the holes, keeping the order.
+static void CompactBlock(blockthings_t *block)
+{
+    int j = 0;
+
+    for (int i = 0; i < block->numthings; i++)
+    {
+        if (block->things[i] != nullptr)
+            block->things[j++] = block->things[i];
+    }
+
+    block->numthings = j;
+    block->hasholes  = false;
+}
+
+static void CompactBlockThings()
+{
+    for (int i = 0; i < numholeblocks; i++)
+    {
+        CompactBlock(holeblocks[i]);
+    }
+
+    numholeblocks = 0;
+}
+
+static void UnlinkBlockThing(blockthings_t *block, mobj_t *thing)
+{
+    int i;
+
+    for (i = block->numthings - 1; i >= 0; i--)
+    {
+        if (block->things[i] == thing)
+            break;
+    }
+
+    if (i < 0)
+        return;
+
+    if (!blockiterating)
+    {
+        std::memmove(&block->things[i], &block->things[i + 1], static_cast<size_t>(block->numthings - i - 1) * sizeof(*block->things));
+        block->numthings--;
+        return;
+    }
+
+    // An iterator may be walking this block, so don't move anything.
+    block->things[i] = nullptr;
+
+    if (!block->hasholes)
+    {
+        if (numholeblocks == maxholeblocks)
+        {
+            maxholeblocks = maxholeblocks ? 2 * maxholeblocks : 64;
+            holeblocks    = static_cast<blockthings_t **>(I_Realloc(holeblocks, static_cast<size_t>(maxholeblocks) * sizeof(*holeblocks)));
+        }
+
+        holeblocks[numholeblocks++] = block;
+        block->hasholes             = true;
+    }
+}
+
+
 //
 // P_UnsetThingPosition
 // Unlinks a thing from block map and sectors.
@@ -332,21 +444,13 @@ void P_UnsetThingPosition(mobj_t *thing)
     {
         // inert things don't need to be in blockmap
         // unlink from block map
-        if (thing->bnext)
-            thing->bnext->bprev = thing->bprev;
+        blockx = (thing->x - g_p_local_globals->bmaporgx) >> MAPBLOCKSHIFT;
+        blocky = (thing->y - g_p_local_globals->bmaporgy) >> MAPBLOCKSHIFT;
 
-        if (thing->bprev)
-            thing->bprev->bnext = thing->bnext;
-        else
+        if (blockx >= 0 && blockx < g_p_local_globals->bmapwidth
+            && blocky >= 0 && blocky < g_p_local_globals->bmapheight)
         {
-            blockx = (thing->x - g_p_local_globals->bmaporgx) >> MAPBLOCKSHIFT;
-            blocky = (thing->y - g_p_local_globals->bmaporgy) >> MAPBLOCKSHIFT;
-
-            if (blockx >= 0 && blockx < g_p_local_globals->bmapwidth
-                && blocky >= 0 && blocky < g_p_local_globals->bmapheight)
-            {
-                g_p_local_globals->blocklinks[blocky * g_p_local_globals->bmapwidth + blockx] = thing->bnext;
-            }
+            UnlinkBlockThing(&g_p_local_globals->blockthings[blocky * g_p_local_globals->bmapwidth + blockx], thing);
         }
     }
 }
@@ -364,7 +468,6 @@ void P_SetThingPosition(mobj_t *thing)
     sector_t *   sec;
     int          blockx;
     int          blocky;
-    mobj_t **    link;
 
 
     // link into subsector
@@ -398,19 +501,9 @@ void P_SetThingPosition(mobj_t *thing)
             && blocky >= 0
             && blocky < g_p_local_globals->bmapheight)
         {
-            link         = &g_p_local_globals->blocklinks[blocky * g_p_local_globals->bmapwidth + blockx];
-            thing->bprev = nullptr;
-            thing->bnext = *link;
-            if (*link)
-                (*link)->bprev = thing;
-
-            *link = thing;
-        }
-        else
-        {
-            // thing is off the map
-            thing->bnext = thing->bprev = nullptr;
+            LinkBlockThing(&g_p_local_globals->blockthings[blocky * g_p_local_globals->bmapwidth + blockx], thing);
         }
+        // else thing is off the map
     }
 }
 
@@ -455,12 +548,14 @@ bool
 
     for (list = g_p_local_globals->blockmaplump + offset; *list != -1; list++)
     {
-        ld = &g_r_state_globals->lines[*list];
-
-        if (ld->validcount == validcount)
+        // [crispy] keep the marks out of line_t, so that only the lines
+        // that are not skipped get pulled into the cache
+        if (g_p_local_globals->linevalidcount[*list] == validcount)
             continue; // line has already been checked
 
-        ld->validcount = validcount;
+        g_p_local_globals->linevalidcount[*list] = validcount;
+
+        ld = &g_r_state_globals->lines[*list];
 
         if (!func(ld))
             return false;
@@ -477,7 +572,8 @@ bool
         int                   y,
         bool (*func)(mobj_t *))
 {
-    mobj_t *mobj;
+    blockthings_t *block;
+    bool           result = true;
 
     if (x < 0
         || y < 0
@@ -487,15 +583,30 @@ bool
         return true;
     }
 
+    block = &g_p_local_globals->blockthings[y * g_p_local_globals->bmapwidth + x];
+
+    // [crispy] Newest first, as things used to be linked in at the
+    // head of the chain.  func may link and unlink things, so the
+    // array is indexed afresh every time: new things go after the
+    // ones still to be visited, and removed ones leave a hole until
+    // the outermost iterator is done.
+    blockiterating++;
 
-    for (mobj = g_p_local_globals->blocklinks[y * g_p_local_globals->bmapwidth + x];
-         mobj;
-         mobj = mobj->bnext)
+    for (int i = block->numthings - 1; i >= 0; i--)
     {
-        if (!func(mobj))
-            return false;
+        mobj_t *mobj = block->things[i];
+
+        if (mobj != nullptr && !func(mobj))
+        {
+            result = false;
+            break;
+        }
     }
-    return true;
+
+    if (--blockiterating == 0 && numholeblocks > 0)
+        CompactBlockThings();
+
+    return result;
 }
 
 
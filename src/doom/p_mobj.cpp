@@ -560,8 +560,7 @@ void P_MobjThinker(mobj_t *mobj)
     {
         P_XYMovement(mobj);
 
-        action_hook needle = valid_hook(false);
-        if (mobj->thinker.function == needle)
+        if (thinker_is_removed(&mobj->thinker))
             return; // mobj was removed
     }
     if ((mobj->z != mobj->floorz)
@@ -569,8 +568,7 @@ void P_MobjThinker(mobj_t *mobj)
     {
         P_ZMovement(mobj);
 
-        action_hook null_hook = valid_hook(false);
-        if (mobj->thinker.function == null_hook)
+        if (thinker_is_removed(&mobj->thinker))
             return; // mobj was removed
     }
 
@@ -625,7 +623,7 @@ static mobj_t *
     state_t *   st;
     mobjinfo_t *info;
 
-    mobj = zmalloc<decltype(mobj)>(sizeof(*mobj), PU_LEVEL, nullptr);
+    mobj = thinkermalloc<decltype(mobj)>(sizeof(*mobj));
     std::memset(mobj, 0, sizeof(*mobj));
     info = &mobjinfo[type];
 
@@ -731,7 +729,8 @@ static p_local_t p_local_s = {
     .bmapheight = 0,
     .bmaporgx = 0,
     .bmaporgy = 0,
-    .blocklinks = nullptr,
+    .blockthings = nullptr,
+    .linevalidcount = nullptr,
 
     .st_keyorskull = {},
 
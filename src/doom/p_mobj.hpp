@@ -220,6 +220,7 @@ typedef struct mobj_s {
 
     // Interaction info, by BLOCKMAP.
     // Links in blocks (if needed).
+    // [crispy] unused, kept for the savegame layout; see blockthings_t
     mobj_t *bnext{};
     mobj_t *bprev{};
 
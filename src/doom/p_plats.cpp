@@ -153,7 +153,7 @@ int EV_DoPlat(line_t *line,
 
         // Find lowest & highest floors around sector
         rtn  = 1;
-        plat = zmalloc<decltype(plat)>(sizeof(*plat), PU_LEVSPEC, 0);
+        plat = thinkermalloc<decltype(plat)>(sizeof(*plat));
         P_AddThinker(&plat->thinker);
 
         plat->type                  = type;
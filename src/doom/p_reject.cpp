@@ -0,0 +1,613 @@
+//
+// Copyright(C) 1993-1996 Id Software, Inc.
+// Copyright(C) 2005-2014 Simon Howard
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//	Load time REJECT matrix builder.
+//
+//	Many PWADs ship with an empty or zero-filled REJECT lump, which
+//	leaves P_CheckSight() to trace through the BSP for every sight
+//	check.  Here the two-sided lines between different sectors are
+//	treated as 2D portals, and for each sector the portals that can
+//	be stabbed by a straight line leaving it are followed, clipping
+//	each one to the region visible through the previous ones.
+//
+//	The result is conservative: heights, doors and one-sided walls
+//	inside a sector are ignored, clipping errs on the visible side,
+//	and a sector whose search grows too large falls back to plain
+//	connectivity.  A pair of sectors is only rejected if neither can
+//	see the other.
+//
+
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#include "p_reject.hpp"
+
+#include "doomstat.hpp"
+#include "i_system.hpp"
+#include "i_thread.hpp" // [crispy] I_RunOnWorkers()
+#include "i_timer.hpp"
+#include "m_config.hpp"
+#include "m_misc.hpp"
+#include "p_local.hpp"
+#include "r_state.hpp"
+#include "sha1.hpp"
+#include "w_wad.hpp"
+#include "z_zone.hpp"
+
+#include "lump.hpp"
+#include "memory.hpp"
+
+// Bump this whenever the output of the builder changes, so that old
+// cache files are not picked up.
+#define REJECTVERSION 1
+
+#define REJECTMAGIC "RJCT"
+
+// Portal clipping steps allowed for one source sector before giving
+// up and falling back to connectivity, and the deepest portal chain
+// that is followed.
+#define REJECTBUDGET   (1 << 18)
+#define REJECTMAXDEPTH 256
+
+// Distance, in map units, by which clipping is widened in favour of
+// visibility.
+#define REJECTEPSILON (1.0 / 16)
+
+struct rvec_t
+{
+    double x, y;
+};
+
+struct rseg_t
+{
+    rvec_t a, b;
+};
+
+// A two-sided line seen from one of its sectors.  The segment is
+// oriented so that the sector it leads into lies to its left.
+struct rportal_t
+{
+    rseg_t seg;
+    int    line;
+    int    to;
+};
+
+struct rejectwork_t
+{
+    uint8_t *instack; // [numlines], lines on the current portal chain
+    int *    floodstack;
+    uint8_t *row;
+    int      budget;
+    bool     overflow;
+    int      numflooded;
+};
+
+static rportal_t *portals;     // grouped by the sector they leave
+static int *      firstportal; // [numsectors + 1]
+static uint8_t *  leaky;       // [numsectors]
+static uint8_t *  visrows;     // [numsectors][visrowbytes]
+static int        visrowbytes;
+
+static rejectwork_t rejectwork[MAXWORKERS];
+
+static inline void MarkVisible(uint8_t *row, int sector)
+{
+    row[sector >> 3] |= 1 << (sector & 7);
+}
+
+static inline bool IsVisible(const uint8_t *row, int sector)
+{
+    return (row[sector >> 3] & (1 << (sector & 7))) != 0;
+}
+
+// Signed distance of p from the line through l1 and l2, positive on
+// the left.  Zero if the line is degenerate.
+static double SideDistance(const rvec_t &l1, const rvec_t &l2, const rvec_t &p)
+{
+    double dx  = l2.x - l1.x;
+    double dy  = l2.y - l1.y;
+    double len = std::sqrt(dx * dx + dy * dy);
+
+    if (len < REJECTEPSILON)
+        return 0;
+
+    return (dx * (p.y - l1.y) - dy * (p.x - l1.x)) / len;
+}
+
+//
+// ClipToSide
+// Keep the part of seg on the given side (1 = left, -1 = right) of
+// the line through l1 and l2.  Returns false if nothing is left.
+//
+static bool ClipToSide(rseg_t *seg, const rvec_t &l1, const rvec_t &l2, int side)
+{
+    double d1, d2, t;
+
+    if (l1.x == l2.x && l1.y == l2.y)
+        return true;
+
+    d1 = side * SideDistance(l1, l2, seg->a) + REJECTEPSILON;
+    d2 = side * SideDistance(l1, l2, seg->b) + REJECTEPSILON;
+
+    if (d1 >= 0 && d2 >= 0)
+        return true;
+
+    if (d1 < 0 && d2 < 0)
+        return false;
+
+    t = d1 / (d1 - d2);
+
+    if (d1 < 0)
+    {
+        seg->a.x += t * (seg->b.x - seg->a.x);
+        seg->a.y += t * (seg->b.y - seg->a.y);
+    }
+    else
+    {
+        seg->b.x = seg->a.x + t * (seg->b.x - seg->a.x);
+        seg->b.y = seg->a.y + t * (seg->b.y - seg->a.y);
+    }
+
+    return true;
+}
+
+//
+// ClipToSeparators
+// Keep the part of target that a straight line through source and
+// then pass can reach.  It is bounded by the lines joining an end of
+// source to an end of pass that have the two segments on opposite
+// sides.
+//
+static bool ClipToSeparators(const rseg_t &source, const rseg_t &pass, rseg_t *target)
+{
+    const rvec_t *s[2] = { &source.a, &source.b };
+    const rvec_t *p[2] = { &pass.a, &pass.b };
+
+    for (int i = 0; i < 2; i++)
+    {
+        for (int j = 0; j < 2; j++)
+        {
+            double ds = SideDistance(*s[i], *p[j], *s[!i]);
+            double dp = SideDistance(*s[i], *p[j], *p[!j]);
+            int    side;
+
+            if (std::fabs(ds) < REJECTEPSILON)
+                ds = 0;
+            if (std::fabs(dp) < REJECTEPSILON)
+                dp = 0;
+
+            // not a separating line?
+            if ((ds > 0 && dp > 0) || (ds < 0 && dp < 0))
+                continue;
+
+            if (ds != 0)
+                side = ds > 0 ? -1 : 1;
+            else if (dp != 0)
+                side = dp > 0 ? 1 : -1;
+            else
+                continue;
+
+            if (!ClipToSide(target, *s[i], *p[j], side))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+//
+// RecursiveReject
+// Follow the portals out of sector that can be reached by a straight
+// line through source and pass.  With depth 0, source and pass are
+// the same portal.
+//
+static void RecursiveReject(rejectwork_t *work, const rseg_t &source, const rseg_t &pass,
+    int sector, int depth)
+{
+    for (int i = firstportal[sector]; i < firstportal[sector + 1]; i++)
+    {
+        const rportal_t *portal = &portals[i];
+        rseg_t           target = portal->seg;
+        rseg_t           newsource;
+
+        if (work->instack[portal->line])
+            continue;
+
+        if (--work->budget < 0 || depth >= REJECTMAXDEPTH)
+        {
+            work->overflow = true;
+            return;
+        }
+
+        if (!ClipToSide(&target, pass.a, pass.b, 1))
+            continue;
+
+        if (depth > 0 && !ClipToSeparators(source, pass, &target))
+            continue;
+
+        MarkVisible(work->row, portal->to);
+
+        // Narrow the source down to what can see the new pass.
+        newsource = source;
+
+        if (depth > 0 && !ClipToSeparators(target, pass, &newsource))
+            continue;
+
+        work->instack[portal->line] = 1;
+        RecursiveReject(work, newsource, target, portal->to, depth + 1);
+        work->instack[portal->line] = 0;
+
+        if (work->overflow)
+            return;
+    }
+}
+
+// Mark every sector connected to sector through portals.
+static void FloodReject(rejectwork_t *work, int sector)
+{
+    int sp = 0;
+
+    MarkVisible(work->row, sector);
+    work->floodstack[sp++] = sector;
+
+    while (sp > 0)
+    {
+        int s = work->floodstack[--sp];
+
+        for (int i = firstportal[s]; i < firstportal[s + 1]; i++)
+        {
+            int to = portals[i].to;
+
+            if (!IsVisible(work->row, to))
+            {
+                MarkVisible(work->row, to);
+                work->floodstack[sp++] = to;
+            }
+        }
+    }
+}
+
+static void BuildRejectRow(rejectwork_t *work, int sector)
+{
+    work->row      = visrows + static_cast<size_t>(sector) * visrowbytes;
+    work->budget   = REJECTBUDGET;
+    work->overflow = false;
+
+    if (leaky[sector])
+    {
+        std::memset(work->row, 0xff, visrowbytes);
+        return;
+    }
+
+    MarkVisible(work->row, sector);
+
+    for (int i = firstportal[sector]; i < firstportal[sector + 1]; i++)
+    {
+        const rportal_t *portal = &portals[i];
+
+        MarkVisible(work->row, portal->to);
+
+        work->instack[portal->line] = 1;
+        RecursiveReject(work, portal->seg, portal->seg, portal->to, 0);
+        work->instack[portal->line] = 0;
+
+        if (work->overflow)
+            break;
+    }
+
+    if (work->overflow)
+    {
+        // Start over, as the flood fill only expands from sectors it
+        // has not seen yet.
+        std::memset(work->row, 0, visrowbytes);
+        FloodReject(work, sector);
+        work->numflooded++;
+    }
+}
+
+static void P_BuildRejectWorker(void *, int worker)
+{
+    rejectwork_t *work       = &rejectwork[worker];
+    int           numworkers = I_NumWorkers();
+
+    // Each worker writes to whole rows of its own, so no locking is
+    // needed.
+    for (int i = worker; i < g_r_state_globals->numsectors; i += numworkers)
+    {
+        BuildRejectRow(work, i);
+    }
+}
+
+static rvec_t VertexToVec(const vertex_t *v)
+{
+    return { static_cast<double>(v->x) / FRACUNIT, static_cast<double>(v->y) / FRACUNIT };
+}
+
+//
+// P_InitRejectPortals
+// Collect the portals of each sector and find the sectors that a
+// straight line might leave without crossing one.
+//
+static void P_InitRejectPortals()
+{
+    const int numsectors = g_r_state_globals->numsectors;
+    sector_t *sectors    = g_r_state_globals->sectors;
+    int       numportals = 0;
+    int       i;
+
+    firstportal = zmalloc<int *>((numsectors + 1) * sizeof(*firstportal), PU_STATIC, nullptr);
+    leaky       = zmalloc<uint8_t *>(numsectors, PU_STATIC, nullptr);
+    std::memset(firstportal, 0, (numsectors + 1) * sizeof(*firstportal));
+    std::memset(leaky, 0, numsectors);
+
+    // Count the portals leaving each sector.  A line facing the same
+    // sector on both sides, as used for deep water and invisible
+    // stairs, lets sight pass into a region that belongs to another
+    // sector, so such sectors can see and be seen from everywhere.
+
+    for (i = 0; i < g_r_state_globals->numlines; i++)
+    {
+        const line_t *line = &g_r_state_globals->lines[i];
+
+        if (!(line->flags & ML_TWOSIDED) || line->backsector == nullptr)
+            continue;
+
+        if (line->frontsector == line->backsector)
+        {
+            leaky[line->frontsector - sectors] = 1;
+            continue;
+        }
+
+        firstportal[line->frontsector - sectors + 1]++;
+        firstportal[line->backsector - sectors + 1]++;
+        numportals += 2;
+    }
+
+    // The same goes for subsectors built from segs of more than one
+    // sector, since things in them use the sector of the first seg.
+
+    for (i = 0; i < g_r_state_globals->numsubsectors; i++)
+    {
+        const subsector_t *sub = &g_r_state_globals->subsectors[i];
+
+        for (int j = 0; j < sub->numlines; j++)
+        {
+            const seg_t *seg = &g_r_state_globals->segs[sub->firstline + j];
+
+            if (seg->frontsector != nullptr && seg->frontsector != sub->sector)
+            {
+                leaky[sub->sector - sectors]      = 1;
+                leaky[seg->frontsector - sectors] = 1;
+            }
+        }
+    }
+
+    for (i = 0; i < numsectors; i++)
+    {
+        firstportal[i + 1] += firstportal[i];
+    }
+
+    portals = zmalloc<rportal_t *>(numportals * sizeof(*portals) + 1, PU_STATIC, nullptr);
+
+    // Fill in the portals, using firstportal[] as the insert position
+    // of each sector and shifting it back afterwards.
+
+    for (i = 0; i < g_r_state_globals->numlines; i++)
+    {
+        const line_t *line = &g_r_state_globals->lines[i];
+        rvec_t        v1, v2;
+        int           front, back;
+        rportal_t *   portal;
+
+        if (!(line->flags & ML_TWOSIDED) || line->backsector == nullptr
+            || line->frontsector == line->backsector)
+            continue;
+
+        v1    = VertexToVec(line->v1);
+        v2    = VertexToVec(line->v2);
+        front = static_cast<int>(line->frontsector - sectors);
+        back  = static_cast<int>(line->backsector - sectors);
+
+        // The front side is on the right of v1 -> v2.
+        portal       = &portals[firstportal[front]++];
+        portal->seg  = { v1, v2 };
+        portal->line = i;
+        portal->to   = back;
+
+        portal       = &portals[firstportal[back]++];
+        portal->seg  = { v2, v1 };
+        portal->line = i;
+        portal->to   = front;
+    }
+
+    for (i = numsectors; i > 0; i--)
+    {
+        firstportal[i] = firstportal[i - 1];
+    }
+
+    firstportal[0] = 0;
+}
+
+//
+// RejectCacheFile
+// The cache is keyed by a hash of the map geometry lumps, so that the
+// same map loaded from a different PWAD still finds its entry.
+//
+static char *RejectCacheFile(int lumpnum)
+{
+    sha1_context_t context;
+    sha1_digest_t  digest;
+    char           hex[sizeof(digest) * 2 + 1];
+
+    SHA1_Init(&context);
+    SHA1_UpdateInt32(&context, REJECTVERSION);
+
+    for (int i = ML_LINEDEFS; i <= ML_SECTORS; i++)
+    {
+        int len = static_cast<int>(W_LumpLength(lumpnum + i));
+
+        SHA1_UpdateInt32(&context, len);
+
+        if (len > 0)
+        {
+            auto *data = cache_lump_num<uint8_t *>(lumpnum + i, PU_STATIC);
+            SHA1_Update(&context, data, len);
+            W_ReleaseLumpNum(lumpnum + i);
+        }
+    }
+
+    SHA1_Final(digest, &context);
+
+    for (size_t i = 0; i < sizeof(digest); i++)
+    {
+        M_snprintf(hex + i * 2, 3, "%02x", digest[i]);
+    }
+
+    return M_StringJoin(configdir, "reject", DIR_SEPARATOR_S, hex, ".rej", nullptr);
+}
+
+static bool ReadRejectCache(const char *filename, uint8_t *rejectmatrix, size_t len)
+{
+    FILE *  file = fopen(filename, "rb");
+    uint8_t header[8];
+    bool    result;
+
+    if (file == nullptr)
+        return false;
+
+    result = fread(header, 1, sizeof(header), file) == sizeof(header)
+             && !memcmp(header, REJECTMAGIC, 4)
+             && static_cast<int>(header[4] | (header[5] << 8) | (header[6] << 16) | (header[7] << 24)) == g_r_state_globals->numsectors
+             && fread(rejectmatrix, 1, len, file) == len;
+
+    fclose(file);
+
+    return result;
+}
+
+static void WriteRejectCache(const char *filename, const uint8_t *rejectmatrix, size_t len)
+{
+    const int numsectors = g_r_state_globals->numsectors;
+    char *    dir        = M_DirName(filename);
+    FILE *    file;
+    uint8_t   header[8];
+
+    M_MakeDirectory(dir);
+    free(dir);
+
+    file = fopen(filename, "wb");
+
+    if (file == nullptr)
+        return;
+
+    std::memcpy(header, REJECTMAGIC, 4);
+    header[4] = numsectors & 0xff;
+    header[5] = (numsectors >> 8) & 0xff;
+    header[6] = (numsectors >> 16) & 0xff;
+    header[7] = (numsectors >> 24) & 0xff;
+
+    if (fwrite(header, 1, sizeof(header), file) != sizeof(header)
+        || fwrite(rejectmatrix, 1, len, file) != len)
+    {
+        fclose(file);
+        remove(filename);
+        return;
+    }
+
+    fclose(file);
+}
+
+void P_BuildReject(int lumpnum, uint8_t *rejectmatrix)
+{
+    const int numsectors = g_r_state_globals->numsectors;
+    const int numworkers = I_NumWorkers();
+    size_t    len        = (static_cast<size_t>(numsectors) * numsectors + 7) / 8;
+    char *    filename   = RejectCacheFile(lumpnum);
+    int       starttime  = I_GetTimeMS();
+    int       numflooded = 0;
+    int       i;
+
+    if (ReadRejectCache(filename, rejectmatrix, len))
+    {
+        free(filename);
+        return;
+    }
+
+    P_InitRejectPortals();
+
+    visrowbytes = (numsectors + 7) / 8;
+    visrows     = zmalloc<uint8_t *>(static_cast<size_t>(numsectors) * visrowbytes, PU_STATIC, nullptr);
+    std::memset(visrows, 0, static_cast<size_t>(numsectors) * visrowbytes);
+
+    // The zone allocator is not thread safe, so everything the workers
+    // need is allocated up front.
+
+    for (i = 0; i < numworkers; i++)
+    {
+        rejectwork_t *work = &rejectwork[i];
+
+        work->instack    = zmalloc<uint8_t *>(g_r_state_globals->numlines + 1, PU_STATIC, nullptr);
+        work->floodstack = zmalloc<int *>(numsectors * sizeof(*work->floodstack), PU_STATIC, nullptr);
+        work->numflooded = 0;
+        std::memset(work->instack, 0, g_r_state_globals->numlines + 1);
+    }
+
+    I_RunOnWorkers(P_BuildRejectWorker, nullptr);
+
+    // Sight is symmetric, so only reject a pair if neither sector was
+    // found to see the other.
+
+    std::memset(rejectmatrix, 0, len);
+
+    for (int s1 = 0; s1 < numsectors; s1++)
+    {
+        const uint8_t *row1 = visrows + static_cast<size_t>(s1) * visrowbytes;
+
+        for (int s2 = 0; s2 < numsectors; s2++)
+        {
+            const uint8_t *row2 = visrows + static_cast<size_t>(s2) * visrowbytes;
+
+            if (!IsVisible(row1, s2) && !IsVisible(row2, s1))
+            {
+                size_t pnum = static_cast<size_t>(s1) * numsectors + s2;
+                rejectmatrix[pnum >> 3] |= 1 << (pnum & 7);
+            }
+        }
+    }
+
+    for (i = 0; i < numworkers; i++)
+    {
+        numflooded += rejectwork[i].numflooded;
+        Z_Free(rejectwork[i].instack);
+        Z_Free(rejectwork[i].floodstack);
+    }
+
+    Z_Free(visrows);
+    Z_Free(portals);
+    Z_Free(firstportal);
+    Z_Free(leaky);
+
+    printf("P_BuildReject: %d sectors in %d ms", numsectors, I_GetTimeMS() - starttime);
+
+    if (numflooded > 0)
+        printf(" (%d by connectivity only)", numflooded);
+
+    printf("\n");
+
+    WriteRejectCache(filename, rejectmatrix, len);
+    free(filename);
+}
@@ -0,0 +1,31 @@
+//
+// Copyright(C) 1993-1996 Id Software, Inc.
+// Copyright(C) 2005-2014 Simon Howard
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//	Load time REJECT matrix builder.
+//
+
+
+#ifndef __P_REJECT__
+#define __P_REJECT__
+
+#include <cstdint>
+
+// Fill in the REJECT matrix of the level that has just been loaded,
+// from the cache if possible.  lumpnum is the map header lump, and
+// rejectmatrix must hold (numsectors * numsectors + 7) / 8 bytes.
+// Needs the lines, segs and subsectors to be loaded.
+void P_BuildReject(int lumpnum, uint8_t *rejectmatrix);
+
+#endif
@@ -33,7 +33,9 @@
 #include "m_misc.hpp"
 #include "r_state.hpp"
 
-FILE *     save_stream;
+MEMFILE *  save_stream;
+static uint8_t *save_buffer; // [crispy] file contents backing a read stream
+static size_t   save_length;
 int        savegamelength;
 bool    savegame_error;
 static int restoretargets_fail;
@@ -74,13 +76,153 @@ char *P_SaveGameFile(int slot)
     return filename;
 }
 
+// [crispy] Read the whole savegame file into memory and open a stream
+// on it, so that the deserializer never has to go through stdio.
+
+bool P_OpenSaveGameRead(const char *filename)
+{
+    FILE *handle = fopen(filename, "rb");
+
+    if (handle == nullptr)
+        return false;
+
+    long   length = M_FileLength(handle);
+    size_t count  = 0;
+
+    if (length >= 0)
+    {
+        save_buffer = zmalloc<uint8_t *>(static_cast<size_t>(length) + 1, PU_STATIC, nullptr);
+        count       = fread(save_buffer, 1, static_cast<size_t>(length), handle);
+    }
+    fclose(handle);
+
+    if (length < 0 || count < static_cast<size_t>(length))
+    {
+        if (save_buffer)
+        {
+            Z_Free(save_buffer);
+            save_buffer = nullptr;
+        }
+        return false;
+    }
+
+    save_length = static_cast<size_t>(length);
+    save_stream = mem_fopen_read(save_buffer, save_length);
+
+    return true;
+}
+
+// [crispy] Start serializing a new savegame into a growable buffer.
+
+void P_OpenSaveGameWrite()
+{
+    save_stream = mem_fopen_write();
+}
+
+// [crispy] Flush the serialized savegame to a file with a single write.
+
+bool P_WriteSaveGameFile(const char *filename)
+{
+    void * buf;
+    size_t buflen;
+
+    mem_get_buf(save_stream, &buf, &buflen);
+
+    return M_WriteFile(filename, buf, static_cast<int>(buflen));
+}
+
+void P_CloseSaveGame()
+{
+    if (save_stream)
+    {
+        mem_fclose(save_stream);
+        save_stream = nullptr;
+    }
+
+    if (save_buffer)
+    {
+        Z_Free(save_buffer);
+        save_buffer = nullptr;
+    }
+}
+
 // Endian-safe integer read/write functions
 
-static uint8_t saveg_read8()
+// [crispy] Blocks.  The struct codecs write a field at a time, so the
+// archive functions wrap each section in a block: reads inside one are
+// decoded straight from the loaded file, and writes are collected in
+// saveg_block and passed on to the stream a few KB at a time.
+
+#define SAVEGBLOCKSIZE 4096
+
+static uint8_t saveg_block[SAVEGBLOCKSIZE];
+static size_t  saveg_blockstart; // stream position of a read block
+static size_t  saveg_blockpos;   // bytes read or buffered so far
+static bool    saveg_inblock;
+
+static void saveg_begin_read()
 {
-    uint8_t result = static_cast<uint8_t >(-1);
+    saveg_blockstart = static_cast<size_t>(mem_ftell(save_stream));
+    saveg_blockpos   = 0;
+    saveg_inblock    = true;
+}
 
-    if (fread(&result, 1, 1, save_stream) < 1)
+static void saveg_end_read()
+{
+    saveg_inblock = false;
+    mem_fseek(save_stream, static_cast<long>(saveg_blockstart + saveg_blockpos), MEM_SEEK_SET);
+}
+
+static void saveg_begin_write()
+{
+    saveg_blockpos = 0;
+    saveg_inblock  = true;
+}
+
+static void saveg_flush_block()
+{
+    if (mem_fwrite(saveg_block, 1, saveg_blockpos, save_stream) < saveg_blockpos)
+    {
+        if (!savegame_error)
+        {
+            fprintf(stderr, "saveg_write8: Error while writing save game\n");
+
+            savegame_error = true;
+        }
+    }
+
+    saveg_blockpos = 0;
+}
+
+static void saveg_end_write()
+{
+    saveg_flush_block();
+    saveg_inblock = false;
+}
+
+// [crispy] Read/write runs of bytes; the fixed-size integer codecs
+// below are built on top of these.
+
+static void saveg_read_bytes(uint8_t *bytes, size_t count)
+{
+    size_t read;
+
+    if (saveg_inblock)
+    {
+        const size_t pos = saveg_blockstart + saveg_blockpos;
+
+        read = pos >= save_length         ? 0
+               : count > save_length - pos ? save_length - pos
+                                           : count;
+        std::memcpy(bytes, save_buffer + pos, read);
+        saveg_blockpos += read;
+    }
+    else
+    {
+        read = mem_fread(bytes, 1, count, save_stream);
+    }
+
+    if (read < count)
     {
         if (!savegame_error)
         {
@@ -89,14 +231,24 @@ static uint8_t saveg_read8()
 
             savegame_error = true;
         }
-    }
 
-    return result;
+        std::memset(bytes, 0xff, count);
+    }
 }
 
-static void saveg_write8(uint8_t value)
+static void saveg_write_bytes(const uint8_t *bytes, size_t count)
 {
-    if (fwrite(&value, 1, 1, save_stream) < 1)
+    if (saveg_inblock)
+    {
+        if (saveg_blockpos + count > SAVEGBLOCKSIZE)
+            saveg_flush_block();
+
+        std::memcpy(saveg_block + saveg_blockpos, bytes, count);
+        saveg_blockpos += count;
+        return;
+    }
+
+    if (mem_fwrite(bytes, 1, count, save_stream) < count)
     {
         if (!savegame_error)
         {
@@ -107,38 +259,61 @@ static void saveg_write8(uint8_t value)
     }
 }
 
+static uint8_t saveg_read8()
+{
+    uint8_t result;
+
+    saveg_read_bytes(&result, 1);
+
+    return result;
+}
+
+static void saveg_write8(uint8_t value)
+{
+    saveg_write_bytes(&value, 1);
+}
+
 static short saveg_read16()
 {
-    int result = saveg_read8();
-    result |= saveg_read8() << 8;
+    uint8_t bytes[2];
+
+    saveg_read_bytes(bytes, sizeof(bytes));
 
-    return static_cast<short>(result);
+    return static_cast<short>(bytes[0] | (bytes[1] << 8));
 }
 
 static void saveg_write16(short value)
 {
-    saveg_write8(static_cast<uint8_t>(value & 0xff));
-    saveg_write8(static_cast<uint8_t>((value >> 8) & 0xff));
+    const uint8_t bytes[2] = {
+        static_cast<uint8_t>(value & 0xff),
+        static_cast<uint8_t>((value >> 8) & 0xff),
+    };
+
+    saveg_write_bytes(bytes, sizeof(bytes));
 }
 
 static int saveg_read32()
 {
-    int result;
+    uint8_t bytes[4];
 
-    result = saveg_read8();
-    result |= saveg_read8() << 8;
-    result |= saveg_read8() << 16;
-    result |= saveg_read8() << 24;
+    saveg_read_bytes(bytes, sizeof(bytes));
 
-    return result;
+    return static_cast<int>(static_cast<uint32_t>(bytes[0])
+                            | (static_cast<uint32_t>(bytes[1]) << 8)
+                            | (static_cast<uint32_t>(bytes[2]) << 16)
+                            | (static_cast<uint32_t>(bytes[3]) << 24));
 }
 
 static void saveg_write32(int value)
 {
-    saveg_write8(static_cast<uint8_t>(value & 0xff));
-    saveg_write8(static_cast<uint8_t>((value >> 8) & 0xff));
-    saveg_write8(static_cast<uint8_t>((value >> 16) & 0xff));
-    saveg_write8(static_cast<uint8_t>((value >> 24) & 0xff));
+    const uint8_t bytes[4] = {
+        static_cast<uint8_t>(value & 0xff),
+        static_cast<uint8_t>((value >> 8) & 0xff),
+        static_cast<uint8_t>((value >> 16) & 0xff),
+        static_cast<uint8_t>((value >> 24) & 0xff),
+    };
+
+    saveg_write_bytes(bytes, sizeof(bytes));
 }
 
 // Pad to 4-byte boundaries
@@ -149,7 +324,10 @@ static void saveg_read_pad()
     int           padding;
     int           i;
 
-    pos = static_cast<unsigned long>(ftell(save_stream));
+    pos = static_cast<unsigned long>(mem_ftell(save_stream));
+
+    if (saveg_inblock)
+        pos = static_cast<unsigned long>(saveg_blockstart + saveg_blockpos);
 
     padding = (4 - (pos & 3)) & 3;
 
@@ -165,7 +343,10 @@ static void saveg_write_pad()
     int           padding;
     int           i;
 
-    pos = static_cast<unsigned long>(ftell(save_stream));
+    pos = static_cast<unsigned long>(mem_ftell(save_stream));
+
+    if (saveg_inblock)
+        pos += static_cast<unsigned long>(saveg_blockpos);
 
     padding = (4 - (pos & 3)) & 3;
 
@@ -418,6 +599,91 @@ static void saveg_read_mobj_t(mobj_t *str)
     str->tracer = static_cast<mobj_t *>(saveg_readp());
 }
 
+// [crispy] one-pass maps between mobj thinkers and their savegame
+// indices, so that translating a pointer does not walk the whole
+// thinker list.  They are only valid while a game is being saved or
+// restored; otherwise the functions below fall back to a list walk.
+
+struct thinkerslot_t
+{
+    thinker_t *thinker;
+    uint32_t   index;
+};
+
+static thinkerslot_t *thinkerslots;     // thinker -> index hash
+static unsigned       thinkerhashsize;  // power of 2
+static thinker_t **   indexthinkers;    // index - 1 -> thinker
+static unsigned       indexthinkerssize;
+static uint32_t       numindexthinkers;
+static bool           thinkerindexvalid;
+
+static unsigned P_ThinkerSlot(const thinker_t *thinker)
+{
+    auto key = reinterpret_cast<uintptr_t>(thinker);
+
+    // thinkers are at least pointer aligned, so drop the low bits
+    // and mix the rest (Fibonacci hashing)
+    key >>= 3;
+    return static_cast<unsigned>((key * 0x9E3779B97F4A7C15ull) >> 32) & (thinkerhashsize - 1);
+}
+
+static void P_BuildThinkerIndex()
+{
+    thinker_t *th;
+    uint32_t   count = 0;
+    unsigned   size;
+
+    action_hook needle = P_MobjThinker;
+    for (th = g_p_local_globals->thinkercap.next; th != &g_p_local_globals->thinkercap; th = th->next)
+    {
+        if (th->function == needle)
+            count++;
+    }
+
+    // keep the hash table at most half full
+    for (size = 256; size < count * 2; size <<= 1)
+        ;
+
+    if (size > thinkerhashsize)
+    {
+        thinkerslots    = static_cast<decltype(thinkerslots)>(I_Realloc(thinkerslots, size * sizeof(*thinkerslots)));
+        thinkerhashsize = size;
+    }
+
+    if (count > indexthinkerssize)
+    {
+        indexthinkers     = static_cast<decltype(indexthinkers)>(I_Realloc(indexthinkers, count * sizeof(*indexthinkers)));
+        indexthinkerssize = count;
+    }
+
+    memset(thinkerslots, 0, thinkerhashsize * sizeof(*thinkerslots));
+
+    numindexthinkers = 0;
+    for (th = g_p_local_globals->thinkercap.next; th != &g_p_local_globals->thinkercap; th = th->next)
+    {
+        if (th->function == needle)
+        {
+            unsigned slot = P_ThinkerSlot(th);
+
+            while (thinkerslots[slot].thinker)
+                slot = (slot + 1) & (thinkerhashsize - 1);
+
+            indexthinkers[numindexthinkers++] = th;
+            thinkerslots[slot].thinker        = th;
+            thinkerslots[slot].index          = numindexthinkers;
+        }
+    }
+
+    thinkerindexvalid = true;
+}
+
+// [crispy] drop the index maps once the savegame has been written or
+// read, the thinker list is going to change again from here on
+void P_ClearThinkerIndex()
+{
+    thinkerindexvalid = false;
+}
+
 // [crispy] enumerate all thinker pointers
 uint32_t P_ThinkerToIndex(thinker_t *thinker)
 {
@@ -427,6 +693,21 @@ uint32_t P_ThinkerToIndex(thinker_t *thinker)
     if (!thinker)
         return 0;
 
+    if (thinkerindexvalid)
+    {
+        unsigned slot = P_ThinkerSlot(thinker);
+
+        while (thinkerslots[slot].thinker)
+        {
+            if (thinkerslots[slot].thinker == thinker)
+                return thinkerslots[slot].index;
+
+            slot = (slot + 1) & (thinkerhashsize - 1);
+        }
+
+        return 0;
+    }
+
     action_hook needle = P_MobjThinker;
     for (th = g_p_local_globals->thinkercap.next, i = 0; th != &g_p_local_globals->thinkercap; th = th->next)
     {
@@ -450,6 +731,16 @@ thinker_t *P_IndexToThinker(uint32_t index)
     if (!index)
         return nullptr;
 
+    if (thinkerindexvalid)
+    {
+        if (index <= numindexthinkers)
+            return indexthinkers[index - 1];
+
+        restoretargets_fail++;
+
+        return nullptr;
+    }
+
     action_hook needle = P_MobjThinker;
     for (th = g_p_local_globals->thinkercap.next, i = 0; th != &g_p_local_globals->thinkercap; th = th->next)
     {
@@ -1509,6 +1800,8 @@ void P_ArchivePlayers()
 {
     int i;
 
+    saveg_begin_write();
+
     for (i = 0; i < MAXPLAYERS; i++)
     {
         if (!g_doomstat_globals->playeringame[i])
@@ -1518,6 +1811,8 @@ void P_ArchivePlayers()
 
         saveg_write_player_t(&g_doomstat_globals->players[i]);
     }
+
+    saveg_end_write();
 }
 
 
@@ -1528,6 +1823,8 @@ void P_UnArchivePlayers()
 {
     int i;
 
+    saveg_begin_read();
+
     for (i = 0; i < MAXPLAYERS; i++)
     {
         if (!g_doomstat_globals->playeringame[i])
@@ -1542,6 +1839,8 @@ void P_UnArchivePlayers()
         g_doomstat_globals->players[i].message  = nullptr;
         g_doomstat_globals->players[i].attacker = nullptr;
     }
+
+    saveg_end_read();
 }
 
 
@@ -1556,6 +1855,8 @@ void P_ArchiveWorld()
     line_t *  li;
     side_t *  si;
 
+    saveg_begin_write();
+
     // do sectors
     for (i = 0, sec = g_r_state_globals->sectors; i < g_r_state_globals->numsectors; i++, sec++)
     {
@@ -1589,6 +1890,8 @@ void P_ArchiveWorld()
             saveg_write16(si->midtexture);
         }
     }
+
+    saveg_end_write();
 }
 
 
@@ -1603,6 +1906,8 @@ void P_UnArchiveWorld()
     line_t *  li;
     side_t *  si;
 
+    saveg_begin_read();
+
     // do sectors
     for (i = 0, sec = g_r_state_globals->sectors; i < g_r_state_globals->numsectors; i++, sec++)
     {
@@ -1647,6 +1952,8 @@ void P_UnArchiveWorld()
             si->midtexture    = saveg_read16();
         }
     }
+
+    saveg_end_read();
 }
 
 
@@ -1668,6 +1975,11 @@ void P_ArchiveThinkers()
 {
     thinker_t *th;
 
+    // [crispy] map thinkers to indices once for all target/tracer fields
+    P_BuildThinkerIndex();
+
+    saveg_begin_write();
+
     // save off the current thinkers
     action_hook needle = P_MobjThinker;
     for (th = g_p_local_globals->thinkercap.next; th != &g_p_local_globals->thinkercap; th = th->next)
@@ -1686,6 +1998,8 @@ void P_ArchiveThinkers()
 
     // add a terminating marker
     saveg_write8(tc_end);
+
+    saveg_end_write();
 }
 
 
@@ -1709,12 +2023,14 @@ void P_UnArchiveThinkers()
         if (currentthinker->function == needle)
             P_RemoveMobj(reinterpret_cast<mobj_t *>(currentthinker));
         else
-            Z_Free(currentthinker);
+            P_FreeThinker(currentthinker);
 
         currentthinker = next;
     }
     P_InitThinkers();
 
+    saveg_begin_read();
+
     // read in saved thinkers
     while (true)
     {
@@ -1722,11 +2038,12 @@ void P_UnArchiveThinkers()
         switch (tclass)
         {
         case tc_end:
+            saveg_end_read();
             return; // end of list
 
         case tc_mobj:
             saveg_read_pad();
-            mobj = zmalloc<decltype(mobj)>(sizeof(*mobj), PU_LEVEL, nullptr);
+            mobj = thinkermalloc<decltype(mobj)>(sizeof(*mobj));
             saveg_read_mobj_t(mobj);
 
             // [crispy] restore mobj->target and mobj->tracer fields
@@ -1754,6 +2071,9 @@ void P_RestoreTargets()
     mobj_t *   mo;
     thinker_t *th;
 
+    // [crispy] all thinkers are restored now, map indices to them once
+    P_BuildThinkerIndex();
+
     action_hook needle = P_MobjThinker;
     for (th = g_p_local_globals->thinkercap.next; th != &g_p_local_globals->thinkercap; th = th->next)
     {
@@ -1816,6 +2136,9 @@ void P_ArchiveSpecials()
     action_hook needle_light_flash   = T_LightFlash;
     action_hook needle_strobe_flash  = T_StrobeFlash;
     action_hook needle_glow          = T_Glow;
+
+    saveg_begin_write();
+
     for (th = g_p_local_globals->thinkercap.next; th != &g_p_local_globals->thinkercap; th = th->next)
     {
         if (th->function == null_needle)
@@ -1903,6 +2226,8 @@ void P_ArchiveSpecials()
 
     // add a terminating marker
     saveg_write8(static_cast<uint8_t>(specials_e::tc_endspecials));
+
+    saveg_end_write();
 }
 
 
@@ -1920,6 +2245,7 @@ void P_UnArchiveSpecials()
     strobe_t *    strobe;
     glow_t *      glow;
 
+    saveg_begin_read();
 
     // read in saved thinkers
     while (true)
@@ -1929,11 +2255,12 @@ void P_UnArchiveSpecials()
         switch (tclass)
         {
         case specials_e::tc_endspecials:
+            saveg_end_read();
             return; // end of list
 
         case specials_e::tc_ceiling:
             saveg_read_pad();
-            ceiling = zmalloc<decltype(ceiling)>(sizeof(*ceiling), PU_LEVEL, nullptr);
+            ceiling = thinkermalloc<decltype(ceiling)>(sizeof(*ceiling));
             saveg_read_ceiling_t(ceiling);
             ceiling->sector->specialdata = ceiling;
 
@@ -1946,7 +2273,7 @@ void P_UnArchiveSpecials()
 
         case specials_e::tc_door:
             saveg_read_pad();
-            door = zmalloc<decltype(door)>(sizeof(*door), PU_LEVEL, nullptr);
+            door = thinkermalloc<decltype(door)>(sizeof(*door));
             saveg_read_vldoor_t(door);
             door->sector->specialdata = door;
             door->thinker.function    = T_VerticalDoor;
@@ -1955,7 +2282,7 @@ void P_UnArchiveSpecials()
 
         case specials_e::tc_floor:
             saveg_read_pad();
-            floor = zmalloc<decltype(floor)>(sizeof(*floor), PU_LEVEL, nullptr);
+            floor = thinkermalloc<decltype(floor)>(sizeof(*floor));
             saveg_read_floormove_t(floor);
             floor->sector->specialdata = floor;
             floor->thinker.function    = T_MoveFloor;
@@ -1964,7 +2291,7 @@ void P_UnArchiveSpecials()
 
         case specials_e::tc_plat:
             saveg_read_pad();
-            plat = zmalloc<decltype(plat)>(sizeof(*plat), PU_LEVEL, nullptr);
+            plat = thinkermalloc<decltype(plat)>(sizeof(*plat));
             saveg_read_plat_t(plat);
             plat->sector->specialdata = plat;
 
@@ -1977,7 +2304,7 @@ void P_UnArchiveSpecials()
 
         case specials_e::tc_flash:
             saveg_read_pad();
-            flash = zmalloc<decltype(flash)>(sizeof(*flash), PU_LEVEL, nullptr);
+            flash = thinkermalloc<decltype(flash)>(sizeof(*flash));
             saveg_read_lightflash_t(flash);
             flash->thinker.function = T_LightFlash;
             P_AddThinker(&flash->thinker);
@@ -1985,7 +2312,7 @@ void P_UnArchiveSpecials()
 
         case specials_e::tc_strobe:
             saveg_read_pad();
-            strobe = zmalloc<decltype(strobe)>(sizeof(*strobe), PU_LEVEL, nullptr);
+            strobe = thinkermalloc<decltype(strobe)>(sizeof(*strobe));
             saveg_read_strobe_t(strobe);
             strobe->thinker.function = T_StrobeFlash;
             P_AddThinker(&strobe->thinker);
@@ -1993,7 +2320,7 @@ void P_UnArchiveSpecials()
 
         case specials_e::tc_glow:
             saveg_read_pad();
-            glow = zmalloc<decltype(glow)>(sizeof(*glow), PU_LEVEL, nullptr);
+            glow = thinkermalloc<decltype(glow)>(sizeof(*glow));
             saveg_read_glow_t(glow);
             glow->thinker.function = T_Glow;
             P_AddThinker(&glow->thinker);
@@ -22,6 +22,8 @@
 
 #include <cstdio>
 
+#include "memio.hpp"
+
 #define SAVEGAME_EOF 0x1d
 #define VERSIONSIZE  16
 
@@ -29,6 +31,14 @@
 
 #define SAVESTRINGSIZE 24
 
+// [crispy] the whole savegame is serialized through a memory buffer,
+// which is read from or written to the file in one go.
+
+bool P_OpenSaveGameRead(const char *filename);
+void P_OpenSaveGameWrite();
+bool P_WriteSaveGameFile(const char *filename);
+void P_CloseSaveGame();
+
 // temporary filename to use while saving.
 
 char *P_TempSaveGameFile();
@@ -58,8 +68,9 @@ void P_UnArchiveThinkers();
 void P_ArchiveSpecials();
 void P_UnArchiveSpecials();
 void P_RestoreTargets();
+void P_ClearThinkerIndex();
 
-extern FILE *  save_stream;
+extern MEMFILE *save_stream;
 extern bool savegame_error;
 
 
@@ -31,6 +31,7 @@
 #include "g_game.hpp"
 
 #include "i_system.hpp"
+#include "i_thread.hpp" // [crispy] I_RunTasks()
 #include "w_wad.hpp"
 
 #include "doomdef.hpp"
@@ -44,6 +45,7 @@
 #include "lump.hpp"
 #include "memory.hpp"
 #include "p_extnodes.hpp" // [crispy] support extended node formats
+#include "p_reject.hpp"   // [crispy] P_BuildReject()
 
 void P_SpawnMapThing(mapthing_t *mthing);
 
@@ -223,9 +225,8 @@ void P_SegLengths(bool contrast_only)
             li->length = static_cast<uint32_t>(sqrt(static_cast<double>(dx) * static_cast<double>(dx) + static_cast<double>(dy) * static_cast<double>(dy)) / 2);
 
             // [crispy] re-calculate angle used for rendering
-            g_r_state_globals->viewx       = li->v1->r_x;
-            g_r_state_globals->viewy       = li->v1->r_y;
-            li->r_angle = R_PointToAngleCrispy(li->v2->r_x, li->v2->r_y);
+            li->r_angle = R_PointToAngleCrispy2(li->v1->r_x, li->v1->r_y,
+                li->v2->r_x, li->v2->r_y);
         }
 
         // [crispy] smoother fake contrast
@@ -679,12 +680,6 @@ bool P_LoadBlockMap(int lump)
     g_p_local_globals->bmapwidth  = g_p_local_globals->blockmaplump[2];
     g_p_local_globals->bmapheight = g_p_local_globals->blockmaplump[3];
 
-    // Clear out mobj chains
-
-    count      = static_cast<int>(sizeof(*g_p_local_globals->blocklinks)) * g_p_local_globals->bmapwidth * g_p_local_globals->bmapheight;
-    g_p_local_globals->blocklinks = zmalloc<decltype(g_p_local_globals->blocklinks)>(count, PU_LEVEL, 0);
-    std::memset(g_p_local_globals->blocklinks, 0, static_cast<size_t>(count));
-
     // [crispy] (re-)create BLOCKMAP if necessary
     fprintf(stderr, ")\n");
     return true;
@@ -916,6 +911,18 @@ static void PadRejectArray(uint8_t *array, unsigned int len)
     }
 }
 
+// [crispy] nodebuilders write an all-zero REJECT lump if asked to skip it
+static bool RejectIsEmpty(const uint8_t *rejectmatrix, size_t len)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        if (rejectmatrix[i])
+            return false;
+    }
+
+    return true;
+}
+
 static void P_LoadReject(int lumpnum)
 {
     // Calculate the size that the REJECT lump *should* be.
@@ -928,17 +935,43 @@ static void P_LoadReject(int lumpnum)
 
     size_t lumplen = W_LumpLength(lumpnum);
 
+    //!
+    // @category mod
+    //
+    // Build a REJECT table when loading levels whose REJECT lump is
+    // empty, too short or all zeros, instead of padding it.  This
+    // speeds up monster sight checks, but may desync demos recorded
+    // on such levels.  Results are cached in the configuration
+    // directory.
+    //
+
+    bool buildreject = M_ParmExists("-buildreject");
+
     if (lumplen >= minlength)
     {
         g_p_local_globals->rejectmatrix = cache_lump_num<uint8_t *>(lumpnum, PU_LEVEL);
+
+        if (!buildreject || !RejectIsEmpty(g_p_local_globals->rejectmatrix, minlength))
+            return;
+
+        // [crispy] build into a buffer of our own, not the lump cache
+        W_ReleaseLumpNum(lumpnum);
+        g_p_local_globals->rejectmatrix = zmalloc<decltype(g_p_local_globals->rejectmatrix)>(minlength, PU_LEVEL, &g_p_local_globals->rejectmatrix);
     }
     else
     {
         g_p_local_globals->rejectmatrix = zmalloc<decltype(g_p_local_globals->rejectmatrix)>(minlength, PU_LEVEL, &g_p_local_globals->rejectmatrix);
         W_ReadLump(lumpnum, g_p_local_globals->rejectmatrix);
 
-        PadRejectArray(g_p_local_globals->rejectmatrix + lumplen, static_cast<unsigned int>(minlength - lumplen));
+        if (!buildreject)
+        {
+            PadRejectArray(g_p_local_globals->rejectmatrix + lumplen, static_cast<unsigned int>(minlength - lumplen));
+            return;
+        }
     }
+
+    // [crispy] the REJECT lump follows the map geometry lumps
+    P_BuildReject(lumpnum - ML_REJECT, g_p_local_globals->rejectmatrix);
 }
 
 // [crispy] log game skill in plain text
@@ -991,6 +1024,123 @@ int P_GetNumForMap(int episode, int map, bool critical_param)
 // pointer to the current map lump info struct
 lumpinfo_t *maplumpinfo;
 
+//
+// [crispy] Level setup steps.  Loading the lumps uses the zone and the
+// WAD cache, so those run in order on the main thread, as do the steps
+// that allocate from the zone.  The rest only read the loaded geometry
+// and write to fields nobody else touches, so the results are the same
+// whichever worker they end up on.
+//
+static int         setuplump;
+static mapformat_t setupmapformat;
+static bool        setupvalidblockmap;
+
+static void SetupVertexes()
+{
+    P_LoadVertexes(setuplump + ML_VERTEXES);
+}
+
+static void SetupSectors()
+{
+    P_LoadSectors(setuplump + ML_SECTORS);
+}
+
+static void SetupSideDefs()
+{
+    P_LoadSideDefs(setuplump + ML_SIDEDEFS);
+}
+
+static void SetupLineDefs()
+{
+    if (setupmapformat & MFMT_HEXEN)
+        P_LoadLineDefs_Hexen(setuplump + ML_LINEDEFS);
+    else
+        P_LoadLineDefs(setuplump + ML_LINEDEFS);
+}
+
+static void SetupBSP()
+{
+    if (setupmapformat & (MFMT_ZDBSPX | MFMT_ZDBSPZ))
+        P_LoadNodes_ZDBSP(setuplump + ML_NODES, setupmapformat & MFMT_ZDBSPZ);
+    else if (setupmapformat & MFMT_DEEPBSP)
+    {
+        P_LoadSubsectors_DeePBSP(setuplump + ML_SSECTORS);
+        P_LoadNodes_DeePBSP(setuplump + ML_NODES);
+        P_LoadSegs_DeePBSP(setuplump + ML_SEGS);
+    }
+    else
+    {
+        P_LoadSubsectors(setuplump + ML_SSECTORS);
+        P_LoadNodes(setuplump + ML_NODES);
+        P_LoadSegs(setuplump + ML_SEGS);
+    }
+}
+
+// [crispy] (re-)create BLOCKMAP if necessary
+static void SetupBlockMap()
+{
+    if (!setupvalidblockmap)
+    {
+        extern void P_CreateBlockMap();
+        P_CreateBlockMap();
+    }
+}
+
+// [crispy] clear out the things in each block
+static void SetupBlockLinks()
+{
+    P_InitBlockLinks();
+}
+
+static void SetupGroupLines()
+{
+    P_GroupLines();
+}
+
+// [crispy] remove slime trails
+static void SetupSlimeTrails()
+{
+    P_RemoveSlimeTrails();
+}
+
+// [crispy] fix long wall wobble
+static void SetupSegLengths()
+{
+    P_SegLengths(false);
+}
+
+enum
+{
+    st_vertexes,
+    st_sectors,
+    st_sidedefs,
+    st_linedefs,
+    st_bsp,
+    st_blockmap,
+    st_blocklinks,
+    st_grouplines,
+    st_slimetrails,
+    st_seglengths,
+    NUMSETUPTASKS
+};
+
+#define AFTER(task) (1u << (task))
+
+// note: most of this ordering is important
+static workertask_t setuptasks[NUMSETUPTASKS] = {
+    { "vertexes", SetupVertexes, 0, true },
+    { "sectors", SetupSectors, AFTER(st_vertexes), true },
+    { "sidedefs", SetupSideDefs, AFTER(st_sectors), true },
+    { "linedefs", SetupLineDefs, AFTER(st_sidedefs), true },
+    { "bsp", SetupBSP, AFTER(st_linedefs), true },
+    // ZDBSP nodes add vertexes, so everything else waits for the BSP
+    { "blockmap", SetupBlockMap, AFTER(st_bsp), false },
+    { "blocklinks", SetupBlockLinks, AFTER(st_blockmap), true },
+    { "grouplines", SetupGroupLines, AFTER(st_blockmap), true },
+    { "slimetrails", SetupSlimeTrails, AFTER(st_bsp), false },
+    { "seglengths", SetupSegLengths, AFTER(st_slimetrails), false },
+};
+
 //
 // P_SetupLevel
 //
@@ -1052,6 +1202,7 @@ void P_SetupLevel(int episode, int map, int, skill_t skill)
     musinfo.from_savegame = false;
 
     Z_FreeTags(PU_LEVEL, PU_PURGELEVEL - 1);
+    P_ClearThinkerPools(); // [crispy] the slabs went with the level
 
     // UNUSED W_Profile ();
     P_InitThinkers();
@@ -1114,42 +1265,28 @@ void P_SetupLevel(int episode, int map, int, skill_t skill)
 
     // note: most of this ordering is important
     crispy_validblockmap = P_LoadBlockMap(lumpnum + ML_BLOCKMAP); // [crispy] (re-)create BLOCKMAP if necessary
-    P_LoadVertexes(lumpnum + ML_VERTEXES);
-    P_LoadSectors(lumpnum + ML_SECTORS);
-    P_LoadSideDefs(lumpnum + ML_SIDEDEFS);
 
-    if (crispy_mapformat & MFMT_HEXEN)
-        P_LoadLineDefs_Hexen(lumpnum + ML_LINEDEFS);
-    else
-        P_LoadLineDefs(lumpnum + ML_LINEDEFS);
-    // [crispy] (re-)create BLOCKMAP if necessary
-    if (!crispy_validblockmap)
-    {
-        extern void P_CreateBlockMap();
-        P_CreateBlockMap();
-    }
-    if (crispy_mapformat & (MFMT_ZDBSPX | MFMT_ZDBSPZ))
-        P_LoadNodes_ZDBSP(lumpnum + ML_NODES, crispy_mapformat & MFMT_ZDBSPZ);
-    else if (crispy_mapformat & MFMT_DEEPBSP)
-    {
-        P_LoadSubsectors_DeePBSP(lumpnum + ML_SSECTORS);
-        P_LoadNodes_DeePBSP(lumpnum + ML_NODES);
-        P_LoadSegs_DeePBSP(lumpnum + ML_SEGS);
-    }
-    else
+    // [crispy] load the geometry and derive the lookup tables, running
+    // the steps that don't depend on each other on the worker threads
+    setuplump          = lumpnum;
+    setupmapformat     = crispy_mapformat;
+    setupvalidblockmap = crispy_validblockmap;
+    I_RunTasks(setuptasks, NUMSETUPTASKS);
+
+    if (g_doomstat_globals->devparm)
     {
-        P_LoadSubsectors(lumpnum + ML_SSECTORS);
-        P_LoadNodes(lumpnum + ML_NODES);
-        P_LoadSegs(lumpnum + ML_SEGS);
+        fprintf(stderr, "P_SetupLevel:");
+
+        for (i = 0; i < NUMSETUPTASKS; i++)
+        {
+            fprintf(stderr, " %s %.1f ms%s", setuptasks[i].name,
+                setuptasks[i].time / 1000.0, i < NUMSETUPTASKS - 1 ? "," : "\n");
+        }
     }
 
-    P_GroupLines();
     P_LoadReject(lumpnum + ML_REJECT);
+    P_InvalidateSightCache();
 
-    // [crispy] remove slime trails
-    P_RemoveSlimeTrails();
-    // [crispy] fix long wall wobble
-    P_SegLengths(false);
     // [crispy] blinking key or skull in the status bar
     std::memset(g_p_local_globals->st_keyorskull, 0, sizeof(g_p_local_globals->st_keyorskull));
 
@@ -37,7 +37,69 @@ divline_t strace; // from t1 to t2
 fixed_t   t2x;
 fixed_t   t2y;
 
-int sightcounts[2];
+// [crispy] REJECT rejections, full traces, sight cache hits
+int sightcounts[3];
+
+//
+// Sight cache
+// [crispy] A_Look(), A_Chase() and friends often ask about the same
+// pair of things several times within a tic.  The result only depends
+// on the positions and heights of the two things and on the sector
+// heights, so it is remembered until the next tic or until a floor or
+// ceiling moves.
+//
+#define SIGHTCACHESIZE 1024 // must be a power of two
+
+struct sightcache_t
+{
+    const mobj_t *t1, *t2;
+    fixed_t       x1, y1, z1, height1;
+    fixed_t       x2, y2, z2, height2;
+    int           tic;
+    unsigned int  generation;
+    bool          result;
+};
+
+static sightcache_t sightcache[SIGHTCACHESIZE];
+static unsigned int sightgeneration = 1;
+
+void P_InvalidateSightCache()
+{
+    sightgeneration++;
+}
+
+static sightcache_t *SightCacheSlot(const mobj_t *t1, const mobj_t *t2)
+{
+    uintptr_t key = (reinterpret_cast<uintptr_t>(t1) >> 3) * 31 + (reinterpret_cast<uintptr_t>(t2) >> 3);
+
+    // Fibonacci hashing
+    return &sightcache[(static_cast<uint32_t>(key) * 2654435769u) >> 22];
+}
+
+static bool SightCacheMatch(const sightcache_t *slot, const mobj_t *t1, const mobj_t *t2)
+{
+    return slot->tic == gametic && slot->generation == sightgeneration
+           && slot->t1 == t1 && slot->t2 == t2
+           && slot->x1 == t1->x && slot->y1 == t1->y && slot->z1 == t1->z && slot->height1 == t1->height
+           && slot->x2 == t2->x && slot->y2 == t2->y && slot->z2 == t2->z && slot->height2 == t2->height;
+}
+
+static void SightCacheStore(sightcache_t *slot, const mobj_t *t1, const mobj_t *t2, bool result)
+{
+    slot->t1         = t1;
+    slot->t2         = t2;
+    slot->x1         = t1->x;
+    slot->y1         = t1->y;
+    slot->z1         = t1->z;
+    slot->height1    = t1->height;
+    slot->x2         = t2->x;
+    slot->y2         = t2->y;
+    slot->z2         = t2->z;
+    slot->height2    = t2->height;
+    slot->tic        = gametic;
+    slot->generation = sightgeneration;
+    slot->result     = result;
+}
 
 
 // PTR_SightTraverse() for Doom 1.2 sight calculations
@@ -353,6 +415,21 @@ bool
 
     // An unobstructed LOS is possible.
     // Now look from eyes of t1 to any part of t2.
+    // [crispy] asked already this tic?  The 1.2 path traverse can
+    // overflow the intercepts array, so leave that alone.
+    sightcache_t *slot = nullptr;
+
+    if (g_doomstat_globals->gameversion > exe_doom_1_2)
+    {
+        slot = SightCacheSlot(t1, t2);
+
+        if (SightCacheMatch(slot, t1, t2))
+        {
+            sightcounts[2]++;
+            return slot->result;
+        }
+    }
+
     sightcounts[1]++;
 
     validcount++;
@@ -375,5 +452,9 @@ bool
     strace.dy = t2->y - t1->y;
 
     // the head node is the last node output
-    return P_CrossBSPNode(g_r_state_globals->numnodes - 1);
+    bool result = P_CrossBSPNode(g_r_state_globals->numnodes - 1);
+
+    SightCacheStore(slot, t1, t2, result);
+
+    return result;
 }
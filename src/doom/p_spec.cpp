@@ -226,6 +226,52 @@ void P_InitPicAnims()
     }
 }
 
+// [crispy] see P_InitSwitchList()
+extern int *switchlist;
+extern int  numswitches;
+
+//
+// P_MarkTextureAlternates
+// [crispy] Mark the textures that animations and switches may put in
+// place of the ones in present[], so that they can be composited
+// ahead of time.
+//
+void P_MarkTextureAlternates(const char *present, char *alternates)
+{
+    int i;
+
+    for (anim_t *anim = anims; anim < lastanim; anim++)
+    {
+        bool used = false;
+
+        if (!anim->istexture)
+            continue;
+
+        for (i = anim->basepic; i <= anim->picnum; i++)
+            used = used || present[i];
+
+        if (!used)
+            continue;
+
+        for (i = anim->basepic; i <= anim->picnum; i++)
+        {
+            if (!present[i])
+                alternates[i] = 1;
+        }
+    }
+
+    for (i = 0; i < numswitches * 2; i += 2)
+    {
+        int tex1 = switchlist[i];
+        int tex2 = switchlist[i + 1];
+
+        if (present[tex1] && !present[tex2])
+            alternates[tex2] = 1;
+        else if (present[tex2] && !present[tex1])
+            alternates[tex1] = 1;
+    }
+}
+
 
 //
 // UTILITIES
@@ -1471,7 +1517,7 @@ int EV_DoDonut(line_t *line)
             }
 
             //	Spawn rising slime
-            floor = zmalloc<decltype(floor)>(sizeof(*floor), PU_LEVSPEC, 0);
+            floor = thinkermalloc<decltype(floor)>(sizeof(*floor));
             P_AddThinker(&floor->thinker);
             s2->specialdata              = floor;
             floor->thinker.function      = T_MoveFloor;
@@ -1485,7 +1531,7 @@ int EV_DoDonut(line_t *line)
             floor->floordestheight       = s3_floorheight;
 
             //	Spawn lowering donut-hole
-            floor = zmalloc<decltype(floor)>(sizeof(*floor), PU_LEVSPEC, 0);
+            floor = thinkermalloc<decltype(floor)>(sizeof(*floor));
             P_AddThinker(&floor->thinker);
             s1->specialdata              = floor;
             floor->thinker.function      = T_MoveFloor;
@@ -38,6 +38,9 @@ extern int     levelTimeCount;
 // at game start
 void P_InitPicAnims();
 
+// [crispy] textures animations and switches may change present[] to
+void P_MarkTextureAlternates(const char *present, char *alternates);
+
 // at map load
 void P_SpawnSpecials();
 
@@ -18,6 +18,10 @@
 //
 
 
+#include <cstddef>
+
+#include "i_system.hpp"
+#include "memory.hpp"
 #include "z_zone.hpp"
 #include "p_local.hpp"
 #include "s_musinfo.hpp" // [crispy] T_MAPMusic()
@@ -29,12 +33,124 @@ int leveltime;
 
 //
 // THINKERS
-// All thinkers should be allocated by Z_Malloc
+// All thinkers should be allocated by P_AllocThinker
 // so they can be operated on uniformly.
 // The actual structures will vary in size,
 // but the first element must be thinker_t.
 //
 
+//
+// [crispy] Thinker pools.
+// mobjs and special thinkers are created and destroyed all the time,
+// so rather than going through the zone for each of them, they are
+// carved from PU_LEVEL slabs, one pool per object size.  Freed objects
+// go on the pool's free list.  The slabs themselves are released in
+// bulk by Z_FreeTags() in P_SetupLevel(), which then clears the pools.
+//
+
+#define THINKERSPERSLAB 128
+#define MAXTHINKERPOOLS 16
+
+struct thinkerpool_t;
+
+// Every object is preceded by the pool it belongs to, so that
+// P_FreeThinker() only needs the thinker pointer.
+union thinkerchunk_t
+{
+    thinkerpool_t * pool;
+    thinkerchunk_t *next; // while on the free list
+    std::max_align_t align;
+};
+
+struct thinkerpool_t
+{
+    size_t          size; // object size, without the chunk header
+    thinkerchunk_t *freelist;
+};
+
+static thinkerpool_t thinkerpools[MAXTHINKERPOOLS];
+static int           numthinkerpools;
+
+static thinkerpool_t *P_ThinkerPool(size_t size)
+{
+    thinkerpool_t *pool;
+
+    for (pool = thinkerpools; pool < thinkerpools + numthinkerpools; pool++)
+    {
+        if (pool->size == size)
+            return pool;
+    }
+
+    if (numthinkerpools == MAXTHINKERPOOLS)
+        I_Error("P_ThinkerPool: Too many thinker sizes");
+
+    pool           = &thinkerpools[numthinkerpools++];
+    pool->size     = size;
+    pool->freelist = nullptr;
+
+    return pool;
+}
+
+static void P_GrowThinkerPool(thinkerpool_t *pool)
+{
+    // round up so that every chunk header stays aligned
+    size_t stride = sizeof(thinkerchunk_t) + (pool->size + sizeof(thinkerchunk_t) - 1) / sizeof(thinkerchunk_t) * sizeof(thinkerchunk_t);
+    auto * slab   = zmalloc<uint8_t *>(stride * THINKERSPERSLAB, PU_LEVEL, nullptr);
+
+    for (int i = THINKERSPERSLAB - 1; i >= 0; i--)
+    {
+        auto *chunk    = reinterpret_cast<thinkerchunk_t *>(slab + i * stride);
+        chunk->next    = pool->freelist;
+        pool->freelist = chunk;
+    }
+}
+
+//
+// P_AllocThinker
+// Allocates an object of the given size, whose first element
+// must be a thinker_t, from the pool for that size.
+//
+void *P_AllocThinker(size_t size)
+{
+    thinkerpool_t * pool = P_ThinkerPool(size);
+    thinkerchunk_t *chunk;
+
+    if (!pool->freelist)
+        P_GrowThinkerPool(pool);
+
+    chunk          = pool->freelist;
+    pool->freelist = chunk->next;
+    chunk->pool    = pool;
+
+    return chunk + 1;
+}
+
+//
+// P_FreeThinker
+// Returns an object allocated by P_AllocThinker() to its pool.
+//
+void P_FreeThinker(thinker_t *thinker)
+{
+    thinkerchunk_t *chunk = reinterpret_cast<thinkerchunk_t *>(thinker) - 1;
+    thinkerpool_t * pool  = chunk->pool;
+
+    chunk->next    = pool->freelist;
+    pool->freelist = chunk;
+}
+
+//
+// P_ClearThinkerPools
+// Forget all free lists, after the slabs have been released
+// along with the rest of the level.
+//
+void P_ClearThinkerPools()
+{
+    for (int i = 0; i < numthinkerpools; i++)
+    {
+        thinkerpools[i].freelist = nullptr;
+    }
+}
+
 //
 // P_InitThinkers
 //
@@ -87,14 +203,13 @@ void P_RunThinkers()
     currentthinker = g_p_local_globals->thinkercap.next;
     while (currentthinker != &g_p_local_globals->thinkercap)
     {
-        action_hook invalid_hook = valid_hook(false);
-        if (currentthinker->function == invalid_hook)
+        if (thinker_is_removed(currentthinker))
         {
             // time to remove it
             nextthinker                = currentthinker->next;
             currentthinker->next->prev = currentthinker->prev;
             currentthinker->prev->next = currentthinker->next;
-            Z_Free(currentthinker);
+            P_FreeThinker(currentthinker);
         }
         else
         {
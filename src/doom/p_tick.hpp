@@ -25,6 +25,7 @@
 // can call G_PlayerExited.
 // Carries out all thinking of monsters and players.
 void P_Ticker();
+void P_RunThinkers(); // [crispy] for -thinkbench
 
 
 #endif
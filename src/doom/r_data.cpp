@@ -17,21 +17,28 @@
 //	generation of lookups, caching, retrieval by name.
 //
 
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib> // [crispy] calloc()
 
 #include "deh_main.hpp"
 #include "i_swap.hpp"
 #include "i_system.hpp"
+#include "i_thread.hpp" // [crispy] I_RunOnWorkers()
 #include "z_zone.hpp"
 
 
+#include "sha1.hpp"       // [crispy] texture cache
+#include "w_checksum.hpp"
+#include "w_file.hpp"
 #include "w_wad.hpp"
 
 #include "doomdef.hpp"
+#include "m_argv.hpp"
 #include "m_misc.hpp"
 #include "r_local.hpp"
 #include "p_local.hpp"
+#include "p_spec.hpp" // [crispy] P_MarkTextureAlternates()
 
 #include "doomstat.hpp"
 #include "r_sky.hpp"
@@ -148,6 +155,10 @@ unsigned **texturecolumnofs2; // [crispy] original column offsets for single-pat
 uint8_t  **texturecomposite;
 uint8_t  **texturebrightmap; // [crispy] brightmaps
 
+// [crispy] the texture cache file, if the composites are mapped from it
+// rather than built in the zone
+static wad_file_t *texturecache;
+
 //
 // MAPTEXTURE_T CACHING
 // When a texture is first needed,
@@ -223,52 +234,80 @@ void R_DrawColumnInCache(column_t *patch, uint8_t *cache,
 
 
 //
-// R_GenerateComposite
-// Using the texture definition,
-//  the composite texture is created from the patches,
-//  and each column is cached.
+// [crispy] Scratch space for compositing, one per thread doing it.
 //
-// Rewritten by Lee Killough for performance and to fix Medusa bug
+struct compositescratch_t
+{
+    uint8_t *marks;  // killough 4/9/98: transparency marks
+    uint8_t *column; // killough 4/9/98: temporary column
+    size_t   marksize;
+    int      columnsize;
+};
 
-void R_GenerateComposite(int texnum)
+static compositescratch_t mainscratch;
+static compositescratch_t workerscratch[MAXWORKERS];
+static compositescratch_t backgroundscratch;
+
+static void R_GrowCompositeScratch(compositescratch_t *scratch, const texture_t *texture)
 {
-    uint8_t    *block;
-    texture_t * texture;
-    texpatch_t *patch;
-    patch_t *   realpatch;
-    int         x;
-    int         x1;
-    int         x2;
-    int         i;
-    column_t *  patchcol;
-    short *     collump;
-    unsigned *  colofs; // killough 4/9/98: make 32-bit
-    uint8_t    *marks;  // killough 4/9/98: transparency marks
-    uint8_t    *source; // killough 4/9/98: temporary column
+    size_t marksize = static_cast<size_t>(texture->width) * static_cast<size_t>(texture->height);
 
-    texture = textures[texnum];
+    if (scratch->marksize < marksize)
+    {
+        scratch->marks    = static_cast<uint8_t *>(I_Realloc(scratch->marks, marksize));
+        scratch->marksize = marksize;
+    }
 
-    block = zmalloc<decltype(block)>(static_cast<size_t>(texturecompositesize[texnum]),
-        PU_STATIC,
-        &texturecomposite[texnum]);
+    if (scratch->columnsize < texture->height)
+    {
+        scratch->column     = static_cast<uint8_t *>(I_Realloc(scratch->column, static_cast<size_t>(texture->height)));
+        scratch->columnsize = texture->height;
+    }
+}
+
+//
+// R_CompositeTexture
+// [crispy] The work of R_GenerateComposite(), touching nothing but the
+// texture's block, its patches and the scratch space, so that it can
+// run off the main thread.
+//
+static void R_CompositeTexture(int texnum, uint8_t *block, patch_t *const *patches,
+    compositescratch_t *scratch)
+{
+    texture_t *       texture;
+    const texpatch_t *patch;
+    const patch_t *   realpatch;
+    int               x;
+    int               x1;
+    int               x2;
+    int               i;
+    column_t *        patchcol;
+    const short *     collump;
+    const unsigned *  colofs; // killough 4/9/98: make 32-bit
+    uint8_t *         marks;  // killough 4/9/98: transparency marks
+    uint8_t *         source; // killough 4/9/98: temporary column
+
+    texture = textures[texnum];
 
     collump = texturecolumnlump[texnum];
     colofs  = texturecolumnofs[texnum];
 
-    // Composite the columns together.
-    patch = texture->patches;
+    R_GrowCompositeScratch(scratch, texture);
+    marks  = scratch->marks;
+    source = scratch->column;
 
     // killough 4/9/98: marks to identify transparent regions in merged textures
-    marks = static_cast<decltype(marks)>(calloc(static_cast<size_t>(texture->width), static_cast<size_t>(texture->height)));
+    std::memset(marks, 0, static_cast<size_t>(texture->width) * static_cast<size_t>(texture->height));
 
     // [crispy] initialize composite background to black (index 0)
     std::memset(block, 0, static_cast<size_t>(texturecompositesize[texnum]));
 
+    // Composite the columns together.
     for (i = 0, patch = texture->patches;
          i < texture->patchcount;
          i++, patch++)
     {
-        realpatch = cache_lump_num<patch_t *>(patch->patch, PU_CACHE);
+        realpatch = patches[i];
         x1        = patch->originx;
         x2        = x1 + SHORT(realpatch->width);
 
@@ -289,8 +328,8 @@ void R_GenerateComposite(int texnum)
 		continue;
 	    */
 
-            uint8_t *col_ptr = reinterpret_cast<uint8_t *>(realpatch) + LONG(realpatch->columnofs[x - x1]);
-            patchcol = reinterpret_cast<column_t *>(col_ptr);
+            const uint8_t *col_ptr = reinterpret_cast<const uint8_t *>(realpatch) + LONG(realpatch->columnofs[x - x1]);
+            patchcol = reinterpret_cast<column_t *>(const_cast<uint8_t *>(col_ptr));
             R_DrawColumnInCache(patchcol,
                 block + colofs[x],
                 // [crispy] single-patched columns are normally not composited
@@ -304,7 +343,6 @@ void R_GenerateComposite(int texnum)
     // killough 4/9/98: Next, convert multipatched columns into true columns,
     // to fix Medusa bug while still allowing for transparent regions.
 
-    source = static_cast<decltype(source)>(I_Realloc(nullptr, static_cast<size_t>(texture->height))); // temporary column
     for (i = 0; i < texture->width; i++)
     {
         if (collump[i] == -1) // process only multipatched columns
@@ -344,15 +382,278 @@ void R_GenerateComposite(int texnum)
             }
         }
     }
+}
+
+// [crispy] Cache all the patches of a texture, keeping them in the zone
+// until R_ReleaseTexturePatches() so that caching one can't purge
+// another.
+static void R_CacheTexturePatches(int texnum, patch_t **patches)
+{
+    const texture_t *texture = textures[texnum];
+
+    for (int i = 0; i < texture->patchcount; i++)
+    {
+        patches[i] = cache_lump_num<patch_t *>(texture->patches[i].patch, PU_STATIC);
+    }
+}
+
+static void R_ReleaseTexturePatches(int texnum)
+{
+    const texture_t *texture = textures[texnum];
+
+    for (int i = 0; i < texture->patchcount; i++)
+    {
+        W_ReleaseLumpNum(texture->patches[i].patch);
+    }
+}
+
+//
+// R_GenerateComposite
+// Using the texture definition,
+//  the composite texture is created from the patches,
+//  and each column is cached.
+//
+// Rewritten by Lee Killough for performance and to fix Medusa bug
+
+void R_GenerateComposite(int texnum)
+{
+    static patch_t **patches;
+    static int       maxpatches;
+    texture_t *      texture = textures[texnum];
+    uint8_t *        block;
 
-    free(source); // free temporary column
-    free(marks);  // free transparency marks
+    block = zmalloc<decltype(block)>(static_cast<size_t>(texturecompositesize[texnum]),
+        PU_STATIC,
+        &texturecomposite[texnum]);
+
+    if (maxpatches < texture->patchcount)
+    {
+        maxpatches = texture->patchcount;
+        patches    = static_cast<patch_t **>(I_Realloc(patches, static_cast<size_t>(maxpatches) * sizeof(*patches)));
+    }
+
+    R_CacheTexturePatches(texnum, patches);
+    R_CompositeTexture(texnum, block, patches, &mainscratch);
+    R_ReleaseTexturePatches(texnum);
 
     // Now that the texture has been built in column cache,
     //  it is purgable from zone memory.
     Z_ChangeTag(block, PU_CACHE);
 }
 
+//
+// [crispy] Level start batch, composited on the worker threads.
+//
+static int *     batchtextures;
+static int *     batchfirstpatch;
+static int       batchstart, batchend; // the pass being composited
+static patch_t **batchpatches;
+
+// Most zone memory a pass of R_CompositeBatch() keeps from being
+// purged, counting both the composites and the patches.
+#define COMPOSITEBATCHSIZE (4 << 20)
+
+// Zone memory compositing a texture locks: the composite and its patches.
+static size_t R_CompositeCost(int texnum)
+{
+    const texture_t *texture = textures[texnum];
+    size_t           size    = static_cast<size_t>(texturecompositesize[texnum]);
+
+    for (int i = 0; i < texture->patchcount; i++)
+    {
+        size += W_LumpLength(texture->patches[i].patch);
+    }
+
+    return size;
+}
+
+static void R_CompositeBatchWorker(void *, int worker)
+{
+    int numworkers = I_NumWorkers();
+
+    for (int i = batchstart + worker; i < batchend; i += numworkers)
+    {
+        int texnum = batchtextures[i];
+
+        R_CompositeTexture(texnum, texturecomposite[texnum],
+            batchpatches + batchfirstpatch[i], &workerscratch[worker]);
+    }
+}
+
+//
+// R_CompositeBatch
+// [crispy] Composite the textures marked in present[] that aren't
+// already.  The zone and the WAD cache aren't thread safe, so the
+// blocks are allocated and the patches cached here first; while the
+// workers run nothing else touches the zone, so nothing gets purged.
+// To keep that from filling the zone, this is done in passes of up to
+// COMPOSITEBATCHSIZE; a pass is only bigger if it's a single texture.
+//
+static void R_CompositeBatch(const char *present)
+{
+    int numbatchtextures = 0;
+    int maxpatches       = 0;
+    int i;
+
+    batchtextures   = static_cast<int *>(I_Realloc(batchtextures, static_cast<size_t>(numtextures) * sizeof(*batchtextures)));
+    batchfirstpatch = static_cast<int *>(I_Realloc(batchfirstpatch, static_cast<size_t>(numtextures) * sizeof(*batchfirstpatch)));
+
+    for (i = 0; i < numtextures; i++)
+    {
+        if (present[i] && !texturecomposite[i])
+        {
+            batchtextures[numbatchtextures++] = i;
+            maxpatches += textures[i]->patchcount;
+        }
+    }
+
+    if (numbatchtextures == 0)
+        return;
+
+    batchpatches = static_cast<patch_t **>(I_Realloc(batchpatches, static_cast<size_t>(maxpatches) * sizeof(*batchpatches)));
+
+    for (batchstart = 0; batchstart < numbatchtextures; batchstart = batchend)
+    {
+        size_t size       = 0;
+        int    numpatches = 0;
+
+        for (batchend = batchstart; batchend < numbatchtextures; batchend++)
+        {
+            size_t cost = R_CompositeCost(batchtextures[batchend]);
+
+            if (batchend > batchstart && size + cost > COMPOSITEBATCHSIZE)
+                break;
+
+            size += cost;
+        }
+
+        for (i = batchstart; i < batchend; i++)
+        {
+            int texnum = batchtextures[i];
+
+            zmalloc<uint8_t *>(static_cast<size_t>(texturecompositesize[texnum]),
+                PU_STATIC, &texturecomposite[texnum]);
+            batchfirstpatch[i] = numpatches;
+            R_CacheTexturePatches(texnum, batchpatches + numpatches);
+            numpatches += textures[texnum]->patchcount;
+        }
+
+        I_RunOnWorkers(R_CompositeBatchWorker, nullptr);
+
+        for (i = batchstart; i < batchend; i++)
+        {
+            int texnum = batchtextures[i];
+
+            R_ReleaseTexturePatches(texnum);
+            Z_ChangeTag(texturecomposite[texnum], PU_CACHE);
+        }
+    }
+}
+
+//
+// [crispy] Background compositing of the textures a level might switch
+// to, so that R_GetColumn() doesn't have to build them mid-frame.
+// Only patches read straight from a memory mapped WAD stay put without
+// being locked in the zone, so textures with others are left to be
+// built on demand.
+//
+struct compositejob_t
+{
+    int       texnum;
+    int       sequence; // from I_QueueBackgroundJob()
+    uint8_t * block;
+    patch_t **patches;
+};
+
+static compositejob_t **compositejobs;
+static int              firstcompositejob;
+static int              numcompositejobs;
+static int              maxcompositejobs;
+static char *           compositequeued;
+
+static void R_CompositeJob(void *data)
+{
+    compositejob_t *job = static_cast<compositejob_t *>(data);
+
+    R_CompositeTexture(job->texnum, job->block, job->patches, &backgroundscratch);
+}
+
+static void R_QueueComposite(int texnum)
+{
+    const texture_t *texture = textures[texnum];
+    compositejob_t * job;
+    int              i;
+
+    if (texturecomposite[texnum] || compositequeued[texnum])
+        return;
+
+    for (i = 0; i < texture->patchcount; i++)
+    {
+        if (lumpinfo[texture->patches[i].patch]->wad_file->mapped == nullptr)
+            return;
+    }
+
+    job          = static_cast<compositejob_t *>(I_Realloc(nullptr, sizeof(*job)));
+    job->texnum  = texnum;
+    job->patches = static_cast<patch_t **>(I_Realloc(nullptr, static_cast<size_t>(texture->patchcount) * sizeof(*job->patches)));
+    job->block   = zmalloc<uint8_t *>(static_cast<size_t>(texturecompositesize[texnum]), PU_STATIC, &job->block);
+
+    for (i = 0; i < texture->patchcount; i++)
+    {
+        job->patches[i] = cache_lump_num<patch_t *>(texture->patches[i].patch, PU_CACHE);
+    }
+
+    if (numcompositejobs == maxcompositejobs)
+    {
+        maxcompositejobs = maxcompositejobs ? 2 * maxcompositejobs : 64;
+        compositejobs    = static_cast<compositejob_t **>(I_Realloc(compositejobs, static_cast<size_t>(maxcompositejobs) * sizeof(*compositejobs)));
+    }
+
+    compositejobs[numcompositejobs++] = job;
+    compositequeued[texnum]           = 1;
+
+    job->sequence = I_QueueBackgroundJob(R_CompositeJob, job);
+}
+
+//
+// R_FinishComposites
+// [crispy] Hand over the textures finished in the background.
+//
+void R_FinishComposites()
+{
+    int done;
+
+    if (firstcompositejob == numcompositejobs)
+        return;
+
+    done = I_BackgroundJobsDone();
+
+    while (firstcompositejob < numcompositejobs
+           && compositejobs[firstcompositejob]->sequence < done)
+    {
+        compositejob_t *job = compositejobs[firstcompositejob++];
+
+        compositequeued[job->texnum] = 0;
+
+        // Built on demand in the meantime?
+        if (texturecomposite[job->texnum] != nullptr)
+        {
+            Z_Free(job->block);
+        }
+        else
+        {
+            Z_ChangeUser(job->block, reinterpret_cast<void **>(&texturecomposite[job->texnum]));
+            Z_ChangeTag(job->block, PU_CACHE);
+        }
+
+        free(job->patches);
+        free(job);
+    }
+
+    if (firstcompositejob == numcompositejobs)
+        firstcompositejob = numcompositejobs = 0;
+}
+
 
 //
 // R_GenerateLookup
@@ -533,6 +834,44 @@ void R_GenerateLookup(int texnum)
 }
 
 
+//
+// [crispy] While wall columns are deferred to the workers, a composite
+// built later in the same BSP walk could purge one that an earlier
+// column still points into.  Between R_LockComposites() and
+// R_UnlockComposites() every zone composite that R_GetColumn() hands
+// out is kept at PU_STATIC.
+//
+static bool  lockcomposites;
+static char *compositelocked;
+static int * lockedcomposites;
+static int   numlockedcomposites;
+
+void R_LockComposites()
+{
+    if (compositelocked == nullptr)
+    {
+        compositelocked  = static_cast<char *>(I_Realloc(nullptr, static_cast<size_t>(numtextures)));
+        lockedcomposites = static_cast<int *>(I_Realloc(nullptr, static_cast<size_t>(numtextures) * sizeof(*lockedcomposites)));
+        std::memset(compositelocked, 0, static_cast<size_t>(numtextures));
+    }
+
+    lockcomposites = true;
+}
+
+void R_UnlockComposites()
+{
+    for (int i = 0; i < numlockedcomposites; i++)
+    {
+        int texnum = lockedcomposites[i];
+
+        Z_ChangeTag(texturecomposite[texnum], PU_CACHE);
+        compositelocked[texnum] = 0;
+    }
+
+    numlockedcomposites = 0;
+    lockcomposites      = false;
+}
+
 //
 // R_GetColumn
 //
@@ -555,7 +894,20 @@ uint8_t *
         return cache_lump_num<uint8_t *>(lump, PU_CACHE) + ofs2;
 
     if (!texturecomposite[tex])
-        R_GenerateComposite(tex);
+    {
+        // [crispy] maybe it has just been finished in the background
+        R_FinishComposites();
+
+        if (!texturecomposite[tex])
+            R_GenerateComposite(tex);
+    }
+
+    if (lockcomposites && !compositelocked[tex] && texturecache == nullptr)
+    {
+        Z_ChangeTag(texturecomposite[tex], PU_STATIC);
+        compositelocked[tex]                    = 1;
+        lockedcomposites[numlockedcomposites++] = tex;
+    }
 
     return texturecomposite[tex] + ofs;
 }
@@ -602,6 +954,383 @@ static void GenerateTextureHashTable()
 }
 
 
+//
+// [crispy] Texture cache.
+// The column lookups and the composites of all textures, saved to
+// configdir so that later runs with the same WADs can skip reading
+// every patch at startup.  The composites are used straight from the
+// memory mapped file and only built in the zone where it can't be.
+// The file is in native byte order, it's not meant to be shared.
+//
+#define TEXCACHEMAGIC   "TXCH"
+#define TEXCACHEVERSION 1
+
+struct texcacheheader_t
+{
+    char          magic[4];
+    int32_t       version;
+    int32_t       numtextures;
+    sha1_digest_t digest;
+};
+
+//
+// TextureCacheKey
+// The WAD directory checksum doesn't tell PWADs with the same layout
+// apart, so the paths, sizes and modification times of the files go
+// into the key as well.  Of the lumps themselves only PNAMES and
+// TEXTURE1/2 are hashed, which are small and read anyway.
+//
+static void TextureCacheKey(sha1_digest_t digest)
+{
+    sha1_context_t context;
+    sha1_digest_t  wadsum;
+    wad_file_t *   lastwad  = nullptr;
+    const char *   pnames   = DEH_String("PNAMES");
+    const char *   texture1 = DEH_String("TEXTURE1");
+    const char *   texture2 = DEH_String("TEXTURE2");
+
+    W_Checksum(wadsum);
+
+    SHA1_Init(&context);
+    SHA1_UpdateInt32(&context, TEXCACHEVERSION);
+    SHA1_Update(&context, wadsum, sizeof(wadsum));
+
+    for (size_t i = 0; i < numlumps; i++)
+    {
+        if (lumpinfo[i]->wad_file != lastwad)
+        {
+            lastwad = lumpinfo[i]->wad_file;
+            SHA1_UpdateString(&context, lastwad->path);
+            SHA1_UpdateInt32(&context, lastwad->length);
+
+            long long mtime = M_FileModTime(lastwad->path);
+            SHA1_Update(&context, reinterpret_cast<uint8_t *>(&mtime), sizeof(mtime));
+        }
+
+        // The texture layout comes from these, the patches they use are
+        // covered by the directory and the files' times
+        if (!strncasecmp(lumpinfo[i]->name, pnames, 6)
+            || !strncasecmp(lumpinfo[i]->name, texture1, 8)
+            || !strncasecmp(lumpinfo[i]->name, texture2, 8))
+        {
+            SHA1_Update(&context, cache_lump_num<uint8_t *>(static_cast<lumpindex_t>(i), PU_CACHE),
+                W_LumpLength(static_cast<lumpindex_t>(i)));
+        }
+    }
+
+    SHA1_Final(digest, &context);
+}
+
+static char *TextureCacheFile(const sha1_digest_t digest)
+{
+    extern char *configdir;
+    char         hex[sizeof(sha1_digest_t) * 2 + 1];
+
+    for (size_t i = 0; i < sizeof(sha1_digest_t); i++)
+    {
+        M_snprintf(hex + i * 2, 3, "%02x", digest[i]);
+    }
+
+    return M_StringJoin(configdir, "texcache", DIR_SEPARATOR_S, hex, ".dat", nullptr);
+}
+
+// Size of the lookups of all textures, up to the first composite.
+static size_t TextureCacheLookupSize()
+{
+    size_t size = sizeof(texcacheheader_t) + static_cast<size_t>(numtextures) * sizeof(int32_t);
+    size_t columns = 0;
+
+    for (int i = 0; i < numtextures; i++)
+    {
+        columns += static_cast<size_t>(textures[i]->width);
+    }
+
+    size += columns * 2 * sizeof(unsigned);
+    size += columns * sizeof(short);
+
+    return (size + 3) & ~static_cast<size_t>(3);
+}
+
+//
+// R_LoadTextureCache
+// Fill in the column lookups from the cache file, returns false if
+// there is no valid one.
+//
+static bool R_LoadTextureCache(const sha1_digest_t digest, const char *filename)
+{
+    texcacheheader_t header;
+    wad_file_t *     file = W_OpenFile(filename);
+    size_t           offset;
+    size_t           compositeoffset;
+    int              i;
+
+    if (file == nullptr)
+        return false;
+
+    if (W_Read(file, 0, &header, sizeof(header)) != sizeof(header)
+        || std::memcmp(header.magic, TEXCACHEMAGIC, 4) != 0
+        || header.version != TEXCACHEVERSION
+        || header.numtextures != numtextures
+        || std::memcmp(header.digest, digest, sizeof(sha1_digest_t)) != 0)
+    {
+        W_CloseFile(file);
+        return false;
+    }
+
+    offset = sizeof(header);
+
+    if (W_Read(file, static_cast<unsigned>(offset), texturecompositesize,
+            static_cast<size_t>(numtextures) * sizeof(int32_t))
+        != static_cast<size_t>(numtextures) * sizeof(int32_t))
+    {
+        W_CloseFile(file);
+        return false;
+    }
+
+    offset += static_cast<size_t>(numtextures) * sizeof(int32_t);
+
+    // The file has to be exactly as long as the composites need.
+    compositeoffset = TextureCacheLookupSize();
+
+    {
+        size_t length = compositeoffset;
+
+        for (i = 0; i < numtextures; i++)
+        {
+            if (texturecompositesize[i] < 0)
+                length = SIZE_MAX;
+            else if (length != SIZE_MAX)
+                length += static_cast<size_t>(texturecompositesize[i]);
+        }
+
+        if (length != file->length)
+        {
+            W_CloseFile(file);
+            return false;
+        }
+    }
+
+    for (i = 0; i < numtextures; i++)
+    {
+        size_t len = static_cast<size_t>(textures[i]->width) * sizeof(unsigned);
+
+        if (W_Read(file, static_cast<unsigned>(offset), texturecolumnofs[i], len) != len
+            || W_Read(file, static_cast<unsigned>(offset + len), texturecolumnofs2[i], len) != len)
+        {
+            W_CloseFile(file);
+            return false;
+        }
+
+        offset += 2 * len;
+    }
+
+    for (i = 0; i < numtextures; i++)
+    {
+        size_t len = static_cast<size_t>(textures[i]->width) * sizeof(short);
+
+        if (W_Read(file, static_cast<unsigned>(offset), texturecolumnlump[i], len) != len)
+        {
+            W_CloseFile(file);
+            return false;
+        }
+
+        offset += len;
+    }
+
+    // Without a mapping, the composites are built as usual.
+    offset = compositeoffset;
+
+    for (i = 0; i < numtextures; i++)
+    {
+        texturecomposite[i] = file->mapped ? file->mapped + offset : nullptr;
+        offset += static_cast<size_t>(texturecompositesize[i]);
+    }
+
+    if (file->mapped)
+    {
+        W_Advise(file, static_cast<unsigned>(compositeoffset),
+            file->length - compositeoffset, WAD_ADVICE_RANDOM);
+        texturecache = file;
+    }
+    else
+    {
+        W_CloseFile(file);
+    }
+
+    return true;
+}
+
+//
+// R_WriteTextureCache
+// Composite all textures, a batch at a time on the workers, and write
+// them out after the lookups.  Another running game may have the old
+// file mapped, so it is replaced rather than overwritten.
+//
+static void R_WriteTextureCache(const sha1_digest_t digest, const char *filename)
+{
+    texcacheheader_t header;
+    char *           dir     = M_DirName(filename);
+    char *           tmpname = M_StringJoin(filename, ".tmp", nullptr);
+    char *           batch;
+    FILE *           file;
+    bool             ok;
+    int              i;
+    int              first;
+
+    M_MakeDirectory(dir);
+    free(dir);
+
+    file = fopen(tmpname, "wb");
+
+    if (file == nullptr)
+    {
+        free(tmpname);
+        return;
+    }
+
+    std::memcpy(header.magic, TEXCACHEMAGIC, 4);
+    header.version     = TEXCACHEVERSION;
+    header.numtextures = numtextures;
+    std::memcpy(header.digest, digest, sizeof(sha1_digest_t));
+
+    ok = fwrite(&header, sizeof(header), 1, file) == 1
+         && fwrite(texturecompositesize, sizeof(int32_t), static_cast<size_t>(numtextures), file) == static_cast<size_t>(numtextures);
+
+    for (i = 0; ok && i < numtextures; i++)
+    {
+        size_t width = static_cast<size_t>(textures[i]->width);
+
+        ok = fwrite(texturecolumnofs[i], sizeof(unsigned), width, file) == width
+             && fwrite(texturecolumnofs2[i], sizeof(unsigned), width, file) == width;
+    }
+
+    for (i = 0; ok && i < numtextures; i++)
+    {
+        size_t width = static_cast<size_t>(textures[i]->width);
+
+        ok = fwrite(texturecolumnlump[i], sizeof(short), width, file) == width;
+    }
+
+    while (ok && ftell(file) % 4)
+    {
+        ok = fputc(0, file) != EOF;
+    }
+
+    batch = zmalloc<char *>(static_cast<size_t>(numtextures), PU_STATIC, nullptr);
+
+    for (first = 0; ok && first < numtextures;)
+    {
+        size_t size = 0;
+
+        std::memset(batch, 0, static_cast<size_t>(numtextures));
+
+        // [crispy] the same limit as a pass of R_CompositeBatch(), so
+        // that the whole batch is composited in one
+        for (i = first; i < numtextures; i++)
+        {
+            size_t cost = R_CompositeCost(i);
+
+            if (i > first && size + cost > COMPOSITEBATCHSIZE)
+                break;
+
+            batch[i] = 1;
+            size += cost;
+        }
+
+        R_CompositeBatch(batch);
+
+        // The batch is still in the zone, nothing has been allocated
+        // since.
+        for (; ok && first < i; first++)
+        {
+            size_t len = static_cast<size_t>(texturecompositesize[first]);
+
+            ok = fwrite(texturecomposite[first], 1, len, file) == len;
+        }
+    }
+
+    Z_Free(batch);
+
+    if (fclose(file) != 0 || !ok)
+    {
+        remove(tmpname);
+    }
+    else
+    {
+        remove(filename);
+        rename(tmpname, filename);
+    }
+
+    free(tmpname);
+}
+
+// [crispy] texture cache to write once startup is done
+static sha1_digest_t texturecachedigest;
+static char *        texturecachefile;
+
+//
+// R_InitTextureLookups
+// Set up the column lookups of all textures, from the texture cache
+// if there is one for the loaded WADs.
+//
+static void R_InitTextureLookups()
+{
+    sha1_digest_t digest;
+    char *        filename;
+    int           i;
+
+    //!
+    // @category obscure
+    //
+    // Don't read or write the texture cache in the configuration
+    // directory.  All textures are set up from the WADs at startup.
+    //
+
+    if (M_ParmExists("-notexturecache"))
+    {
+        for (i = 0; i < numtextures; i++)
+            R_GenerateLookup(i);
+
+        return;
+    }
+
+    TextureCacheKey(digest);
+    filename = TextureCacheFile(digest);
+
+    if (R_LoadTextureCache(digest, filename))
+    {
+        // [crispy] loaded from the cache
+        printf(":");
+    }
+    else
+    {
+        for (i = 0; i < numtextures; i++)
+            R_GenerateLookup(i);
+
+        // [crispy] R_Init() runs in the startup task graph, where the
+        // workers aren't free to composite; write it afterwards.
+        std::memcpy(texturecachedigest, digest, sizeof(sha1_digest_t));
+        texturecachefile = filename;
+        return;
+    }
+
+    free(filename);
+}
+
+//
+// R_SaveTextureCache
+// Write the texture cache if R_InitData() didn't find one.
+//
+void R_SaveTextureCache()
+{
+    if (texturecachefile == nullptr)
+        return;
+
+    R_WriteTextureCache(texturecachedigest, texturecachefile);
+    free(texturecachefile);
+    texturecachefile = nullptr;
+}
+
 //
 // R_InitTextures
 // Initializes the texture list
@@ -909,8 +1638,7 @@ void R_InitTextures()
 
     // Precalculate whatever possible.
 
-    for (i = 0; i < numtextures; i++)
-        R_GenerateLookup(i);
+    R_InitTextureLookups();
 
     // Create translation table for global animation.
     g_r_state_globals->texturetranslation = zmalloc<decltype(g_r_state_globals->texturetranslation)>((static_cast<unsigned long>(numtextures + 1)) * sizeof(*g_r_state_globals->texturetranslation), PU_STATIC, 0);
@@ -1224,6 +1952,10 @@ void R_InitData()
     // mistaken as patches and by R_InitBrightmaps() to set brightmaps for flats.
     // R_InitBrightmaps() comes next, because it sets R_BrightmapForTexName()
     // to initialize brightmaps depending on gameversion in R_InitTextures().
+    // [crispy] the texture directory and all patch headers are
+    // read front to back, let the kernel read ahead accordingly
+    W_AdviseAll(WAD_ADVICE_SEQUENTIAL);
+
     R_InitFlats();
     R_InitBrightmaps();
     R_InitTextures();
@@ -1236,6 +1968,9 @@ void R_InitData()
 #ifndef CRISPY_TRUECOLOR
     R_InitTranMap(); // [crispy] prints a mark itself
 #endif
+
+    // [crispy] from here on lumps are picked here and there
+    W_AdviseAll(WAD_ADVICE_RANDOM);
 }
 
 
@@ -1364,6 +2099,7 @@ void R_PrecacheLevel()
         {
             lump = g_r_state_globals->firstflat + i;
             flatmemory += static_cast<int>(lumpinfo[lump]->size);
+            W_PrefetchLumpNum(lump);
             W_CacheLumpNum(lump, PU_CACHE);
         }
     }
@@ -1389,15 +2125,52 @@ void R_PrecacheLevel()
     //  name.
     texturepresent[skytexture] = 1;
 
+    // [crispy] page in the patches before compositing from them
+    for (i = 0; i < numtextures; i++)
+    {
+        if (texturepresent[i] && !texturecomposite[i])
+        {
+            texture = textures[i];
+
+            for (j = 0; j < texture->patchcount; j++)
+            {
+                W_PrefetchLumpNum(texture->patches[j].patch);
+            }
+        }
+    }
+
+    // [crispy] precache composite textures
+    R_CompositeBatch(texturepresent);
+
+    // [crispy] and queue up the ones animations and switches may need
+    if (I_NumWorkers() > 1)
+    {
+        char *alternates = zmalloc<char *>(static_cast<size_t>(numtextures), PU_STATIC, nullptr);
+        std::memset(alternates, 0, static_cast<size_t>(numtextures));
+
+        P_MarkTextureAlternates(texturepresent, alternates);
+
+        if (compositequeued == nullptr)
+        {
+            compositequeued = zmalloc<char *>(static_cast<size_t>(numtextures), PU_STATIC, nullptr);
+            std::memset(compositequeued, 0, static_cast<size_t>(numtextures));
+        }
+
+        for (i = 0; i < numtextures; i++)
+        {
+            if (alternates[i])
+                R_QueueComposite(i);
+        }
+
+        Z_Free(alternates);
+    }
+
     texturememory = 0;
     for (i = 0; i < numtextures; i++)
     {
         if (!texturepresent[i])
             continue;
 
-        // [crispy] precache composite textures
-        R_GenerateComposite(i);
-
         texture = textures[i];
 
         for (j = 0; j < texture->patchcount; j++)
@@ -1437,6 +2210,7 @@ void R_PrecacheLevel()
             {
                 lump = g_r_state_globals->firstspritelump + sf->lump[k];
                 spritememory += static_cast<int>(lumpinfo[lump]->size);
+                W_PrefetchLumpNum(lump);
                 W_CacheLumpNum(lump, PU_CACHE);
             }
         }
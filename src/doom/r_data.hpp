@@ -36,7 +36,11 @@ uint8_t *R_GetColumn(int tex,
 
 // I/O, setting up the stuff.
 void R_InitData();
+void R_SaveTextureCache(); // [crispy] write the texture cache once startup is done
 void R_PrecacheLevel();
+void R_FinishComposites(); // [crispy] adopt textures composited in the background
+void R_LockComposites();   // [crispy] keep R_GetColumn() composites from being purged
+void R_UnlockComposites(); // [crispy] ... until now
 
 
 // Retrieval.
@@ -117,47 +117,47 @@ r_draw_t *const g_r_draw_globals = &r_draw_s;
 // [crispy] replace R_DrawColumn() with Lee Killough's implementation
 // found in MBF to fix Tutti-Frutti, taken from mbfsrc/R_DRAW.C:99-1979
 
-void R_DrawColumn()
+void R_DrawColumn(r_draw_t *draw)
 {
     int      count;
     pixel_t *dest;
     fixed_t  frac;
     fixed_t  fracstep;
-    int      heightmask = g_r_draw_globals->dc_texheight - 1;
+    int      heightmask = draw->dc_texheight - 1;
 
-    count = g_r_draw_globals->dc_yh - g_r_draw_globals->dc_yl;
+    count = draw->dc_yh - draw->dc_yl;
 
     // Zero length, column does not exceed a pixel.
     if (count < 0)
         return;
 
     // todo waage - dc_yl is overflowing after being cast from uint_max to int, but this seems to only happen once
-    if (g_r_draw_globals->dc_yl < 0)
+    if (draw->dc_yl < 0)
         return;
 
 #ifdef RANGECHECK
-    if (g_r_draw_globals->dc_x >= SCREENWIDTH
-        || g_r_draw_globals->dc_yl < 0
-        || g_r_draw_globals->dc_yh >= SCREENHEIGHT)
-        I_Error("R_DrawColumn: %i to %i at %i", g_r_draw_globals->dc_yl, g_r_draw_globals->dc_yh, g_r_draw_globals->dc_x);
+    if (draw->dc_x >= SCREENWIDTH
+        || draw->dc_yl < 0
+        || draw->dc_yh >= SCREENHEIGHT)
+        I_Error("R_DrawColumn: %i to %i at %i", draw->dc_yl, draw->dc_yh, draw->dc_x);
 #endif
 
     // Framebuffer destination address.
     // Use ylookup LUT to avoid multiply with ScreenWidth.
     // Use columnofs LUT for subwindows?
-    dest = ylookup[g_r_draw_globals->dc_yl] + columnofs[g_r_state_globals->flipviewwidth[g_r_draw_globals->dc_x]];
+    dest = ylookup[draw->dc_yl] + columnofs[g_r_state_globals->flipviewwidth[draw->dc_x]];
 
     // Determine scaling,
     //  which is the only mapping to be done.
-    fracstep = g_r_draw_globals->dc_iscale;
-    frac     = g_r_draw_globals->dc_texturemid + (g_r_draw_globals->dc_yl - centery) * fracstep;
+    fracstep = draw->dc_iscale;
+    frac     = draw->dc_texturemid + (draw->dc_yl - centery) * fracstep;
 
     // Inner loop that does the actual texture mapping,
     //  e.g. a DDA-lile scaling.
     // This is as fast as it gets.
 
     // heightmask is the Tutti-Frutti fix -- killough
-    if (g_r_draw_globals->dc_texheight & heightmask) // not a power of 2 -- killough
+    if (draw->dc_texheight & heightmask) // not a power of 2 -- killough
     {
         heightmask++;
         heightmask <<= FRACBITS;
@@ -172,8 +172,8 @@ void R_DrawColumn()
         do
         {
             // [crispy] brightmaps
-            const uint8_t source = g_r_draw_globals->dc_source[frac >> FRACBITS];
-            *dest             = g_r_draw_globals->dc_colormap[g_r_draw_globals->dc_brightmap[source]][source];
+            const uint8_t source = draw->dc_source[frac >> FRACBITS];
+            *dest             = draw->dc_colormap[draw->dc_brightmap[source]][source];
 
             dest += SCREENWIDTH;
             if ((frac += fracstep) >= heightmask)
@@ -187,8 +187,8 @@ void R_DrawColumn()
             // Re-map color indices from wall texture column
             //  using a lighting/special effects LUT.
             // [crispy] brightmaps
-            const uint8_t source = g_r_draw_globals->dc_source[(frac >> FRACBITS) & heightmask];
-            *dest             = g_r_draw_globals->dc_colormap[g_r_draw_globals->dc_brightmap[source]][source];
+            const uint8_t source = draw->dc_source[(frac >> FRACBITS) & heightmask];
+            *dest             = draw->dc_colormap[draw->dc_brightmap[source]][source];
 
             dest += SCREENWIDTH;
             frac += fracstep;
@@ -257,7 +257,7 @@ void R_DrawColumn ()
 #endif
 
 
-void R_DrawColumnLow()
+void R_DrawColumnLow(r_draw_t *draw)
 {
     int      count;
     pixel_t *dest;
@@ -265,35 +265,35 @@ void R_DrawColumnLow()
     fixed_t  frac;
     fixed_t  fracstep;
     int      x;
-    int      heightmask = g_r_draw_globals->dc_texheight - 1;
+    int      heightmask = draw->dc_texheight - 1;
 
-    count = g_r_draw_globals->dc_yh - g_r_draw_globals->dc_yl;
+    count = draw->dc_yh - draw->dc_yl;
 
     // Zero length.
     if (count < 0)
         return;
 
 #ifdef RANGECHECK
-    if (g_r_draw_globals->dc_x >= SCREENWIDTH
-        || g_r_draw_globals->dc_yl < 0
-        || g_r_draw_globals->dc_yh >= SCREENHEIGHT)
+    if (draw->dc_x >= SCREENWIDTH
+        || draw->dc_yl < 0
+        || draw->dc_yh >= SCREENHEIGHT)
     {
 
-        I_Error("R_DrawColumn: %i to %i at %i", g_r_draw_globals->dc_yl, g_r_draw_globals->dc_yh, g_r_draw_globals->dc_x);
+        I_Error("R_DrawColumn: %i to %i at %i", draw->dc_yl, draw->dc_yh, draw->dc_x);
     }
     //	dccount++;
 #endif
     // Blocky mode, need to multiply by 2.
-    x = g_r_draw_globals->dc_x << 1;
+    x = draw->dc_x << 1;
 
-    dest  = ylookup[g_r_draw_globals->dc_yl] + columnofs[g_r_state_globals->flipviewwidth[x]];
-    dest2 = ylookup[g_r_draw_globals->dc_yl] + columnofs[g_r_state_globals->flipviewwidth[x + 1]];
+    dest  = ylookup[draw->dc_yl] + columnofs[g_r_state_globals->flipviewwidth[x]];
+    dest2 = ylookup[draw->dc_yl] + columnofs[g_r_state_globals->flipviewwidth[x + 1]];
 
-    fracstep = g_r_draw_globals->dc_iscale;
-    frac     = g_r_draw_globals->dc_texturemid + (g_r_draw_globals->dc_yl - centery) * fracstep;
+    fracstep = draw->dc_iscale;
+    frac     = draw->dc_texturemid + (draw->dc_yl - centery) * fracstep;
 
     // heightmask is the Tutti-Frutti fix -- killough
-    if (g_r_draw_globals->dc_texheight & heightmask) // not a power of 2 -- killough
+    if (draw->dc_texheight & heightmask) // not a power of 2 -- killough
     {
         heightmask++;
         heightmask <<= FRACBITS;
@@ -308,8 +308,8 @@ void R_DrawColumnLow()
         do
         {
             // [crispy] brightmaps
-            const uint8_t source = g_r_draw_globals->dc_source[frac >> FRACBITS];
-            *dest2 = *dest = g_r_draw_globals->dc_colormap[g_r_draw_globals->dc_brightmap[source]][source];
+            const uint8_t source = draw->dc_source[frac >> FRACBITS];
+            *dest2 = *dest = draw->dc_colormap[draw->dc_brightmap[source]][source];
 
             dest += SCREENWIDTH;
             dest2 += SCREENWIDTH;
@@ -324,8 +324,8 @@ void R_DrawColumnLow()
         {
             // Hack. Does not work corretly.
             // [crispy] brightmaps
-            const uint8_t source = g_r_draw_globals->dc_source[(frac >> FRACBITS) & heightmask];
-            *dest2 = *dest = g_r_draw_globals->dc_colormap[g_r_draw_globals->dc_brightmap[source]][source];
+            const uint8_t source = draw->dc_source[(frac >> FRACBITS) & heightmask];
+            *dest2 = *dest = draw->dc_colormap[draw->dc_brightmap[source]][source];
             dest += SCREENWIDTH;
             dest2 += SCREENWIDTH;
 
@@ -379,7 +379,7 @@ void R_SetFuzzPosDraw()
 //  could create the SHADOW effect,
 //  i.e. spectres and invisible players.
 //
-void R_DrawFuzzColumn()
+void R_DrawFuzzColumn(r_draw_t *draw)
 {
     int      count;
     pixel_t *dest;
@@ -388,36 +388,36 @@ void R_DrawFuzzColumn()
     bool  cutoff = false;
 
     // Adjust borders. Low...
-    if (!g_r_draw_globals->dc_yl)
-        g_r_draw_globals->dc_yl = 1;
+    if (!draw->dc_yl)
+        draw->dc_yl = 1;
 
     // .. and high.
-    if (g_r_draw_globals->dc_yh == g_r_state_globals->viewheight - 1)
+    if (draw->dc_yh == g_r_state_globals->viewheight - 1)
     {
-        g_r_draw_globals->dc_yh  = g_r_state_globals->viewheight - 2;
+        draw->dc_yh  = g_r_state_globals->viewheight - 2;
         cutoff = true;
     }
 
-    count = g_r_draw_globals->dc_yh - g_r_draw_globals->dc_yl;
+    count = draw->dc_yh - draw->dc_yl;
 
     // Zero length.
     if (count < 0)
         return;
 
 #ifdef RANGECHECK
-    if (g_r_draw_globals->dc_x >= SCREENWIDTH
-        || g_r_draw_globals->dc_yl < 0 || g_r_draw_globals->dc_yh >= SCREENHEIGHT)
+    if (draw->dc_x >= SCREENWIDTH
+        || draw->dc_yl < 0 || draw->dc_yh >= SCREENHEIGHT)
     {
         I_Error("R_DrawFuzzColumn: %i to %i at %i",
-            g_r_draw_globals->dc_yl, g_r_draw_globals->dc_yh, g_r_draw_globals->dc_x);
+            draw->dc_yl, draw->dc_yh, draw->dc_x);
     }
 #endif
 
-    dest = ylookup[g_r_draw_globals->dc_yl] + columnofs[g_r_state_globals->flipviewwidth[g_r_draw_globals->dc_x]];
+    dest = ylookup[draw->dc_yl] + columnofs[g_r_state_globals->flipviewwidth[draw->dc_x]];
 
     // Looks familiar.
-    fracstep = g_r_draw_globals->dc_iscale;
-    frac     = g_r_draw_globals->dc_texturemid + (g_r_draw_globals->dc_yl - centery) * fracstep;
+    fracstep = draw->dc_iscale;
+    frac     = draw->dc_texturemid + (draw->dc_yl - centery) * fracstep;
 
     // Looks like an attempt at dithering,
     //  using the colormap #6 (of 0-31, a bit
@@ -457,7 +457,7 @@ void R_DrawFuzzColumn()
 
 // low detail mode version
 
-void R_DrawFuzzColumnLow()
+void R_DrawFuzzColumnLow(r_draw_t *draw)
 {
     int      count;
     pixel_t *dest;
@@ -468,17 +468,17 @@ void R_DrawFuzzColumnLow()
     bool  cutoff = false;
 
     // Adjust borders. Low...
-    if (!g_r_draw_globals->dc_yl)
-        g_r_draw_globals->dc_yl = 1;
+    if (!draw->dc_yl)
+        draw->dc_yl = 1;
 
     // .. and high.
-    if (g_r_draw_globals->dc_yh == g_r_state_globals->viewheight - 1)
+    if (draw->dc_yh == g_r_state_globals->viewheight - 1)
     {
-        g_r_draw_globals->dc_yh  = g_r_state_globals->viewheight - 2;
+        draw->dc_yh  = g_r_state_globals->viewheight - 2;
         cutoff = true;
     }
 
-    count = g_r_draw_globals->dc_yh - g_r_draw_globals->dc_yl;
+    count = draw->dc_yh - draw->dc_yl;
 
     // Zero length.
     if (count < 0)
@@ -486,23 +486,23 @@ void R_DrawFuzzColumnLow()
 
     // low detail mode, need to multiply by 2
 
-    x = g_r_draw_globals->dc_x << 1;
+    x = draw->dc_x << 1;
 
 #ifdef RANGECHECK
     if (x >= SCREENWIDTH
-        || g_r_draw_globals->dc_yl < 0 || g_r_draw_globals->dc_yh >= SCREENHEIGHT)
+        || draw->dc_yl < 0 || draw->dc_yh >= SCREENHEIGHT)
     {
         I_Error("R_DrawFuzzColumn: %i to %i at %i",
-            g_r_draw_globals->dc_yl, g_r_draw_globals->dc_yh, g_r_draw_globals->dc_x);
+            draw->dc_yl, draw->dc_yh, draw->dc_x);
     }
 #endif
 
-    dest  = ylookup[g_r_draw_globals->dc_yl] + columnofs[g_r_state_globals->flipviewwidth[x]];
-    dest2 = ylookup[g_r_draw_globals->dc_yl] + columnofs[g_r_state_globals->flipviewwidth[x + 1]];
+    dest  = ylookup[draw->dc_yl] + columnofs[g_r_state_globals->flipviewwidth[x]];
+    dest2 = ylookup[draw->dc_yl] + columnofs[g_r_state_globals->flipviewwidth[x + 1]];
 
     // Looks familiar.
-    fracstep = g_r_draw_globals->dc_iscale;
-    frac     = g_r_draw_globals->dc_texturemid + (g_r_draw_globals->dc_yl - centery) * fracstep;
+    fracstep = draw->dc_iscale;
+    frac     = draw->dc_texturemid + (draw->dc_yl - centery) * fracstep;
 
     // Looks like an attempt at dithering,
     //  using the colormap #6 (of 0-31, a bit
@@ -545,34 +545,34 @@ void R_DrawFuzzColumnLow()
     }
 }
 
-void R_DrawTranslatedColumn()
+void R_DrawTranslatedColumn(r_draw_t *draw)
 {
     int      count;
     pixel_t *dest;
     fixed_t  frac;
     fixed_t  fracstep;
 
-    count = g_r_draw_globals->dc_yh - g_r_draw_globals->dc_yl;
+    count = draw->dc_yh - draw->dc_yl;
     if (count < 0)
         return;
 
 #ifdef RANGECHECK
-    if (g_r_draw_globals->dc_x >= SCREENWIDTH
-        || g_r_draw_globals->dc_yl < 0
-        || g_r_draw_globals->dc_yh >= SCREENHEIGHT)
+    if (draw->dc_x >= SCREENWIDTH
+        || draw->dc_yl < 0
+        || draw->dc_yh >= SCREENHEIGHT)
     {
         I_Error("R_DrawColumn: %i to %i at %i",
-            g_r_draw_globals->dc_yl, g_r_draw_globals->dc_yh, g_r_draw_globals->dc_x);
+            draw->dc_yl, draw->dc_yh, draw->dc_x);
     }
 
 #endif
 
 
-    dest = ylookup[g_r_draw_globals->dc_yl] + columnofs[g_r_state_globals->flipviewwidth[g_r_draw_globals->dc_x]];
+    dest = ylookup[draw->dc_yl] + columnofs[g_r_state_globals->flipviewwidth[draw->dc_x]];
 
     // Looks familiar.
-    fracstep = g_r_draw_globals->dc_iscale;
-    frac     = g_r_draw_globals->dc_texturemid + (g_r_draw_globals->dc_yl - centery) * fracstep;
+    fracstep = draw->dc_iscale;
+    frac     = draw->dc_texturemid + (draw->dc_yl - centery) * fracstep;
 
     // Here we do an additional index re-mapping.
     do
@@ -582,14 +582,14 @@ void R_DrawTranslatedColumn()
         //  used with PLAY sprites.
         // Thus the "green" ramp of the player 0 sprite
         //  is mapped to gray, red, black/indigo.
-        *dest = g_r_draw_globals->dc_colormap[0][g_r_draw_globals->dc_translation[g_r_draw_globals->dc_source[frac >> FRACBITS]]];
+        *dest = draw->dc_colormap[0][draw->dc_translation[draw->dc_source[frac >> FRACBITS]]];
         dest += SCREENWIDTH;
 
         frac += fracstep;
     } while (count--);
 }
 
-void R_DrawTranslatedColumnLow()
+void R_DrawTranslatedColumnLow(r_draw_t *draw)
 {
     int      count;
     pixel_t *dest;
@@ -598,31 +598,31 @@ void R_DrawTranslatedColumnLow()
     fixed_t  fracstep;
     int      x;
 
-    count = g_r_draw_globals->dc_yh - g_r_draw_globals->dc_yl;
+    count = draw->dc_yh - draw->dc_yl;
     if (count < 0)
         return;
 
     // low detail, need to scale by 2
-    x = g_r_draw_globals->dc_x << 1;
+    x = draw->dc_x << 1;
 
 #ifdef RANGECHECK
     if (x >= SCREENWIDTH
-        || g_r_draw_globals->dc_yl < 0
-        || g_r_draw_globals->dc_yh >= SCREENHEIGHT)
+        || draw->dc_yl < 0
+        || draw->dc_yh >= SCREENHEIGHT)
     {
         I_Error("R_DrawColumn: %i to %i at %i",
-            g_r_draw_globals->dc_yl, g_r_draw_globals->dc_yh, x);
+            draw->dc_yl, draw->dc_yh, x);
     }
 
 #endif
 
 
-    dest  = ylookup[g_r_draw_globals->dc_yl] + columnofs[g_r_state_globals->flipviewwidth[x]];
-    dest2 = ylookup[g_r_draw_globals->dc_yl] + columnofs[g_r_state_globals->flipviewwidth[x + 1]];
+    dest  = ylookup[draw->dc_yl] + columnofs[g_r_state_globals->flipviewwidth[x]];
+    dest2 = ylookup[draw->dc_yl] + columnofs[g_r_state_globals->flipviewwidth[x + 1]];
 
     // Looks familiar.
-    fracstep = g_r_draw_globals->dc_iscale;
-    frac     = g_r_draw_globals->dc_texturemid + (g_r_draw_globals->dc_yl - centery) * fracstep;
+    fracstep = draw->dc_iscale;
+    frac     = draw->dc_texturemid + (draw->dc_yl - centery) * fracstep;
 
     // Here we do an additional index re-mapping.
     do
@@ -632,8 +632,8 @@ void R_DrawTranslatedColumnLow()
         //  used with PLAY sprites.
         // Thus the "green" ramp of the player 0 sprite
         //  is mapped to gray, red, black/indigo.
-        *dest  = g_r_draw_globals->dc_colormap[0][g_r_draw_globals->dc_translation[g_r_draw_globals->dc_source[frac >> FRACBITS]]];
-        *dest2 = g_r_draw_globals->dc_colormap[0][g_r_draw_globals->dc_translation[g_r_draw_globals->dc_source[frac >> FRACBITS]]];
+        *dest  = draw->dc_colormap[0][draw->dc_translation[draw->dc_source[frac >> FRACBITS]]];
+        *dest2 = draw->dc_colormap[0][draw->dc_translation[draw->dc_source[frac >> FRACBITS]]];
         dest += SCREENWIDTH;
         dest2 += SCREENWIDTH;
 
@@ -641,37 +641,37 @@ void R_DrawTranslatedColumnLow()
     } while (count--);
 }
 
-void R_DrawTLColumn()
+void R_DrawTLColumn(r_draw_t *draw)
 {
     int      count;
     pixel_t *dest;
     fixed_t  frac;
     fixed_t  fracstep;
 
-    count = g_r_draw_globals->dc_yh - g_r_draw_globals->dc_yl;
+    count = draw->dc_yh - draw->dc_yl;
     if (count < 0)
         return;
 
 #ifdef RANGECHECK
-    if (g_r_draw_globals->dc_x >= SCREENWIDTH
-        || g_r_draw_globals->dc_yl < 0
-        || g_r_draw_globals->dc_yh >= SCREENHEIGHT)
+    if (draw->dc_x >= SCREENWIDTH
+        || draw->dc_yl < 0
+        || draw->dc_yh >= SCREENHEIGHT)
     {
         I_Error("R_DrawColumn: %i to %i at %i",
-            g_r_draw_globals->dc_yl, g_r_draw_globals->dc_yh, g_r_draw_globals->dc_x);
+            draw->dc_yl, draw->dc_yh, draw->dc_x);
     }
 #endif
 
-    dest = ylookup[g_r_draw_globals->dc_yl] + columnofs[g_r_state_globals->flipviewwidth[g_r_draw_globals->dc_x]];
+    dest = ylookup[draw->dc_yl] + columnofs[g_r_state_globals->flipviewwidth[draw->dc_x]];
 
-    fracstep = g_r_draw_globals->dc_iscale;
-    frac     = g_r_draw_globals->dc_texturemid + (g_r_draw_globals->dc_yl - centery) * fracstep;
+    fracstep = draw->dc_iscale;
+    frac     = draw->dc_texturemid + (draw->dc_yl - centery) * fracstep;
 
     do
     {
 #ifndef CRISPY_TRUECOLOR
         // actual translucency map lookup taken from boom202s/R_DRAW.C:255
-        *dest = tranmap[(*dest << 8) + g_r_draw_globals->dc_colormap[0][g_r_draw_globals->dc_source[frac >> FRACBITS]]];
+        *dest = tranmap[(*dest << 8) + draw->dc_colormap[0][draw->dc_source[frac >> FRACBITS]]];
 #else
         const pixel_t destrgb = dc_colormap[0][dc_source[frac >> FRACBITS]];
         *dest                 = blendfunc(*dest, destrgb);
@@ -683,7 +683,7 @@ void R_DrawTLColumn()
 }
 
 // [crispy] draw translucent column, low-resolution version
-void R_DrawTLColumnLow()
+void R_DrawTLColumnLow(r_draw_t *draw)
 {
     int      count;
     pixel_t *dest;
@@ -692,35 +692,35 @@ void R_DrawTLColumnLow()
     fixed_t  fracstep;
     int      x;
 
-    count = g_r_draw_globals->dc_yh - g_r_draw_globals->dc_yl;
+    count = draw->dc_yh - draw->dc_yl;
     if (count < 0)
         return;
 
-    x = g_r_draw_globals->dc_x << 1;
+    x = draw->dc_x << 1;
 
 #ifdef RANGECHECK
     if (x >= SCREENWIDTH
-        || g_r_draw_globals->dc_yl < 0
-        || g_r_draw_globals->dc_yh >= SCREENHEIGHT)
+        || draw->dc_yl < 0
+        || draw->dc_yh >= SCREENHEIGHT)
     {
         I_Error("R_DrawColumn: %i to %i at %i",
-            g_r_draw_globals->dc_yl, g_r_draw_globals->dc_yh, x);
+            draw->dc_yl, draw->dc_yh, x);
     }
 #endif
 
-    dest  = ylookup[g_r_draw_globals->dc_yl] + columnofs[g_r_state_globals->flipviewwidth[x]];
-    dest2 = ylookup[g_r_draw_globals->dc_yl] + columnofs[g_r_state_globals->flipviewwidth[x + 1]];
+    dest  = ylookup[draw->dc_yl] + columnofs[g_r_state_globals->flipviewwidth[x]];
+    dest2 = ylookup[draw->dc_yl] + columnofs[g_r_state_globals->flipviewwidth[x + 1]];
 
-    fracstep = g_r_draw_globals->dc_iscale;
-    frac     = g_r_draw_globals->dc_texturemid + (g_r_draw_globals->dc_yl - centery) * fracstep;
+    fracstep = draw->dc_iscale;
+    frac     = draw->dc_texturemid + (draw->dc_yl - centery) * fracstep;
 
     do
     {
 #ifndef CRISPY_TRUECOLOR
-        *dest  = tranmap[(*dest << 8) + g_r_draw_globals->dc_colormap[0][g_r_draw_globals->dc_source[frac >> FRACBITS]]];
-        *dest2 = tranmap[(*dest2 << 8) + g_r_draw_globals->dc_colormap[0][g_r_draw_globals->dc_source[frac >> FRACBITS]]];
+        *dest  = tranmap[(*dest << 8) + draw->dc_colormap[0][draw->dc_source[frac >> FRACBITS]]];
+        *dest2 = tranmap[(*dest2 << 8) + draw->dc_colormap[0][draw->dc_source[frac >> FRACBITS]]];
 #else
-        const pixel_t destrgb = g_r_draw_globals->dc_colormap[0][g_r_draw_globals->dc_source[frac >> FRACBITS]];
+        const pixel_t destrgb = draw->dc_colormap[0][draw->dc_source[frac >> FRACBITS]];
         *dest                 = blendfunc(*dest, destrgb);
         *dest2                = blendfunc(*dest2, destrgb);
 #endif
@@ -767,7 +767,7 @@ int dscount;
 
 //
 // Draws the actual span.
-void R_DrawSpan()
+void R_DrawSpan(r_draw_t *draw)
 {
     //  unsigned int position, step;
     pixel_t *    dest;
@@ -776,13 +776,13 @@ void R_DrawSpan()
     unsigned int xtemp, ytemp;
 
 #ifdef RANGECHECK
-    if (g_r_draw_globals->ds_x2 < g_r_draw_globals->ds_x1
-        || g_r_draw_globals->ds_x1 < 0
-        || g_r_draw_globals->ds_x2 >= SCREENWIDTH
-        || g_r_draw_globals->ds_y > SCREENHEIGHT)
+    if (draw->ds_x2 < draw->ds_x1
+        || draw->ds_x1 < 0
+        || draw->ds_x2 >= SCREENWIDTH
+        || draw->ds_y > SCREENHEIGHT)
     {
         I_Error("R_DrawSpan: %i to %i at %i",
-            g_r_draw_globals->ds_x1, g_r_draw_globals->ds_x2, g_r_draw_globals->ds_y);
+            draw->ds_x1, draw->ds_x2, draw->ds_y);
     }
 //	dscount++;
 #endif
@@ -802,26 +802,26 @@ void R_DrawSpan()
     //  dest = ylookup[ds_y] + columnofs[ds_x1];
 
     // We do not check for zero spans here?
-    count = g_r_draw_globals->ds_x2 - g_r_draw_globals->ds_x1;
+    count = draw->ds_x2 - draw->ds_x1;
 
     do
     {
         uint8_t source;
         // Calculate current texture index in u,v.
         // [crispy] fix flats getting more distorted the closer they are to the right
-        ytemp = (g_r_draw_globals->ds_yfrac >> 10) & 0x0fc0;
-        xtemp = (g_r_draw_globals->ds_xfrac >> 16) & 0x3f;
+        ytemp = (draw->ds_yfrac >> 10) & 0x0fc0;
+        xtemp = (draw->ds_xfrac >> 16) & 0x3f;
         spot  = static_cast<int>(xtemp | ytemp);
 
         // Lookup pixel from flat texture tile,
         //  re-index using light/colormap.
-        source = g_r_draw_globals->ds_source[spot];
-        dest   = ylookup[g_r_draw_globals->ds_y] + columnofs[g_r_state_globals->flipviewwidth[g_r_draw_globals->ds_x1++]];
-        *dest  = g_r_draw_globals->ds_colormap[g_r_draw_globals->ds_brightmap[source]][source];
+        source = draw->ds_source[spot];
+        dest   = ylookup[draw->ds_y] + columnofs[g_r_state_globals->flipviewwidth[draw->ds_x1++]];
+        *dest  = draw->ds_colormap[draw->ds_brightmap[source]][source];
 
         //      position += step;
-        g_r_draw_globals->ds_xfrac += g_r_draw_globals->ds_xstep;
-        g_r_draw_globals->ds_yfrac += g_r_draw_globals->ds_ystep;
+        draw->ds_xfrac += draw->ds_xstep;
+        draw->ds_yfrac += draw->ds_ystep;
 
     } while (count--);
 }
@@ -903,7 +903,7 @@ void R_DrawSpan ()
 //
 // Again..
 //
-void R_DrawSpanLow()
+void R_DrawSpanLow(r_draw_t *draw)
 {
     //  unsigned int position, step;
     unsigned int xtemp, ytemp;
@@ -912,13 +912,13 @@ void R_DrawSpanLow()
     int          spot;
 
 #ifdef RANGECHECK
-    if (g_r_draw_globals->ds_x2 < g_r_draw_globals->ds_x1
-        || g_r_draw_globals->ds_x1 < 0
-        || g_r_draw_globals->ds_x2 >= SCREENWIDTH
-        || g_r_draw_globals->ds_y > SCREENHEIGHT)
+    if (draw->ds_x2 < draw->ds_x1
+        || draw->ds_x1 < 0
+        || draw->ds_x2 >= SCREENWIDTH
+        || draw->ds_y > SCREENHEIGHT)
     {
         I_Error("R_DrawSpan: %i to %i at %i",
-            g_r_draw_globals->ds_x1, g_r_draw_globals->ds_x2, g_r_draw_globals->ds_y);
+            draw->ds_x1, draw->ds_x2, draw->ds_y);
     }
 //	dscount++;
 #endif
@@ -930,11 +930,11 @@ void R_DrawSpanLow()
          | ((ds_ystep >> 6)  & 0x0000ffff);
 */
 
-    count = (g_r_draw_globals->ds_x2 - g_r_draw_globals->ds_x1);
+    count = (draw->ds_x2 - draw->ds_x1);
 
     // Blocky mode, need to multiply by 2.
-    g_r_draw_globals->ds_x1 <<= 1;
-    g_r_draw_globals->ds_x2 <<= 1;
+    draw->ds_x1 <<= 1;
+    draw->ds_x2 <<= 1;
 
     //  dest = ylookup[ds_y] + columnofs[ds_x1];
 
@@ -942,21 +942,21 @@ void R_DrawSpanLow()
     {
         // Calculate current texture index in u,v.
         // [crispy] fix flats getting more distorted the closer they are to the right
-        ytemp = (g_r_draw_globals->ds_yfrac >> 10) & 0x0fc0;
-        xtemp = (g_r_draw_globals->ds_xfrac >> 16) & 0x3f;
+        ytemp = (draw->ds_yfrac >> 10) & 0x0fc0;
+        xtemp = (draw->ds_xfrac >> 16) & 0x3f;
         spot  = static_cast<int>(xtemp | ytemp);
 
         // Lowres/blocky mode does it twice,
         //  while scale is adjusted appropriately.
-        uint8_t source = g_r_draw_globals->ds_source[spot];
-        dest   = ylookup[g_r_draw_globals->ds_y] + columnofs[g_r_state_globals->flipviewwidth[g_r_draw_globals->ds_x1++]];
-        *dest  = g_r_draw_globals->ds_colormap[g_r_draw_globals->ds_brightmap[source]][source];
-        dest   = ylookup[g_r_draw_globals->ds_y] + columnofs[g_r_state_globals->flipviewwidth[g_r_draw_globals->ds_x1++]];
-        *dest  = g_r_draw_globals->ds_colormap[g_r_draw_globals->ds_brightmap[source]][source];
+        uint8_t source = draw->ds_source[spot];
+        dest   = ylookup[draw->ds_y] + columnofs[g_r_state_globals->flipviewwidth[draw->ds_x1++]];
+        *dest  = draw->ds_colormap[draw->ds_brightmap[source]][source];
+        dest   = ylookup[draw->ds_y] + columnofs[g_r_state_globals->flipviewwidth[draw->ds_x1++]];
+        *dest  = draw->ds_colormap[draw->ds_brightmap[source]][source];
 
         //	position += step;
-        g_r_draw_globals->ds_xfrac += g_r_draw_globals->ds_xstep;
-        g_r_draw_globals->ds_yfrac += g_r_draw_globals->ds_ystep;
+        draw->ds_xfrac += draw->ds_xstep;
+        draw->ds_yfrac += draw->ds_ystep;
 
 
     } while (count--);
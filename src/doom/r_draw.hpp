@@ -20,15 +20,23 @@
 #ifndef __R_DRAW__
 #define __R_DRAW__
 
+struct r_draw_t;
+
+// Framebuffer row and column offsets of the view window.
+extern pixel_t *ylookup[MAXHEIGHT];
+extern int      columnofs[MAXWIDTH];
+
 // The span blitting interface.
 // Hook in assembler or system specific BLT
 //  here.
-void R_DrawColumn();
-void R_DrawColumnLow();
+// [crispy] the drawers take their state explicitly, so that walls and
+//  flats can be drawn from several threads at once
+void R_DrawColumn(r_draw_t *draw);
+void R_DrawColumnLow(r_draw_t *draw);
 
 // The Spectre/Invisibility effect.
-void R_DrawFuzzColumn();
-void R_DrawFuzzColumnLow();
+void R_DrawFuzzColumn(r_draw_t *draw);
+void R_DrawFuzzColumnLow(r_draw_t *draw);
 
 // [crispy] draw fuzz effect independent of rendering frame rate
 void R_SetFuzzPosTic();
@@ -37,21 +45,21 @@ void R_SetFuzzPosDraw();
 // Draw with color translation tables,
 //  for player sprite rendering,
 //  Green/Red/Blue/Indigo shirts.
-void R_DrawTranslatedColumn();
-void R_DrawTranslatedColumnLow();
+void R_DrawTranslatedColumn(r_draw_t *draw);
+void R_DrawTranslatedColumnLow(r_draw_t *draw);
 
-void R_DrawTLColumn();
-void R_DrawTLColumnLow();
+void R_DrawTLColumn(r_draw_t *draw);
+void R_DrawTLColumnLow(r_draw_t *draw);
 
 void R_VideoErase(unsigned ofs,
     int                    count);
 
 // Span blitting for rows, floor/ceiling.
 // No Sepctre effect needed.
-void R_DrawSpan();
+void R_DrawSpan(r_draw_t *draw);
 
 // Low resolution mode, 160x200?
-void R_DrawSpanLow();
+void R_DrawSpanLow(r_draw_t *draw);
 
 
 void R_InitBuffer(int width,
@@ -31,6 +31,8 @@
 #include "p_local.hpp"  // [crispy] MLOOKUNIT
 #include "r_local.hpp"
 #include "r_sky.hpp"
+#include "r_simd.hpp" // [crispy] R_InitDrawers()
+#include "d_bench.hpp" // [crispy] -benchmark phase timings
 #include "st_stuff.hpp" // [crispy] ST_refreshBackground()
 
 
@@ -80,12 +82,12 @@ int MAXLIGHTZ;
 int LIGHTZSHIFT;
 
 
-void (*colfunc)();
-void (*basecolfunc)();
-void (*fuzzcolfunc)();
-void (*transcolfunc)();
-void (*tlcolfunc)();
-void (*spanfunc)();
+void (*colfunc)(r_draw_t *);
+void (*basecolfunc)(r_draw_t *);
+void (*fuzzcolfunc)(r_draw_t *);
+void (*transcolfunc)(r_draw_t *);
+void (*tlcolfunc)(r_draw_t *);
+void (*spanfunc)(r_draw_t *);
 
 static r_state_t r_state_s = {
     .textureheight   = nullptr, // X
@@ -290,15 +292,12 @@ int R_PointOnSegSide(fixed_t x,
 
 // [crispy] turned into a general R_PointToAngle() flavor
 // called with either slope_div = SlopeDivCrispy() from R_PointToAngleCrispy()
-// or slope_div = SlopeDiv() else
-angle_t
-    R_PointToAngleSlope(fixed_t x,
-        fixed_t                 y,
+// or slope_div = SlopeDiv() else; x and y are relative to the origin
+static angle_t
+    R_DeltaToAngle(fixed_t x,
+        fixed_t            y,
         int (*slope_div)(unsigned int num, unsigned int den))
 {
-    x -= g_r_state_globals->viewx;
-    y -= g_r_state_globals->viewy;
-
     if ((!x) && (!y))
         return 0;
 
@@ -377,6 +376,15 @@ angle_t
     [[unreachable]];
 }
 
+angle_t
+    R_PointToAngleSlope(fixed_t x,
+        fixed_t                 y,
+        int (*slope_div)(unsigned int num, unsigned int den))
+{
+    return R_DeltaToAngle(x - g_r_state_globals->viewx,
+        y - g_r_state_globals->viewy, slope_div);
+}
+
 angle_t
     R_PointToAngle(fixed_t x,
         fixed_t            y)
@@ -384,25 +392,37 @@ angle_t
     return R_PointToAngleSlope(x, y, SlopeDiv);
 }
 
-// [crispy] overflow-safe R_PointToAngle() flavor
-// called only from R_CheckBBox(), R_AddLine() and P_SegLengths()
+// [crispy] overflow-safe R_PointToAngle2() flavor, which unlike that
+// leaves viewx/viewy alone and so can be called from the workers
+// called from R_PointToAngleCrispy() and P_SegLengths()
 angle_t
-    R_PointToAngleCrispy(fixed_t x,
-        fixed_t                  y)
+    R_PointToAngleCrispy2(fixed_t x1,
+        fixed_t                   y1,
+        fixed_t                   x2,
+        fixed_t                   y2)
 {
     // [crispy] fix overflows for very long distances
-    int64_t y_viewy = static_cast<int64_t>(y) - g_r_state_globals->viewy;
-    int64_t x_viewx = static_cast<int64_t>(x) - g_r_state_globals->viewx;
+    int64_t dy = static_cast<int64_t>(y2) - y1;
+    int64_t dx = static_cast<int64_t>(x2) - x1;
 
     // [crispy] the worst that could happen is e.g. INT_MIN-INT_MAX = 2*INT_MIN
-    if (x_viewx < INT_MIN || x_viewx > INT_MAX || y_viewy < INT_MIN || y_viewy > INT_MAX)
+    if (dx < INT_MIN || dx > INT_MAX || dy < INT_MIN || dy > INT_MAX)
     {
         // [crispy] preserving the angle by halfing the distance in both directions
-        x = static_cast<fixed_t >(x_viewx / 2 + g_r_state_globals->viewx);
-        y = static_cast<fixed_t >(y_viewy / 2 + g_r_state_globals->viewy);
+        dx /= 2;
+        dy /= 2;
     }
 
-    return R_PointToAngleSlope(x, y, SlopeDivCrispy);
+    return R_DeltaToAngle(static_cast<fixed_t>(dx), static_cast<fixed_t>(dy), SlopeDivCrispy);
+}
+
+// [crispy] overflow-safe R_PointToAngle() flavor
+// called only from R_CheckBBox() and R_AddLine()
+angle_t
+    R_PointToAngleCrispy(fixed_t x,
+        fixed_t                  y)
+{
+    return R_PointToAngleCrispy2(g_r_state_globals->viewx, g_r_state_globals->viewy, x, y);
 }
 
 angle_t
@@ -783,6 +803,7 @@ void R_SetViewSize(int blocks,
 //
 void R_ExecuteSetViewSize()
 {
+    static bool drawersinit = false;
     fixed_t cosadj;
     fixed_t dy;
     int     i;
@@ -825,13 +846,20 @@ void R_ExecuteSetViewSize()
     centeryfrac = centery << FRACBITS;
     projection  = MIN(centerxfrac, ((HIRESWIDTH >> detailshift) / 2) << FRACBITS);
 
+    // [crispy] pick the SIMD drawers once SCREENWIDTH is known
+    if (!drawersinit)
+    {
+        R_InitDrawers();
+        drawersinit = true;
+    }
+
     if (!detailshift)
     {
-        colfunc = basecolfunc = R_DrawColumn;
+        colfunc = basecolfunc = bestcolfunc;
         fuzzcolfunc           = R_DrawFuzzColumn;
         transcolfunc          = R_DrawTranslatedColumn;
-        tlcolfunc             = R_DrawTLColumn;
-        spanfunc              = R_DrawSpan;
+        tlcolfunc             = besttlcolfunc;
+        spanfunc              = bestspanfunc;
     }
     else
     {
@@ -1052,9 +1080,14 @@ void R_SetupFrame(player_t *player)
 //
 void R_RenderPlayerView(player_t *player)
 {
+    uint64_t benchstart;
+
     extern void V_DrawFilledBox(int x, int y, int w, int h, int c);
     extern void R_InterpolateTextureOffsets();
 
+    // [crispy] pick up textures composited in the background
+    R_FinishComposites();
+
     R_SetupFrame(player);
 
     // Clear buffers.
@@ -1064,7 +1097,9 @@ void R_RenderPlayerView(player_t *player)
     R_ClearSprites();
     if (g_doomstat_globals->automapactive && !crispy->automapoverlay)
     {
+        R_StartWallColumns();
         R_RenderBSPNode(g_r_state_globals->numnodes - 1);
+        R_DrawWallColumns();
         return;
     }
 
@@ -1083,19 +1118,27 @@ void R_RenderPlayerView(player_t *player)
     // [crispy] smooth texture scrolling
     R_InterpolateTextureOffsets();
     // The head node is the last node output.
+    benchstart = D_BenchBegin();
+    R_StartWallColumns();
     R_RenderBSPNode(g_r_state_globals->numnodes - 1);
+    R_DrawWallColumns();
+    D_BenchEnd(bp_bsp, benchstart);
 
     // Check for new console commands.
     NetUpdate();
 
+    benchstart = D_BenchBegin();
     R_DrawPlanes();
+    D_BenchEnd(bp_planes, benchstart);
 
     // Check for new console commands.
     NetUpdate();
 
     // [crispy] draw fuzz effect independent of rendering frame rate
     R_SetFuzzPosDraw();
+    benchstart = D_BenchBegin();
     R_DrawMasked();
+    D_BenchEnd(bp_masked, benchstart);
 
     // Check for new console commands.
     NetUpdate();
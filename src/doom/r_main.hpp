@@ -23,6 +23,8 @@
 #include "d_player.hpp"
 #include "r_data.hpp"
 
+struct r_draw_t;
+
 
 //
 // POV related.
@@ -90,13 +92,13 @@ extern int detailshift;
 // Function pointers to switch refresh/drawing functions.
 // Used to select shadow mode etc.
 //
-extern void (*colfunc)();
-extern void (*transcolfunc)();
-extern void (*basecolfunc)();
-extern void (*fuzzcolfunc)();
-extern void (*tlcolfunc)();
+extern void (*colfunc)(r_draw_t *);
+extern void (*transcolfunc)(r_draw_t *);
+extern void (*basecolfunc)(r_draw_t *);
+extern void (*fuzzcolfunc)(r_draw_t *);
+extern void (*tlcolfunc)(r_draw_t *);
 // No shadow effects on floors.
-extern void (*spanfunc)();
+extern void (*spanfunc)(r_draw_t *);
 
 
 //
@@ -117,6 +119,12 @@ angle_t
     R_PointToAngleCrispy(fixed_t x,
         fixed_t                  y);
 
+angle_t
+    R_PointToAngleCrispy2(fixed_t x1,
+        fixed_t                   y1,
+        fixed_t                   x2,
+        fixed_t                   y2);
+
 angle_t
     R_PointToAngle2(fixed_t x1,
         fixed_t             y1,
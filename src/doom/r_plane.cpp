@@ -34,6 +34,7 @@
 #include "r_bmaps.hpp" // [crispy] R_BrightmapForTexName()
 #include "r_swirl.hpp" // [crispy] R_DistortedFlat()
 #include "lump.hpp"
+#include "i_thread.hpp" // [crispy] I_RunOnWorkers()
 
 
 planefunction_t floorfunc;
@@ -49,6 +50,26 @@ visplane_t *visplanes = nullptr;
 visplane_t *lastvisplane;
 static int  numvisplanes;
 
+// [crispy] hashed visplane lookup, replaces the linear scan in R_FindPlane()
+// Slots are stamped with the frame they were filled in, so clearing the
+// table at the start of each frame is a single increment.
+#define MINVISPLANEHASH 512 // must be a power of two
+
+typedef struct
+{
+    unsigned int frame;
+    int          index; // into visplanes[], which may be reallocated
+} visplanehash_t;
+
+static visplanehash_t *visplanehash;
+static unsigned int    visplanehash_size;
+static unsigned int    visplanehash_frame;
+static unsigned int    visplanehash_count;
+
+// [crispy] visplane statistics for the FPS widget
+int visplanecount;
+int visplaneprobes;
+
 // ?
 #define MAXOPENINGS MAXWIDTH * 64 * 4
 int  openings[MAXOPENINGS]; // [crispy] 32-bit integer math
@@ -64,17 +85,56 @@ int floorclip[MAXWIDTH];   // [crispy] 32-bit integer math
 int ceilingclip[MAXWIDTH]; // [crispy] 32-bit integer math
 
 //
-// spanstart holds the start of a plane span
-// initialized to 0 at start
+// [crispy] flats may be drawn by several worker threads at once.
+// Each worker owns an interleaved subset of the screen rows and keeps
+// its own span state, so the rows it draws come out exactly as they
+// would from a single thread.
 //
-int spanstart[MAXHEIGHT];
-int spanstop[MAXHEIGHT];
+#define PLANEROWSHIFT 3 // rows are handed out in blocks of 8
 
-//
-// texture mapping
-//
-lighttable_t **planezlight;
-fixed_t        planeheight;
+typedef struct
+{
+    int       id;
+    r_draw_t  draw;
+
+    //
+    // spanstart holds the start of a plane span
+    // initialized to 0 at start
+    //
+    int spanstart[MAXHEIGHT];
+
+    //
+    // texture mapping
+    //
+    lighttable_t **planezlight;
+    fixed_t        planeheight;
+} planeworker_t;
+
+static planeworker_t planeworkers[MAXWORKERS];
+
+// [crispy] a flat visplane queued for the workers
+typedef struct
+{
+    visplane_t    *pl;
+    uint8_t       *source;
+    uint8_t       *brightmap;
+    lighttable_t **planezlight;
+    fixed_t        planeheight;
+    int            lumpnum;
+    int            swirl; // index into swirlflats[], or -1
+} flatjob_t;
+
+static int        numplaneworkers = 1;
+static flatjob_t *flatjobs;
+static int        numflatjobs;
+static int        maxflatjobs;
+
+// [crispy] R_DistortedFlat() returns a single static buffer, so swirling
+//  flats need their own copy while the workers are drawing
+#define FLATSIZE (64 * 64)
+static uint8_t *swirlflats;
+static int      numswirlflats;
+static int      maxswirlflats;
 
 fixed_t *yslope;
 fixed_t  yslopes[LOOKDIRS][MAXHEIGHT];
@@ -102,8 +162,8 @@ void R_InitPlanes()
 // R_MapPlane
 //
 // Uses global vars:
-//  planeheight
-//  ds_source
+//  pw->planeheight
+//  pw->draw.ds_source
 //  basexscale
 //  baseyscale
 //  viewx
@@ -111,10 +171,19 @@ void R_InitPlanes()
 //
 // BASIC PRIMITIVE
 //
-void R_MapPlane(int y,
-    int             x1,
-    int             x2)
+static void R_MapPlane(planeworker_t *pw,
+    int                               y,
+    int                               x1,
+    int                               x2)
 {
+    r_draw_t *const draw = &pw->draw;
+
+    // [crispy] leave rows owned by other workers alone
+    if (((y >> PLANEROWSHIFT) % numplaneworkers) != pw->id)
+    {
+        return;
+    }
+
 #ifdef RANGECHECK
     if (x2 < x1
         || x1 < 0
@@ -135,27 +204,27 @@ void R_MapPlane(int y,
     }
 
     fixed_t distance = 0;
-    if (planeheight != cachedheight[y])
+    if (pw->planeheight != cachedheight[y])
     {
-        cachedheight[y] = planeheight;
-        distance = cacheddistance[y] = FixedMul(planeheight, yslope[y]);
-        g_r_draw_globals->ds_xstep = cachedxstep[y] = (FixedMul(viewsin, planeheight) / dy) << detailshift;
-        g_r_draw_globals->ds_ystep = cachedystep[y] = (FixedMul(viewcos, planeheight) / dy) << detailshift;
+        cachedheight[y] = pw->planeheight;
+        distance = cacheddistance[y] = FixedMul(pw->planeheight, yslope[y]);
+        draw->ds_xstep = cachedxstep[y] = (FixedMul(viewsin, pw->planeheight) / dy) << detailshift;
+        draw->ds_ystep = cachedystep[y] = (FixedMul(viewcos, pw->planeheight) / dy) << detailshift;
     }
     else
     {
         distance = cacheddistance[y];
-        g_r_draw_globals->ds_xstep = cachedxstep[y];
-        g_r_draw_globals->ds_ystep = cachedystep[y];
+        draw->ds_xstep = cachedxstep[y];
+        draw->ds_ystep = cachedystep[y];
     }
 
     int dx = x1 - centerx;
 
-    g_r_draw_globals->ds_xfrac = g_r_state_globals->viewx + FixedMul(viewcos, distance) + dx * g_r_draw_globals->ds_xstep;
-    g_r_draw_globals->ds_yfrac = -g_r_state_globals->viewy - FixedMul(viewsin, distance) + dx * g_r_draw_globals->ds_ystep;
+    draw->ds_xfrac = g_r_state_globals->viewx + FixedMul(viewcos, distance) + dx * draw->ds_xstep;
+    draw->ds_yfrac = -g_r_state_globals->viewy - FixedMul(viewsin, distance) + dx * draw->ds_ystep;
 
     if (fixedcolormap)
-        g_r_draw_globals->ds_colormap[0] = g_r_draw_globals->ds_colormap[1] = fixedcolormap;
+        draw->ds_colormap[0] = draw->ds_colormap[1] = fixedcolormap;
     else
     {
         int index = distance >> LIGHTZSHIFT;
@@ -163,16 +232,16 @@ void R_MapPlane(int y,
         if (index >= MAXLIGHTZ)
             index = MAXLIGHTZ - 1;
 
-        g_r_draw_globals->ds_colormap[0] = planezlight[index];
-        g_r_draw_globals->ds_colormap[1] = zlight[LIGHTLEVELS - 1][MAXLIGHTZ - 1];
+        draw->ds_colormap[0] = pw->planezlight[index];
+        draw->ds_colormap[1] = zlight[LIGHTLEVELS - 1][MAXLIGHTZ - 1];
     }
 
-    g_r_draw_globals->ds_y  = y;
-    g_r_draw_globals->ds_x1 = x1;
-    g_r_draw_globals->ds_x2 = x2;
+    draw->ds_y  = y;
+    draw->ds_x1 = x1;
+    draw->ds_x2 = x2;
 
     // high or low detail
-    spanfunc();
+    spanfunc(draw);
 }
 
 
@@ -195,6 +264,16 @@ void R_ClearPlanes()
     lastvisplane = visplanes;
     lastopening  = openings;
 
+    // [crispy] invalidate all hash slots at once
+    if (++visplanehash_frame == 0)
+    {
+        if (visplanehash)
+            std::memset(visplanehash, 0, visplanehash_size * sizeof(*visplanehash));
+        visplanehash_frame = 1;
+    }
+    visplanehash_count = 0;
+    visplaneprobes     = 0;
+
     // texture calculation
     std::memset(cachedheight, 0, sizeof(cachedheight));
 
@@ -232,6 +311,76 @@ static void R_RaiseVisplanes(visplane_t **vp)
     }
 }
 
+// [crispy] hashed visplane lookup
+static unsigned int R_VisplaneHash(fixed_t height, int picnum, int lightlevel)
+{
+    unsigned int h = static_cast<unsigned int>(height);
+
+    h ^= static_cast<unsigned int>(picnum) * 0x9e3779b1u;
+    h ^= static_cast<unsigned int>(lightlevel) * 0x85ebca77u;
+    h ^= h >> 16;
+    h *= 0x7feb352du;
+    h ^= h >> 15;
+
+    return h;
+}
+
+// Returns the slot holding the first visplane with the given key, or the
+// empty slot where it should be inserted.
+static visplanehash_t *R_VisplaneSlot(fixed_t height, int picnum, int lightlevel)
+{
+    const unsigned int mask = visplanehash_size - 1;
+    unsigned int       i    = R_VisplaneHash(height, picnum, lightlevel) & mask;
+
+    while (true)
+    {
+        visplanehash_t *slot = &visplanehash[i];
+
+        visplaneprobes++;
+
+        if (slot->frame != visplanehash_frame)
+            return slot;
+
+        const visplane_t *check = &visplanes[slot->index];
+
+        if (height == check->height
+            && picnum == check->picnum
+            && lightlevel == check->lightlevel)
+        {
+            return slot;
+        }
+
+        i = (i + 1) & mask;
+    }
+}
+
+// Keep the load factor below 1/2. Rehashing walks visplanes[] in order and
+// only records the first visplane per key, so splits made by R_CheckPlane()
+// never shadow the plane the old linear search would have found.
+static void R_RaiseVisplaneHash()
+{
+    if (visplanehash && 2 * visplanehash_count < visplanehash_size)
+        return;
+
+    visplanehash_size = visplanehash_size ? 2 * visplanehash_size : MINVISPLANEHASH;
+    visplanehash      = static_cast<decltype(visplanehash)>(I_Realloc(visplanehash, visplanehash_size * sizeof(*visplanehash)));
+    std::memset(visplanehash, 0, visplanehash_size * sizeof(*visplanehash));
+    visplanehash_frame = 1;
+    visplanehash_count = 0;
+
+    for (visplane_t *pl = visplanes; pl < lastvisplane; pl++)
+    {
+        visplanehash_t *slot = R_VisplaneSlot(pl->height, pl->picnum, pl->lightlevel);
+
+        if (slot->frame != visplanehash_frame)
+        {
+            slot->frame = visplanehash_frame;
+            slot->index = static_cast<int>(pl - visplanes);
+            visplanehash_count++;
+        }
+    }
+}
+
 //
 // R_FindPlane
 //
@@ -240,7 +389,8 @@ visplane_t *
         int             picnum,
         int             lightlevel)
 {
-    visplane_t *check;
+    visplane_t     *check;
+    visplanehash_t *slot;
 
     // [crispy] add support for MBF sky tranfers
     if (picnum == g_doomstat_globals->skyflatnum || static_cast<unsigned int>(picnum) & PL_SKYFLAT)
@@ -249,26 +399,24 @@ visplane_t *
         lightlevel = 0;
     }
 
-    for (check = visplanes; check < lastvisplane; check++)
-    {
-        if (height == check->height
-            && picnum == check->picnum
-            && lightlevel == check->lightlevel)
-        {
-            break;
-        }
-    }
+    R_RaiseVisplaneHash(); // [crispy] hashed visplane lookup
 
+    slot = R_VisplaneSlot(height, picnum, lightlevel);
 
-    if (check < lastvisplane)
-        return check;
+    if (slot->frame == visplanehash_frame)
+        return &visplanes[slot->index];
 
+    check = lastvisplane;
     R_RaiseVisplanes(&check); // [crispy] remove VISPLANES limit
     if (lastvisplane - visplanes == MAXVISPLANES && false)
         I_Error("R_FindPlane: no more visplanes");
 
     lastvisplane++;
 
+    slot->frame = visplanehash_frame;
+    slot->index = static_cast<int>(check - visplanes);
+    visplanehash_count++;
+
     check->height     = height;
     check->picnum     = picnum;
     check->lightlevel = lightlevel;
@@ -357,20 +505,23 @@ visplane_t *
 //
 // R_MakeSpans
 //
-void R_MakeSpans(int x,
-    unsigned int     t1, // [crispy] 32-bit integer math
-    unsigned int     b1, // [crispy] 32-bit integer math
-    unsigned int     t2, // [crispy] 32-bit integer math
-    unsigned int     b2)     // [crispy] 32-bit integer math
+static void R_MakeSpans(planeworker_t *pw,
+    int                                x,
+    unsigned int                       t1, // [crispy] 32-bit integer math
+    unsigned int                       b1, // [crispy] 32-bit integer math
+    unsigned int                       t2, // [crispy] 32-bit integer math
+    unsigned int                       b2) // [crispy] 32-bit integer math
 {
+    int *const spanstart = pw->spanstart;
+
     while (t1 < t2 && t1 <= b1)
     {
-        R_MapPlane(static_cast<int>(t1), spanstart[t1], x - 1);
+        R_MapPlane(pw, static_cast<int>(t1), spanstart[t1], x - 1);
         t1++;
     }
     while (b1 > b2 && b1 >= t1)
     {
-        R_MapPlane(static_cast<int>(b1), spanstart[b1], x - 1);
+        R_MapPlane(pw, static_cast<int>(b1), spanstart[b1], x - 1);
         b1--;
     }
 
@@ -387,6 +538,71 @@ void R_MakeSpans(int x,
 }
 
 
+//
+// R_DrawFlat
+// [crispy] draws the rows of a flat visplane owned by this worker
+//
+static void R_DrawFlat(planeworker_t *pw, const flatjob_t *job)
+{
+    const visplane_t *pl = job->pl;
+    int               x;
+    int               stop;
+
+    pw->draw.ds_source    = job->source;
+    pw->draw.ds_brightmap = job->brightmap;
+    pw->planeheight       = job->planeheight;
+    pw->planezlight       = job->planezlight;
+
+    stop = pl->maxx + 1;
+
+    for (x = pl->minx; x <= stop; x++)
+    {
+        R_MakeSpans(pw, x, pl->top[x - 1],
+            pl->bottom[x - 1],
+            pl->top[x],
+            pl->bottom[x]);
+    }
+}
+
+static void R_DrawFlatsWorker(void *, int worker)
+{
+    planeworker_t *pw = &planeworkers[worker];
+    int            i;
+
+    pw->id = worker;
+
+    for (i = 0; i < numflatjobs; i++)
+    {
+        R_DrawFlat(pw, &flatjobs[i]);
+    }
+}
+
+static flatjob_t *R_NewFlatJob()
+{
+    if (numflatjobs == maxflatjobs)
+    {
+        maxflatjobs = maxflatjobs ? 2 * maxflatjobs : MAXVISPLANES;
+        flatjobs    = static_cast<decltype(flatjobs)>(I_Realloc(flatjobs, static_cast<unsigned long>(maxflatjobs) * sizeof(*flatjobs)));
+    }
+
+    return &flatjobs[numflatjobs++];
+}
+
+// [crispy] returns the index of a private copy of the distorted flat
+static int R_CopySwirlFlat(const uint8_t *flat)
+{
+    if (numswirlflats == maxswirlflats)
+    {
+        maxswirlflats = maxswirlflats ? 2 * maxswirlflats : 16;
+        swirlflats    = static_cast<decltype(swirlflats)>(I_Realloc(swirlflats, static_cast<unsigned long>(maxswirlflats) * FLATSIZE));
+    }
+
+    std::memcpy(swirlflats + numswirlflats * FLATSIZE, flat, FLATSIZE);
+
+    return numswirlflats++;
+}
+
+
 //
 // R_DrawPlanes
 // At the end of each frame.
@@ -394,9 +610,10 @@ void R_MakeSpans(int x,
 void R_DrawPlanes()
 {
     visplane_t *pl;
+    flatjob_t  *job;
     int         light;
     int         x;
-    int         stop;
+    int         i;
     int         angle;
     int         lumpnum;
 
@@ -414,6 +631,15 @@ void R_DrawPlanes()
             lastopening - openings);
 #endif
 
+    visplanecount = static_cast<int>(lastvisplane - visplanes); // [crispy] FPS widget
+
+    // [crispy] with worker threads, skies are still drawn here in order,
+    // while flats are queued and drawn afterwards by all workers at once.
+    // Visplanes never share a pixel, so the result is the same.
+    numplaneworkers = I_NumWorkers();
+    numflatjobs     = 0;
+    numswirlflats   = 0;
+
     for (pl = visplanes; pl < lastvisplane; pl++)
     {
         const bool swirling = (g_r_state_globals->flattranslation[pl->picnum] == -1);
@@ -421,7 +647,6 @@ void R_DrawPlanes()
         if (pl->minx > pl->maxx)
             continue;
 
-
         // sky flat
         // [crispy] add support for MBF sky tranfers
         if (pl->picnum == g_doomstat_globals->skyflatnum || static_cast<unsigned int>(pl->picnum) & PL_SKYFLAT)
@@ -471,7 +696,7 @@ void R_DrawPlanes()
                     angle     = ((an + g_r_state_globals->xtoviewangle[x]) ^ flip) >> ANGLETOSKYSHIFT;
                     g_r_draw_globals->dc_x      = x;
                     g_r_draw_globals->dc_source = R_GetColumn(texture, angle, false);
-                    colfunc();
+                    colfunc(g_r_draw_globals);
                 }
             }
             continue;
@@ -479,13 +704,28 @@ void R_DrawPlanes()
 
         // regular flat
         lumpnum = g_r_state_globals->firstflat + (swirling ? pl->picnum : g_r_state_globals->flattranslation[pl->picnum]);
+
+        job          = R_NewFlatJob();
+        job->pl      = pl;
+        job->lumpnum = lumpnum;
+        job->swirl   = -1;
+
         // [crispy] add support for SMMU swirling flats
-        g_r_draw_globals->ds_source =
-            static_cast<uint8_t *>(swirling ? reinterpret_cast<unsigned char *>(R_DistortedFlat(lumpnum)) : cache_lump_num<uint8_t *>(lumpnum, PU_STATIC));
-        g_r_draw_globals->ds_brightmap = R_BrightmapForFlatNum(lumpnum - g_r_state_globals->firstflat);
+        if (swirling && numplaneworkers > 1)
+        {
+            // resolved below, once swirlflats[] has stopped growing
+            job->source = nullptr;
+            job->swirl  = R_CopySwirlFlat(reinterpret_cast<uint8_t *>(R_DistortedFlat(lumpnum)));
+        }
+        else
+        {
+            job->source =
+                static_cast<uint8_t *>(swirling ? reinterpret_cast<unsigned char *>(R_DistortedFlat(lumpnum)) : cache_lump_num<uint8_t *>(lumpnum, PU_STATIC));
+        }
+        job->brightmap = R_BrightmapForFlatNum(lumpnum - g_r_state_globals->firstflat);
 
-        planeheight = std::abs(pl->height - g_r_state_globals->viewz);
-        light       = (pl->lightlevel >> LIGHTSEGSHIFT) + (extralight * LIGHTBRIGHT);
+        job->planeheight = std::abs(pl->height - g_r_state_globals->viewz);
+        light            = (pl->lightlevel >> LIGHTSEGSHIFT) + (extralight * LIGHTBRIGHT);
 
         if (light >= LIGHTLEVELS)
             light = LIGHTLEVELS - 1;
@@ -493,21 +733,35 @@ void R_DrawPlanes()
         if (light < 0)
             light = 0;
 
-        planezlight = zlight[light];
+        job->planezlight = zlight[light];
 
         pl->top[pl->maxx + 1] = 0xffffffffu; // [crispy] hires / 32-bit integer math
         pl->top[pl->minx - 1] = 0xffffffffu; // [crispy] hires / 32-bit integer math
 
-        stop = pl->maxx + 1;
-
-        for (x = pl->minx; x <= stop; x++)
+        if (numplaneworkers == 1)
         {
-            R_MakeSpans(x, pl->top[x - 1],
-                pl->bottom[x - 1],
-                pl->top[x],
-                pl->bottom[x]);
+            planeworkers[0].id = 0;
+            R_DrawFlat(&planeworkers[0], job);
+
+            W_ReleaseLumpNum(lumpnum);
+
+            numflatjobs = 0;
         }
+    }
 
-        W_ReleaseLumpNum(lumpnum);
+    if (numflatjobs == 0)
+        return;
+
+    for (i = 0, job = flatjobs; i < numflatjobs; i++, job++)
+    {
+        if (job->swirl >= 0)
+            job->source = swirlflats + job->swirl * FLATSIZE;
+    }
+
+    I_RunOnWorkers(R_DrawFlatsWorker, nullptr);
+
+    for (i = 0, job = flatjobs; i < numflatjobs; i++, job++)
+    {
+        W_ReleaseLumpNum(job->lumpnum);
     }
 }
@@ -38,6 +38,10 @@ extern planefunction_t ceilingfunc_t;
 extern int floorclip[MAXWIDTH];   // [crispy] 32-bit integer math
 extern int ceilingclip[MAXWIDTH]; // [crispy] 32-bit integer math
 
+// [crispy] visplane statistics for the FPS widget
+extern int visplanecount;
+extern int visplaneprobes;
+
 extern fixed_t *yslope;
 extern fixed_t  yslopes[LOOKDIRS][MAXHEIGHT];
 extern fixed_t  distscale[MAXWIDTH];
@@ -45,16 +49,6 @@ extern fixed_t  distscale[MAXWIDTH];
 void R_InitPlanes();
 void R_ClearPlanes();
 
-void R_MapPlane(int y,
-    int             x1,
-    int             x2);
-
-void R_MakeSpans(int x,
-    unsigned int     t1, // [crispy] 32-bit integer math
-    unsigned int     b1, // [crispy] 32-bit integer math
-    unsigned int     t2, // [crispy] 32-bit integer math
-    unsigned int     b2);    // [crispy] 32-bit integer math
-
 void R_DrawPlanes();
 
 visplane_t *
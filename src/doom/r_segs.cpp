@@ -24,6 +24,7 @@
 #include "doomstat.hpp"
 #include "r_local.hpp"
 #include "r_bmaps.hpp" // [crispy] brightmaps
+#include "i_thread.hpp" // [crispy] I_RunOnWorkers()
 
 
 // OPTIMIZE: closed two sided lines as single sided
@@ -74,6 +75,120 @@ lighttable_t **walllights;
 
 int *maskedtexturecol; // [crispy] 32-bit integer math
 
+//
+// [crispy] with worker threads, wall columns are not drawn right away
+// but recorded during the BSP walk, sorted into one band of screen
+// columns per worker, and drawn by all workers in R_DrawWallColumns().
+// Each screen column belongs to exactly one band, so its pixels are
+// written in the same order as if they had been drawn immediately.
+//
+typedef struct
+{
+    int           x;
+    int           yl;
+    int           yh;
+    fixed_t       iscale;
+    fixed_t       texturemid;
+    int           texheight;
+    uint8_t      *source;
+    uint8_t      *brightmap;
+    lighttable_t *colormap[2];
+} wallcolumn_t;
+
+typedef struct
+{
+    wallcolumn_t *columns;
+    int           numcolumns;
+    int           maxcolumns;
+} wallband_t;
+
+static wallband_t wallbands[MAXWORKERS];
+
+static void R_DrawWallColumn()
+{
+    const r_draw_t *const dc = g_r_draw_globals;
+    const int             n  = I_NumWorkers();
+    wallband_t           *band;
+    wallcolumn_t         *col;
+
+    if (n == 1)
+    {
+        colfunc(g_r_draw_globals);
+        return;
+    }
+
+    band = &wallbands[dc->dc_x * n / g_r_state_globals->viewwidth];
+
+    if (band->numcolumns == band->maxcolumns)
+    {
+        band->maxcolumns = band->maxcolumns ? 2 * band->maxcolumns : MAXWIDTH;
+        band->columns    = static_cast<decltype(band->columns)>(I_Realloc(band->columns, static_cast<unsigned long>(band->maxcolumns) * sizeof(*band->columns)));
+    }
+
+    col              = &band->columns[band->numcolumns++];
+    col->x           = dc->dc_x;
+    col->yl          = dc->dc_yl;
+    col->yh          = dc->dc_yh;
+    col->iscale      = dc->dc_iscale;
+    col->texturemid  = dc->dc_texturemid;
+    col->texheight   = dc->dc_texheight;
+    col->source      = dc->dc_source;
+    col->brightmap   = dc->dc_brightmap;
+    col->colormap[0] = dc->dc_colormap[0];
+    col->colormap[1] = dc->dc_colormap[1];
+}
+
+static void R_DrawWallColumnsWorker(void *, int worker)
+{
+    wallband_t         *band = &wallbands[worker];
+    const wallcolumn_t *col  = band->columns;
+    r_draw_t            draw = *g_r_draw_globals;
+    int                 i;
+
+    for (i = 0; i < band->numcolumns; i++, col++)
+    {
+        draw.dc_x           = col->x;
+        draw.dc_yl          = col->yl;
+        draw.dc_yh          = col->yh;
+        draw.dc_iscale      = col->iscale;
+        draw.dc_texturemid  = col->texturemid;
+        draw.dc_texheight   = col->texheight;
+        draw.dc_source      = col->source;
+        draw.dc_brightmap   = col->brightmap;
+        draw.dc_colormap[0] = col->colormap[0];
+        draw.dc_colormap[1] = col->colormap[1];
+        colfunc(&draw);
+    }
+
+    band->numcolumns = 0;
+}
+
+//
+// R_StartWallColumns
+// [crispy] before the BSP walk: the composites the recorded columns
+// point into must stay in the zone until they have been drawn
+//
+void R_StartWallColumns()
+{
+    if (I_NumWorkers() == 1)
+        return;
+
+    R_LockComposites();
+}
+
+//
+// R_DrawWallColumns
+// [crispy] draw the wall columns recorded during the BSP walk
+//
+void R_DrawWallColumns()
+{
+    if (I_NumWorkers() == 1)
+        return;
+
+    I_RunOnWorkers(R_DrawWallColumnsWorker, nullptr);
+    R_UnlockComposites();
+}
+
 
 // [crispy] WiggleFix: add this code block near the top of r_segs.c
 //
@@ -381,7 +496,7 @@ void R_RenderSegLoop()
             g_r_draw_globals->dc_source     = R_GetColumn(midtexture, texturecolumn, true);
             g_r_draw_globals->dc_texheight  = g_r_state_globals->textureheight[midtexture] >> FRACBITS; // [crispy] Tutti-Frutti fix
             g_r_draw_globals->dc_brightmap  = texturebrightmap[midtexture];
-            colfunc();
+            R_DrawWallColumn();
             ceilingclip[rw_x] = g_r_state_globals->viewheight;
             floorclip[rw_x]   = -1;
         }
@@ -405,7 +520,7 @@ void R_RenderSegLoop()
                     g_r_draw_globals->dc_source     = R_GetColumn(toptexture, texturecolumn, true);
                     g_r_draw_globals->dc_texheight  = g_r_state_globals->textureheight[toptexture] >> FRACBITS; // [crispy] Tutti-Frutti fix
                     g_r_draw_globals->dc_brightmap  = texturebrightmap[toptexture];
-                    colfunc();
+                    R_DrawWallColumn();
                     ceilingclip[rw_x] = mid;
                 }
                 else
@@ -437,7 +552,7 @@ void R_RenderSegLoop()
                         texturecolumn, true);
                     g_r_draw_globals->dc_texheight  = g_r_state_globals->textureheight[bottomtexture] >> FRACBITS; // [crispy] Tutti-Frutti fix
                     g_r_draw_globals->dc_brightmap  = texturebrightmap[bottomtexture];
-                    colfunc();
+                    R_DrawWallColumn();
                     floorclip[rw_x] = mid;
                 }
                 else
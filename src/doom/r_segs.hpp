@@ -25,5 +25,8 @@ void R_RenderMaskedSegRange(drawseg_t *ds,
     int                                x1,
     int                                x2);
 
+void R_StartWallColumns(); // [crispy] before deferring wall columns
+void R_DrawWallColumns();  // [crispy] draw deferred wall columns
+
 
 #endif
@@ -0,0 +1,574 @@
+//
+// Copyright(C) 1993-1996 Id Software, Inc.
+// Copyright(C) 2005-2014 Simon Howard
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//	SIMD column and span drawers, selected at startup.
+//
+//	The table lookups (texture, brightmap, colormap, tranmap) have
+//	no cheap vector form on byte tables, so the vector units compute
+//	the texture coordinates of 4 or 8 pixels at a time and the
+//	lookups stay scalar.  Spans additionally write their pixels to
+//	consecutive addresses instead of going through columnofs[] and
+//	flipviewwidth[] for every pixel.
+//
+//	The fuzz drawer is left alone: each pixel reads its neighbours,
+//	which may just have been written by the same loop.
+//
+
+#include <cstdio>
+
+#include "SDL.h"
+
+#include "m_argv.hpp"
+#include "doomdef.hpp"
+#include "doomstat.hpp"
+
+#include "r_local.hpp"
+#include "r_simd.hpp"
+
+#include "v_trans.hpp" // [crispy] tranmap
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define HAVE_SIMD_X86
+#include <immintrin.h>
+#if defined(__GNUC__)
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_SSE2
+#define TARGET_AVX2
+#endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define HAVE_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+void (*bestcolfunc)(r_draw_t *)   = R_DrawColumn;
+void (*besttlcolfunc)(r_draw_t *) = R_DrawTLColumn;
+void (*bestspanfunc)(r_draw_t *)  = R_DrawSpan;
+
+//
+// Shared by all implementations.  The texture index of every pixel
+// has been computed into idx[], now do the lookups.
+//
+
+static inline void SpanPixels(pixel_t *dest, const int32_t *idx, int n,
+    const r_draw_t *draw)
+{
+    int i;
+
+    for (i = 0; i < n; i++)
+    {
+        const uint8_t source = draw->ds_source[idx[i]];
+        dest[i]              = draw->ds_colormap[draw->ds_brightmap[source]][source];
+    }
+}
+
+static inline pixel_t *ColumnPixels(pixel_t *dest, const int32_t *idx, int n,
+    const r_draw_t *draw)
+{
+    int i;
+
+    for (i = 0; i < n; i++)
+    {
+        const uint8_t source = draw->dc_source[idx[i]];
+        *dest                = draw->dc_colormap[draw->dc_brightmap[source]][source];
+        dest += SCREENWIDTH;
+    }
+
+    return dest;
+}
+
+static inline pixel_t *TLColumnPixels(pixel_t *dest, const int32_t *idx, int n,
+    const r_draw_t *draw)
+{
+    int i;
+
+    for (i = 0; i < n; i++)
+    {
+#ifndef CRISPY_TRUECOLOR
+        *dest = tranmap[(*dest << 8) + draw->dc_colormap[0][draw->dc_source[idx[i]]]];
+#else
+        *dest = blendfunc(*dest, draw->dc_colormap[0][draw->dc_source[idx[i]]]);
+#endif
+        dest += SCREENWIDTH;
+    }
+
+    return dest;
+}
+
+// The vector drawers only handle the common cases; these decide
+// whether to fall back to the scalar drawer.
+
+static inline bool SpanIsSimple()
+{
+    return !crispy->fliplevels;
+}
+
+static inline bool ColumnIsSimple(const r_draw_t *draw)
+{
+    // non-power-of-2 textures wrap with a loop that cannot be
+    //  vectorized and keep the scalar Tutti-Frutti fix
+    return draw->dc_yl >= 0 && !(draw->dc_texheight & (draw->dc_texheight - 1));
+}
+
+#ifdef HAVE_SIMD_X86
+
+//
+// SSE2, 4 pixels per step.
+//
+
+TARGET_SSE2 static void R_DrawSpanSSE2(r_draw_t *draw)
+{
+    alignas(16) int32_t idx[4];
+    pixel_t            *dest;
+    int                 count;
+
+    if (!SpanIsSimple())
+    {
+        R_DrawSpan(draw);
+        return;
+    }
+
+    dest  = ylookup[draw->ds_y] + columnofs[draw->ds_x1];
+    count = draw->ds_x2 - draw->ds_x1 + 1;
+
+    const uint32_t xfrac = static_cast<uint32_t>(draw->ds_xfrac);
+    const uint32_t yfrac = static_cast<uint32_t>(draw->ds_yfrac);
+    const uint32_t xstep = static_cast<uint32_t>(draw->ds_xstep);
+    const uint32_t ystep = static_cast<uint32_t>(draw->ds_ystep);
+
+    __m128i       x     = _mm_setr_epi32(static_cast<int>(xfrac), static_cast<int>(xfrac + xstep),
+        static_cast<int>(xfrac + 2 * xstep), static_cast<int>(xfrac + 3 * xstep));
+    __m128i       y     = _mm_setr_epi32(static_cast<int>(yfrac), static_cast<int>(yfrac + ystep),
+        static_cast<int>(yfrac + 2 * ystep), static_cast<int>(yfrac + 3 * ystep));
+    const __m128i dx    = _mm_set1_epi32(static_cast<int>(4 * xstep));
+    const __m128i dy    = _mm_set1_epi32(static_cast<int>(4 * ystep));
+    const __m128i xmask = _mm_set1_epi32(0x3f);
+    const __m128i ymask = _mm_set1_epi32(0x0fc0);
+
+    while (count > 0)
+    {
+        const int n = count < 4 ? count : 4;
+
+        // [crispy] fix flats getting more distorted the closer they are to the right
+        const __m128i spot = _mm_or_si128(_mm_and_si128(_mm_srli_epi32(y, 10), ymask),
+            _mm_and_si128(_mm_srli_epi32(x, 16), xmask));
+        _mm_store_si128(reinterpret_cast<__m128i *>(idx), spot);
+
+        SpanPixels(dest, idx, n, draw);
+
+        x = _mm_add_epi32(x, dx);
+        y = _mm_add_epi32(y, dy);
+        dest += n;
+        count -= n;
+    }
+}
+
+// Texture row indices of the next 4 pixels of a column.  The scalar
+// drawers shift the signed frac, so do the same here.
+TARGET_SSE2 static inline __m128i ColumnFracsSSE2(uint32_t frac, uint32_t fracstep)
+{
+    return _mm_setr_epi32(static_cast<int>(frac), static_cast<int>(frac + fracstep),
+        static_cast<int>(frac + 2 * fracstep), static_cast<int>(frac + 3 * fracstep));
+}
+
+TARGET_SSE2 static void R_DrawColumnSSE2(r_draw_t *draw)
+{
+    alignas(16) int32_t idx[4];
+    pixel_t            *dest;
+    int                 count;
+
+    if (!ColumnIsSimple(draw))
+    {
+        R_DrawColumn(draw);
+        return;
+    }
+
+    count = draw->dc_yh - draw->dc_yl + 1;
+
+    if (count <= 0)
+        return;
+
+    dest = ylookup[draw->dc_yl] + columnofs[g_r_state_globals->flipviewwidth[draw->dc_x]];
+
+    const uint32_t fracstep = static_cast<uint32_t>(draw->dc_iscale);
+    const uint32_t frac     = static_cast<uint32_t>(draw->dc_texturemid) + static_cast<uint32_t>(draw->dc_yl - centery) * fracstep;
+
+    __m128i       f     = ColumnFracsSSE2(frac, fracstep);
+    const __m128i df    = _mm_set1_epi32(static_cast<int>(4 * fracstep));
+    const __m128i hmask = _mm_set1_epi32(draw->dc_texheight - 1);
+
+    while (count > 0)
+    {
+        const int n = count < 4 ? count : 4;
+
+        _mm_store_si128(reinterpret_cast<__m128i *>(idx), _mm_and_si128(_mm_srai_epi32(f, FRACBITS), hmask));
+        dest = ColumnPixels(dest, idx, n, draw);
+
+        f = _mm_add_epi32(f, df);
+        count -= n;
+    }
+}
+
+TARGET_SSE2 static void R_DrawTLColumnSSE2(r_draw_t *draw)
+{
+    alignas(16) int32_t idx[4];
+    pixel_t            *dest;
+    int                 count;
+
+    count = draw->dc_yh - draw->dc_yl + 1;
+
+    if (count <= 0)
+        return;
+
+    dest = ylookup[draw->dc_yl] + columnofs[g_r_state_globals->flipviewwidth[draw->dc_x]];
+
+    const uint32_t fracstep = static_cast<uint32_t>(draw->dc_iscale);
+    const uint32_t frac     = static_cast<uint32_t>(draw->dc_texturemid) + static_cast<uint32_t>(draw->dc_yl - centery) * fracstep;
+
+    __m128i       f  = ColumnFracsSSE2(frac, fracstep);
+    const __m128i df = _mm_set1_epi32(static_cast<int>(4 * fracstep));
+
+    while (count > 0)
+    {
+        const int n = count < 4 ? count : 4;
+
+        _mm_store_si128(reinterpret_cast<__m128i *>(idx), _mm_srai_epi32(f, FRACBITS));
+        dest = TLColumnPixels(dest, idx, n, draw);
+
+        f = _mm_add_epi32(f, df);
+        count -= n;
+    }
+}
+
+//
+// AVX2, 8 pixels per step.
+//
+
+TARGET_AVX2 static inline __m256i Lanes8AVX2(uint32_t base, uint32_t step)
+{
+    return _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(base)),
+        _mm256_mullo_epi32(_mm256_set1_epi32(static_cast<int>(step)),
+            _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)));
+}
+
+TARGET_AVX2 static void R_DrawSpanAVX2(r_draw_t *draw)
+{
+    alignas(32) int32_t idx[8];
+    pixel_t            *dest;
+    int                 count;
+
+    if (!SpanIsSimple())
+    {
+        R_DrawSpan(draw);
+        return;
+    }
+
+    dest  = ylookup[draw->ds_y] + columnofs[draw->ds_x1];
+    count = draw->ds_x2 - draw->ds_x1 + 1;
+
+    const uint32_t xstep = static_cast<uint32_t>(draw->ds_xstep);
+    const uint32_t ystep = static_cast<uint32_t>(draw->ds_ystep);
+
+    __m256i       x     = Lanes8AVX2(static_cast<uint32_t>(draw->ds_xfrac), xstep);
+    __m256i       y     = Lanes8AVX2(static_cast<uint32_t>(draw->ds_yfrac), ystep);
+    const __m256i dx    = _mm256_set1_epi32(static_cast<int>(8 * xstep));
+    const __m256i dy    = _mm256_set1_epi32(static_cast<int>(8 * ystep));
+    const __m256i xmask = _mm256_set1_epi32(0x3f);
+    const __m256i ymask = _mm256_set1_epi32(0x0fc0);
+
+    while (count > 0)
+    {
+        const int n = count < 8 ? count : 8;
+
+        // [crispy] fix flats getting more distorted the closer they are to the right
+        const __m256i spot = _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi32(y, 10), ymask),
+            _mm256_and_si256(_mm256_srli_epi32(x, 16), xmask));
+        _mm256_store_si256(reinterpret_cast<__m256i *>(idx), spot);
+
+        SpanPixels(dest, idx, n, draw);
+
+        x = _mm256_add_epi32(x, dx);
+        y = _mm256_add_epi32(y, dy);
+        dest += n;
+        count -= n;
+    }
+}
+
+TARGET_AVX2 static void R_DrawColumnAVX2(r_draw_t *draw)
+{
+    alignas(32) int32_t idx[8];
+    pixel_t            *dest;
+    int                 count;
+
+    if (!ColumnIsSimple(draw))
+    {
+        R_DrawColumn(draw);
+        return;
+    }
+
+    count = draw->dc_yh - draw->dc_yl + 1;
+
+    if (count <= 0)
+        return;
+
+    dest = ylookup[draw->dc_yl] + columnofs[g_r_state_globals->flipviewwidth[draw->dc_x]];
+
+    const uint32_t fracstep = static_cast<uint32_t>(draw->dc_iscale);
+    const uint32_t frac     = static_cast<uint32_t>(draw->dc_texturemid) + static_cast<uint32_t>(draw->dc_yl - centery) * fracstep;
+
+    __m256i       f     = Lanes8AVX2(frac, fracstep);
+    const __m256i df    = _mm256_set1_epi32(static_cast<int>(8 * fracstep));
+    const __m256i hmask = _mm256_set1_epi32(draw->dc_texheight - 1);
+
+    while (count > 0)
+    {
+        const int n = count < 8 ? count : 8;
+
+        _mm256_store_si256(reinterpret_cast<__m256i *>(idx), _mm256_and_si256(_mm256_srai_epi32(f, FRACBITS), hmask));
+        dest = ColumnPixels(dest, idx, n, draw);
+
+        f = _mm256_add_epi32(f, df);
+        count -= n;
+    }
+}
+
+TARGET_AVX2 static void R_DrawTLColumnAVX2(r_draw_t *draw)
+{
+    alignas(32) int32_t idx[8];
+    pixel_t            *dest;
+    int                 count;
+
+    count = draw->dc_yh - draw->dc_yl + 1;
+
+    if (count <= 0)
+        return;
+
+    dest = ylookup[draw->dc_yl] + columnofs[g_r_state_globals->flipviewwidth[draw->dc_x]];
+
+    const uint32_t fracstep = static_cast<uint32_t>(draw->dc_iscale);
+    const uint32_t frac     = static_cast<uint32_t>(draw->dc_texturemid) + static_cast<uint32_t>(draw->dc_yl - centery) * fracstep;
+
+    __m256i       f  = Lanes8AVX2(frac, fracstep);
+    const __m256i df = _mm256_set1_epi32(static_cast<int>(8 * fracstep));
+
+    while (count > 0)
+    {
+        const int n = count < 8 ? count : 8;
+
+        _mm256_store_si256(reinterpret_cast<__m256i *>(idx), _mm256_srai_epi32(f, FRACBITS));
+        dest = TLColumnPixels(dest, idx, n, draw);
+
+        f = _mm256_add_epi32(f, df);
+        count -= n;
+    }
+}
+
+#endif // HAVE_SIMD_X86
+
+#ifdef HAVE_SIMD_NEON
+
+//
+// NEON, 4 pixels per step.
+//
+
+static inline int32x4_t Lanes4NEON(uint32_t base, uint32_t step)
+{
+    const uint32_t lanes[4] = { base, base + step, base + 2 * step, base + 3 * step };
+
+    return vreinterpretq_s32_u32(vld1q_u32(lanes));
+}
+
+static void R_DrawSpanNEON(r_draw_t *draw)
+{
+    int32_t  idx[4];
+    pixel_t *dest;
+    int      count;
+
+    if (!SpanIsSimple())
+    {
+        R_DrawSpan(draw);
+        return;
+    }
+
+    dest  = ylookup[draw->ds_y] + columnofs[draw->ds_x1];
+    count = draw->ds_x2 - draw->ds_x1 + 1;
+
+    const uint32_t xstep = static_cast<uint32_t>(draw->ds_xstep);
+    const uint32_t ystep = static_cast<uint32_t>(draw->ds_ystep);
+
+    uint32x4_t       x     = vreinterpretq_u32_s32(Lanes4NEON(static_cast<uint32_t>(draw->ds_xfrac), xstep));
+    uint32x4_t       y     = vreinterpretq_u32_s32(Lanes4NEON(static_cast<uint32_t>(draw->ds_yfrac), ystep));
+    const uint32x4_t dx    = vdupq_n_u32(4 * xstep);
+    const uint32x4_t dy    = vdupq_n_u32(4 * ystep);
+    const uint32x4_t xmask = vdupq_n_u32(0x3f);
+    const uint32x4_t ymask = vdupq_n_u32(0x0fc0);
+
+    while (count > 0)
+    {
+        const int n = count < 4 ? count : 4;
+
+        // [crispy] fix flats getting more distorted the closer they are to the right
+        const uint32x4_t spot = vorrq_u32(vandq_u32(vshrq_n_u32(y, 10), ymask),
+            vandq_u32(vshrq_n_u32(x, 16), xmask));
+        vst1q_s32(idx, vreinterpretq_s32_u32(spot));
+
+        SpanPixels(dest, idx, n, draw);
+
+        x = vaddq_u32(x, dx);
+        y = vaddq_u32(y, dy);
+        dest += n;
+        count -= n;
+    }
+}
+
+static void R_DrawColumnNEON(r_draw_t *draw)
+{
+    int32_t  idx[4];
+    pixel_t *dest;
+    int      count;
+
+    if (!ColumnIsSimple(draw))
+    {
+        R_DrawColumn(draw);
+        return;
+    }
+
+    count = draw->dc_yh - draw->dc_yl + 1;
+
+    if (count <= 0)
+        return;
+
+    dest = ylookup[draw->dc_yl] + columnofs[g_r_state_globals->flipviewwidth[draw->dc_x]];
+
+    const uint32_t fracstep = static_cast<uint32_t>(draw->dc_iscale);
+    const uint32_t frac     = static_cast<uint32_t>(draw->dc_texturemid) + static_cast<uint32_t>(draw->dc_yl - centery) * fracstep;
+
+    int32x4_t       f     = Lanes4NEON(frac, fracstep);
+    const int32x4_t df    = vdupq_n_s32(static_cast<int32_t>(4 * fracstep));
+    const int32x4_t hmask = vdupq_n_s32(draw->dc_texheight - 1);
+
+    while (count > 0)
+    {
+        const int n = count < 4 ? count : 4;
+
+        vst1q_s32(idx, vandq_s32(vshrq_n_s32(f, FRACBITS), hmask));
+        dest = ColumnPixels(dest, idx, n, draw);
+
+        f = vaddq_s32(f, df);
+        count -= n;
+    }
+}
+
+static void R_DrawTLColumnNEON(r_draw_t *draw)
+{
+    int32_t  idx[4];
+    pixel_t *dest;
+    int      count;
+
+    count = draw->dc_yh - draw->dc_yl + 1;
+
+    if (count <= 0)
+        return;
+
+    dest = ylookup[draw->dc_yl] + columnofs[g_r_state_globals->flipviewwidth[draw->dc_x]];
+
+    const uint32_t fracstep = static_cast<uint32_t>(draw->dc_iscale);
+    const uint32_t frac     = static_cast<uint32_t>(draw->dc_texturemid) + static_cast<uint32_t>(draw->dc_yl - centery) * fracstep;
+
+    int32x4_t       f  = Lanes4NEON(frac, fracstep);
+    const int32x4_t df = vdupq_n_s32(static_cast<int32_t>(4 * fracstep));
+
+    while (count > 0)
+    {
+        const int n = count < 4 ? count : 4;
+
+        vst1q_s32(idx, vshrq_n_s32(f, FRACBITS));
+        dest = TLColumnPixels(dest, idx, n, draw);
+
+        f = vaddq_s32(f, df);
+        count -= n;
+    }
+}
+
+#endif // HAVE_SIMD_NEON
+
+//
+// Fastest first.  simdtest checks each set against the scalar drawers.
+//
+
+#ifdef HAVE_SIMD_X86
+static bool HaveAVX2()
+{
+    return SDL_HasAVX2();
+}
+
+static bool HaveSSE2()
+{
+    return SDL_HasSSE2();
+}
+#endif
+
+#ifdef HAVE_SIMD_NEON
+static bool HaveNEON()
+{
+    return SDL_HasNEON();
+}
+#endif
+
+const simddrawers_t simddrawers[] = {
+#ifdef HAVE_SIMD_X86
+    { "AVX2", HaveAVX2, R_DrawColumnAVX2, R_DrawTLColumnAVX2, R_DrawSpanAVX2 },
+    { "SSE2", HaveSSE2, R_DrawColumnSSE2, R_DrawTLColumnSSE2, R_DrawSpanSSE2 },
+#endif
+#ifdef HAVE_SIMD_NEON
+    { "NEON", HaveNEON, R_DrawColumnNEON, R_DrawTLColumnNEON, R_DrawSpanNEON },
+#endif
+    { nullptr, nullptr, nullptr, nullptr, nullptr },
+};
+
+//
+// R_InitDrawers
+//
+void R_InitDrawers()
+{
+    bestcolfunc   = R_DrawColumn;
+    besttlcolfunc = R_DrawTLColumn;
+    bestspanfunc  = R_DrawSpan;
+
+    //!
+    // @category video
+    //
+    // Do not use the SIMD column and span drawers.
+    //
+
+    if (M_ParmExists("-nosimd"))
+    {
+        return;
+    }
+
+    for (const simddrawers_t *drawers = simddrawers; drawers->name != nullptr; drawers++)
+    {
+        if (drawers->supported())
+        {
+            bestcolfunc   = drawers->colfunc;
+            besttlcolfunc = drawers->tlcolfunc;
+            bestspanfunc  = drawers->spanfunc;
+
+            printf("R_InitDrawers: Using %s drawers.\n", drawers->name);
+            return;
+        }
+    }
+}
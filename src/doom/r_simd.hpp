@@ -0,0 +1,47 @@
+//
+// Copyright(C) 1993-1996 Id Software, Inc.
+// Copyright(C) 2005-2014 Simon Howard
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//	SIMD column and span drawers, selected at startup.
+//
+
+
+#ifndef __R_SIMD__
+#define __R_SIMD__
+
+struct r_draw_t;
+
+// Fastest high detail drawers this CPU supports.  These default to
+// the scalar R_DrawColumn() etc. until R_InitDrawers() is called.
+extern void (*bestcolfunc)(r_draw_t *);
+extern void (*besttlcolfunc)(r_draw_t *);
+extern void (*bestspanfunc)(r_draw_t *);
+
+// A set of vector drawers, and whether this CPU can run them.
+struct simddrawers_t
+{
+    const char *name;
+    bool      (*supported)();
+    void      (*colfunc)(r_draw_t *);
+    void      (*tlcolfunc)(r_draw_t *);
+    void      (*spanfunc)(r_draw_t *);
+};
+
+// Fastest first, ending with a null name.
+extern const simddrawers_t simddrawers[];
+
+// Pick the first set of drawers this CPU supports.
+void R_InitDrawers();
+
+#endif
@@ -432,7 +432,7 @@ void R_DrawMaskedColumn(column_t *column)
 
             // Drawn by either R_DrawColumn
             //  or (SHADOW) R_DrawFuzzColumn.
-            colfunc();
+            colfunc(g_r_draw_globals);
         }
         uint8_t *col_ptr = reinterpret_cast<uint8_t *>(column) + column->length + 4;
         column = reinterpret_cast<column_t *>(col_ptr);
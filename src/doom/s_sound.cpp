@@ -246,7 +246,8 @@ void S_Init(int sfxVolume_param, int musicVolume_param)
         I_SetOPLDriverVer(opl_doom_1_9);
     }
 
-    I_PrecacheSounds(S_sfx, NUMSFX);
+    // [crispy] the sound effects are precached by the startup task
+    // graph before this, see D_DoomMain()
 
     S_SetSfxVolume(sfxVolume_param);
     S_SetMusicVolume(musicVolume_param);
@@ -2156,65 +2156,49 @@ static bool IsMid(uint8_t *mem, int len)
     return len > 4 && !memcmp(mem, "MThd", 4);
 }
 
-static bool ConvertMus(uint8_t *musdata, int len, char *filename)
-{
-    void *   outbuf = nullptr;
-    size_t   outbuf_len = 0;
-
-    MEMFILE *instream  = mem_fopen_read(musdata, static_cast<size_t>(len));
-    MEMFILE *outstream = mem_fopen_write();
-
-    int result = mus2mid(instream, outstream);
-
-    if (result == 0)
-    {
-        mem_get_buf(outstream, &outbuf, &outbuf_len);
-
-        M_WriteFile(filename, outbuf, static_cast<int>(outbuf_len));
-    }
-
-    mem_fclose(instream);
-    mem_fclose(outstream);
-
-    return result;
-}
-
 static void *I_OPL_RegisterSong(void *data, int len)
 {
+    midi_file_t *result;
+
     if (!music_initialized)
     {
         return nullptr;
     }
 
-    // MUS files begin with "MUS"
-    // Reject anything which doesnt have this signature
-
-    char *filename = M_TempFile("doom.mid");
-
     // [crispy] remove MID file size limit
     if (IsMid(static_cast<uint8_t *>(data), len) /* && len < MAXMIDLENGTH */)
     {
-        M_WriteFile(filename, data, len);
+        result = MIDI_LoadMemory(data, static_cast<size_t>(len));
     }
     else
     {
-        // Assume a MUS file and try to convert
+        // Assume a MUS file and try to convert.  The MIDI is parsed
+        // straight out of the conversion buffer, without a round trip
+        // through a temporary file.
 
-        ConvertMus(static_cast<uint8_t *>(data), len, filename);
-    }
+        MEMFILE *instream  = mem_fopen_read(data, static_cast<size_t>(len));
+        MEMFILE *outstream = mem_fopen_write();
+
+        result = nullptr;
+
+        if (mus2mid(instream, outstream) == 0)
+        {
+            void * outbuf;
+            size_t outbuf_len;
+
+            mem_get_buf(outstream, &outbuf, &outbuf_len);
+            result = MIDI_LoadMemory(outbuf, outbuf_len);
+        }
 
-    midi_file_t *result = MIDI_LoadFile(filename);
+        mem_fclose(instream);
+        mem_fclose(outstream);
+    }
 
     if (result == nullptr)
     {
         fprintf(stderr, "I_OPL_RegisterSong: Failed to load MID.\n");
     }
 
-    // remove file now
-
-    remove(filename);
-    free(filename);
-
     return result;
 }
 
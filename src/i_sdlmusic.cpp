@@ -50,6 +50,12 @@ char *timidity_cfg_path = const_cast<char *>("");
 
 static char *temp_timidity_cfg = nullptr;
 
+// MIDI converted from the MUS lump of the registered song, which
+// SDL_mixer plays from memory.  Only one song is registered at a time.
+
+static MEMFILE *  converted_midi       = nullptr;
+static Mix_Music *converted_midi_music = nullptr;
+
 // If the temp_timidity_cfg config variable is set, generate a "wrapper"
 // config file for Timidity to point to the actual config file. This
 // is needed to inject a "dir" command so that the patches are read
@@ -351,6 +357,13 @@ static void I_SDL_UnRegisterSong(void *handle)
         {
             Mix_FreeMusic(music);
         }
+
+        if (music == converted_midi_music && converted_midi != nullptr)
+        {
+            mem_fclose(converted_midi);
+            converted_midi       = nullptr;
+            converted_midi_music = nullptr;
+        }
     }
 }
 
@@ -364,12 +377,13 @@ static bool IsMid(byte *mem, int len)
 }
 */
 
-static bool ConvertMus(uint8_t *musdata, int len, const char *filename)
+// Convert a MUS lump to MIDI.  Returns a stream holding the MIDI data,
+// or nullptr if the conversion failed.
+
+static MEMFILE *ConvertMus(uint8_t *musdata, int len)
 {
     MEMFILE *instream;
     MEMFILE *outstream;
-    void *   outbuf;
-    size_t   outbuf_len;
     int      result;
 
     instream  = mem_fopen_read(musdata, static_cast<size_t>(len));
@@ -377,54 +391,28 @@ static bool ConvertMus(uint8_t *musdata, int len, const char *filename)
 
     result = mus2mid(instream, outstream);
 
-    if (result == 0)
-    {
-        mem_get_buf(outstream, &outbuf, &outbuf_len);
+    mem_fclose(instream);
 
-        M_WriteFile(filename, outbuf, static_cast<int>(outbuf_len));
+    if (result != 0)
+    {
+        mem_fclose(outstream);
+        return nullptr;
     }
 
-    mem_fclose(instream);
-    mem_fclose(outstream);
-
-    return result;
+    return outstream;
 }
 
-static void *I_SDL_RegisterSong(void *data, int len)
+// Load a song through a temporary file, for the players that can only
+// be given a file name.
+
+static Mix_Music *RegisterSongFile(void *data, size_t len)
 {
     char *     filename;
     Mix_Music *music;
 
-    if (!music_initialized)
-    {
-        return nullptr;
-    }
-
-    // MUS files begin with "MUS"
-    // Reject anything which doesnt have this signature
-
     filename = M_TempFile("doom"); // [crispy] generic filename
 
-    // [crispy] Reverse Choco's logic from "if (MIDI)" to "if (not MUS)"
-    // MUS is the only format that requires conversion,
-    // let SDL_Mixer figure out the others
-    /*
-    if (IsMid(data, len) && len < MAXMIDLENGTH)
-*/
-    if (len < 4 || memcmp(data, "MUS\x1a", 4)) // [crispy] MUS_HEADER_MAGIC
-    {
-        M_WriteFile(filename, data, len);
-    }
-    else
-    {
-        // Assume a MUS file and try to convert
-
-        ConvertMus(static_cast<uint8_t *>(data), len, filename);
-    }
-
-    // Load the MIDI. In an ideal world we'd be using Mix_LoadMUS_RW()
-    // by now, but Mix_SetMusicCMD() only works with Mix_LoadMUS(), so
-    // we have to generate a temporary file.
+    M_WriteFile(filename, data, static_cast<int>(len));
 
 #if defined(_WIN32)
     // [AM] If we do not have an external music command defined, play
@@ -441,25 +429,99 @@ static void *I_SDL_RegisterSong(void *data, int len)
     else
 #endif
     {
+        // Mix_SetMusicCMD() only works with Mix_LoadMUS().  The external
+        // program plays the file itself, so we can't delete it and
+        // leave a mess on disk :(
+
         music = Mix_LoadMUS(filename);
         if (music == nullptr)
         {
             // Failed to load
             fprintf(stderr, "Error loading midi: %s\n", Mix_GetError());
         }
+    }
+
+    free(filename);
 
-        // Remove the temporary MIDI file; however, when using an external
-        // MIDI program we can't delete the file. Otherwise, the program
-        // won't find the file to play. This means we leave a mess on
-        // disk :(
+    return music;
+}
 
-        if (strlen(g_i_sound_globals->snd_musiccmd) == 0)
+static void *I_SDL_RegisterSong(void *data, int len)
+{
+    void *     songdata;
+    size_t     songlen;
+    MEMFILE *  midi;
+    Mix_Music *music;
+
+    if (!music_initialized)
+    {
+        return nullptr;
+    }
+
+    songdata = data;
+    songlen  = static_cast<size_t>(len);
+    midi     = nullptr;
+
+    // [crispy] Reverse Choco's logic from "if (MIDI)" to "if (not MUS)"
+    // MUS is the only format that requires conversion,
+    // let SDL_Mixer figure out the others
+    /*
+    if (IsMid(data, len) && len < MAXMIDLENGTH)
+*/
+    if (len >= 4 && !memcmp(data, "MUS\x1a", 4)) // [crispy] MUS_HEADER_MAGIC
+    {
+        midi = ConvertMus(static_cast<uint8_t *>(data), len);
+
+        if (midi == nullptr)
         {
-            remove(filename);
+            fprintf(stderr, "Error loading midi: %s\n",
+                "Failed to convert MUS to MIDI.");
+            return nullptr;
         }
+
+        mem_get_buf(midi, &songdata, &songlen);
     }
 
-    free(filename);
+    if (strlen(g_i_sound_globals->snd_musiccmd) > 0
+#if defined(_WIN32)
+        || midi_server_initialized
+#endif
+    )
+    {
+        music = RegisterSongFile(songdata, songlen);
+
+        if (midi != nullptr)
+        {
+            mem_fclose(midi);
+        }
+
+        return music;
+    }
+
+    // Otherwise SDL_mixer reads the song straight from memory.  It may
+    // keep reading while the song plays, so the lump stays cached until
+    // the song is unregistered, and so must the converted MIDI.
+
+    music = Mix_LoadMUS_RW(SDL_RWFromConstMem(songdata, static_cast<int>(songlen)), SDL_TRUE);
+
+    if (music == nullptr)
+    {
+        // Failed to load
+        fprintf(stderr, "Error loading midi: %s\n", Mix_GetError());
+    }
+
+    if (midi != nullptr)
+    {
+        if (music != nullptr)
+        {
+            converted_midi       = midi;
+            converted_midi_music = music;
+        }
+        else
+        {
+            mem_fclose(midi);
+        }
+    }
 
     return music;
 }
@@ -35,7 +35,10 @@
 #include "i_sound.hpp"
 #include "i_system.hpp"
 #include "i_swap.hpp"
+#include "m_argv.hpp"
+#include "m_config.hpp"
 #include "m_misc.hpp"
+#include "sha1.hpp"
 #include "w_wad.hpp"
 #include "z_zone.hpp"
 
@@ -77,6 +80,14 @@ static allocated_sound_t *allocated_sounds_head = nullptr;
 static allocated_sound_t *allocated_sounds_tail = nullptr;
 static int                allocated_sounds_size = 0;
 
+// [crispy] Sounds converted by I_SDL_ConvertSounds(), indexed like
+// precache_sounds.  They are kept out of the list above until
+// I_SDL_ReleaseSounds(), so that the conversion can run on several
+// threads.  nullptr when not precaching.
+
+static sfxinfo_t          *precache_sounds;
+static allocated_sound_t **precache_converted;
+
 // [crispy] values 3 and higher might reproduce DOOM.EXE more accurately,
 // but 1 is closer to "use_libsamplerate = 0" which is the default in Choco
 // and causes only a short delay at startup
@@ -200,26 +211,42 @@ static allocated_sound_t *AllocateSound(sfxinfo_t *sfxinfo, size_t len)
 {
     allocated_sound_t *snd = nullptr;
 
-    // Keep allocated sounds within the cache size.
-
-    ReserveCacheSpace(len);
+    // [crispy] Precaching: set aside, see I_SDL_ReleaseSounds().
 
-    // Allocate the sound structure and data.  The data will immediately
-    // follow the structure, which acts as a header.
-
-    do
+    if (precache_converted != nullptr)
     {
         snd = static_cast<allocated_sound_t *>(malloc(sizeof(allocated_sound_t) + len));
 
-        // Out of memory?  Try to free an old sound, then loop round
-        // and try again.
-
-        if (snd == nullptr && !FindAndFreeSound())
+        if (snd == nullptr)
         {
             return nullptr;
         }
 
-    } while (snd == nullptr);
+        precache_converted[sfxinfo - precache_sounds] = snd;
+    }
+    else
+    {
+        // Keep allocated sounds within the cache size.
+
+        ReserveCacheSpace(len);
+
+        // Allocate the sound structure and data.  The data will immediately
+        // follow the structure, which acts as a header.
+
+        do
+        {
+            snd = static_cast<allocated_sound_t *>(malloc(sizeof(allocated_sound_t) + len));
+
+            // Out of memory?  Try to free an old sound, then loop round
+            // and try again.
+
+            if (snd == nullptr && !FindAndFreeSound())
+            {
+                return nullptr;
+            }
+
+        } while (snd == nullptr);
+    }
 
     // Skip past the chunk structure for the audio buffer
 
@@ -232,15 +259,19 @@ static allocated_sound_t *AllocateSound(sfxinfo_t *sfxinfo, size_t len)
     snd->sfxinfo   = sfxinfo;
     snd->use_count = 0;
 
-    // Keep track of how much memory all these cached sounds are using...
+    if (precache_converted == nullptr)
+    {
+        // Keep track of how much memory all these cached sounds are using...
 
-    allocated_sounds_size += static_cast<int>(len);
+        allocated_sounds_size += static_cast<int>(len);
 
-    AllocatedSoundLink(snd);
+        AllocatedSoundLink(snd);
+    }
 
     return snd;
 }
 
+
 // Lock a sound, to indicate that it may not be freed.
 
 static void LockAllocatedSound(allocated_sound_t *snd)
@@ -293,6 +324,18 @@ static allocated_sound_t *GetAllocatedSoundBySfxInfoAndPitch(sfxinfo_t *sfxinfo,
     return nullptr;
 }
 
+// [crispy] The normal pitch sound just converted for sfxinfo.
+
+static allocated_sound_t *ConvertedSound(sfxinfo_t *sfxinfo)
+{
+    if (precache_converted != nullptr)
+    {
+        return precache_converted[sfxinfo - precache_sounds];
+    }
+
+    return GetAllocatedSoundBySfxInfoAndPitch(sfxinfo, NORM_PITCH);
+}
+
 // Allocate a new sound chunk and pitch-shift an existing sound up-or-down
 // into it.
 
@@ -331,6 +374,395 @@ static allocated_sound_t *PitchShift(allocated_sound_t *insnd, int pitch)
     return outsnd;
 }
 
+//
+// [crispy] Sound effect mixer.
+// With the usual 16-bit stereo output, sound effects don't go through
+// SDL_mixer's channels but are mixed in a post effect, on top of the
+// music.  SDL_mixer has a single post-mix hook, which the OPL music
+// takes, while any number of post effects can be registered.  The game
+// thread never takes the audio lock, nor waits for the audio thread:
+// sounds to start go through a single producer, single consumer ring,
+// while stops and volume changes are per-channel atomics of which the
+// audio thread only needs the latest value.  The audio thread reports
+// back which sounds it has let go of.  Pitch shifting steps through the
+// sound at a fixed-point rate instead of making a shifted copy of it.
+//
+
+#define SFXRINGSIZE   256  // sounds to start, a power of two
+#define SFXMIXSAMPLES 1024 // mixed at a time, left and right count as two
+
+// A sound to start
+
+struct sfxcmd_t
+{
+    int           channel;
+    unsigned int  generation;
+    const Sint16 *data;
+    Uint32        frames;
+    Uint32        step;
+    int           left; // 0-256
+    int           right;
+};
+
+struct sfxvoice_t
+{
+    const Sint16 *data; // nullptr if idle
+    Uint32        frames;
+    uint64_t      pos;  // in frames, 16.16 fixed point
+    Uint32        step; // added to pos for every output frame
+    int           left;
+    int           right;
+    unsigned int  generation;
+};
+
+// A sound stopped by the game thread that the audio thread may still be
+// reading, kept locked until it lets go of it.
+
+struct sfxretired_t
+{
+    allocated_sound_t *snd;
+    int                channel;
+    unsigned int       generation;
+};
+
+static bool         sfxmixer;
+static sfxcmd_t     sfxring[SFXRINGSIZE];
+static SDL_atomic_t sfxring_head; // written by the game thread only
+static SDL_atomic_t sfxring_tail; // written by the audio thread only
+
+// Counted up by the game thread for every sound started on a channel.
+// The game thread sets sfxstopped to the generation of a sound it stops
+// and sfxparams to the volumes of the latest, see SfxPackParams().  The
+// audio thread sets sfxreleased once it has let go of all sounds up to
+// a generation.
+
+static unsigned int sfxgeneration[NUM_CHANNELS];
+static SDL_atomic_t sfxstopped[NUM_CHANNELS];
+static SDL_atomic_t sfxparams[NUM_CHANNELS];
+static SDL_atomic_t sfxreleased[NUM_CHANNELS];
+
+static sfxretired_t *sfxretired;
+static int           numsfxretired;
+static int           maxsfxretired;
+
+// Audio thread only.
+
+static sfxvoice_t sfxvoices[NUM_CHANNELS];
+static int32_t    sfxmixbuf[SFXMIXSAMPLES];
+
+// Returns false if the ring is full, which takes the audio thread not
+// running for a good while; the sound is dropped rather than waited for.
+
+static bool SfxQueue(const sfxcmd_t *cmd)
+{
+    auto head = static_cast<unsigned int>(SDL_AtomicGet(&sfxring_head));
+
+    if (head - static_cast<unsigned int>(SDL_AtomicGet(&sfxring_tail)) >= SFXRINGSIZE)
+    {
+        return false;
+    }
+
+    sfxring[head & (SFXRINGSIZE - 1)] = *cmd;
+    SDL_AtomicSet(&sfxring_head, static_cast<int>(head + 1));
+
+    return true;
+}
+
+// Volumes go in one atomic along with the low bits of the generation
+// they are meant for, so that a change for a sound that has since been
+// replaced is ignored.
+
+#define SFXPARAMS_GENSHIFT 18
+
+static int SfxPackParams(unsigned int generation, int left, int right)
+{
+    return static_cast<int>(static_cast<unsigned int>(left)
+                            | (static_cast<unsigned int>(right) << 9)
+                            | (generation << SFXPARAMS_GENSHIFT));
+}
+
+// Mix_SetPanning() style volumes, 255 being scaled up to 256 for shifts.
+
+static void SfxVolumes(int vol, int sep, int *left, int *right)
+{
+    *left  = ((254 - sep) * vol) / 127;
+    *right = ((sep)*vol) / 127;
+
+    *left  = *left < 0 ? 0 : *left > 255 ? 255 : *left;
+    *right = *right < 0 ? 0 : *right > 255 ? 255 : *right;
+
+    *left += *left >> 7;
+    *right += *right >> 7;
+}
+
+// The rate of PitchShift(): a sound at pitch p plays for
+// 2 - p / NORM_PITCH times as long.
+
+static Uint32 SfxPitchStep(int pitch)
+{
+    int length = 2 * NORM_PITCH - pitch;
+
+    if (length <= 0)
+    {
+        length = 1;
+    }
+
+    return static_cast<Uint32>((static_cast<uint64_t>(NORM_PITCH) << 16) / static_cast<unsigned int>(length));
+}
+
+static void SfxRelease(int channel, unsigned int generation)
+{
+    SDL_AtomicSet(&sfxreleased[channel], static_cast<int>(generation));
+}
+
+static void SfxStartVoice(const sfxcmd_t *cmd)
+{
+    sfxvoice_t *voice   = &sfxvoices[cmd->channel];
+    auto        stopped = static_cast<unsigned int>(SDL_AtomicGet(&sfxstopped[cmd->channel]));
+
+    voice->generation = cmd->generation;
+
+    // Stopped again already?
+
+    if (static_cast<int>(stopped - cmd->generation) >= 0)
+    {
+        voice->data = nullptr;
+        SfxRelease(cmd->channel, cmd->generation);
+        return;
+    }
+
+    voice->data   = cmd->data;
+    voice->frames = cmd->frames;
+    voice->pos    = 0;
+    voice->step   = cmd->step;
+    voice->left   = cmd->left;
+    voice->right  = cmd->right;
+    SfxRelease(cmd->channel, cmd->generation - 1);
+}
+
+// Pick up the latest stop and volumes of a channel's sound.
+
+static void SfxUpdateVoice(int channel)
+{
+    sfxvoice_t *voice   = &sfxvoices[channel];
+    auto        stopped = static_cast<unsigned int>(SDL_AtomicGet(&sfxstopped[channel]));
+    auto        params  = static_cast<unsigned int>(SDL_AtomicGet(&sfxparams[channel]));
+
+    if (static_cast<int>(stopped - voice->generation) >= 0)
+    {
+        voice->data = nullptr;
+        SfxRelease(channel, voice->generation);
+        return;
+    }
+
+    if ((params >> SFXPARAMS_GENSHIFT) == ((voice->generation << SFXPARAMS_GENSHIFT) >> SFXPARAMS_GENSHIFT))
+    {
+        voice->left  = params & 0x1ff;
+        voice->right = (params >> 9) & 0x1ff;
+    }
+}
+
+// Add frames at the normal pitch, the common case.
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+
+static void SfxMixFrames(int32_t *acc, const Sint16 *src, int frames, int left, int right)
+{
+    const __m128i vol = _mm_set_epi16(static_cast<short>(right), static_cast<short>(left),
+        static_cast<short>(right), static_cast<short>(left),
+        static_cast<short>(right), static_cast<short>(left),
+        static_cast<short>(right), static_cast<short>(left));
+    int n = frames * 2;
+    int i;
+
+    for (i = 0; i + 8 <= n; i += 8)
+    {
+        __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        __m128i lo      = _mm_mullo_epi16(samples, vol);
+        __m128i hi      = _mm_mulhi_epi16(samples, vol);
+        __m128i *a      = reinterpret_cast<__m128i *>(acc + i);
+
+        _mm_storeu_si128(a, _mm_add_epi32(_mm_loadu_si128(a), _mm_unpacklo_epi16(lo, hi)));
+        _mm_storeu_si128(a + 1, _mm_add_epi32(_mm_loadu_si128(a + 1), _mm_unpackhi_epi16(lo, hi)));
+    }
+
+    for (; i < n; i += 2)
+    {
+        acc[i] += src[i] * left;
+        acc[i + 1] += src[i + 1] * right;
+    }
+}
+
+// Add the mixed sound effects to the stream, saturating.
+
+static void SfxMixOut(Sint16 *out, const int32_t *acc, int n)
+{
+    int i;
+
+    for (i = 0; i + 8 <= n; i += 8)
+    {
+        __m128i a0 = _mm_srai_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(acc + i)), 8);
+        __m128i a1 = _mm_srai_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(acc + i + 4)), 8);
+        __m128i *o = reinterpret_cast<__m128i *>(out + i);
+
+        _mm_storeu_si128(o, _mm_adds_epi16(_mm_loadu_si128(o), _mm_packs_epi32(a0, a1)));
+    }
+
+    for (; i < n; i++)
+    {
+        int sample = out[i] + (acc[i] >> 8);
+
+        out[i] = static_cast<Sint16>(sample < -32768 ? -32768 : sample > 32767 ? 32767 : sample);
+    }
+}
+
+#else
+
+static void SfxMixFrames(int32_t *acc, const Sint16 *src, int frames, int left, int right)
+{
+    for (int i = 0; i < frames * 2; i += 2)
+    {
+        acc[i] += src[i] * left;
+        acc[i + 1] += src[i + 1] * right;
+    }
+}
+
+static void SfxMixOut(Sint16 *out, const int32_t *acc, int n)
+{
+    for (int i = 0; i < n; i++)
+    {
+        int sample = out[i] + (acc[i] >> 8);
+
+        out[i] = static_cast<Sint16>(sample < -32768 ? -32768 : sample > 32767 ? 32767 : sample);
+    }
+}
+
+#endif
+
+static void SfxMixVoice(int channel, int32_t *acc, int frames)
+{
+    sfxvoice_t *voice = &sfxvoices[channel];
+
+    if (voice->step == 1 << 16)
+    {
+        auto pos = static_cast<Uint32>(voice->pos >> 16);
+        int  n   = voice->frames - pos < static_cast<Uint32>(frames) ? static_cast<int>(voice->frames - pos) : frames;
+
+        SfxMixFrames(acc, voice->data + 2 * pos, n, voice->left, voice->right);
+        voice->pos += static_cast<uint64_t>(n) << 16;
+    }
+    else
+    {
+        for (int i = 0; i < frames; i++)
+        {
+            auto pos = static_cast<Uint32>(voice->pos >> 16);
+
+            if (pos >= voice->frames)
+            {
+                break;
+            }
+
+            acc[2 * i] += voice->data[2 * pos] * voice->left;
+            acc[2 * i + 1] += voice->data[2 * pos + 1] * voice->right;
+            voice->pos += voice->step;
+        }
+    }
+
+    if ((voice->pos >> 16) >= voice->frames)
+    {
+        voice->data = nullptr;
+        SfxRelease(channel, voice->generation);
+    }
+}
+
+static void SfxMixEffect(int, void *stream, int len, void *)
+{
+    auto  tail    = static_cast<unsigned int>(SDL_AtomicGet(&sfxring_tail));
+    auto  head    = static_cast<unsigned int>(SDL_AtomicGet(&sfxring_head));
+    auto *out     = reinterpret_cast<Sint16 *>(stream);
+    int   samples = len / static_cast<int>(sizeof(Sint16));
+
+    for (; tail != head; tail++)
+    {
+        SfxStartVoice(&sfxring[tail & (SFXRINGSIZE - 1)]);
+    }
+
+    SDL_AtomicSet(&sfxring_tail, static_cast<int>(tail));
+
+    for (int i = 0; i < NUM_CHANNELS; i++)
+    {
+        if (sfxvoices[i].data != nullptr)
+        {
+            SfxUpdateVoice(i);
+        }
+    }
+
+    while (samples > 0)
+    {
+        int  n      = samples < SFXMIXSAMPLES ? samples : SFXMIXSAMPLES;
+        bool active = false;
+
+        memset(sfxmixbuf, 0, static_cast<size_t>(n) * sizeof(*sfxmixbuf));
+
+        for (int i = 0; i < NUM_CHANNELS; i++)
+        {
+            if (sfxvoices[i].data != nullptr)
+            {
+                SfxMixVoice(i, sfxmixbuf, n / 2);
+                active = true;
+            }
+        }
+
+        if (active)
+        {
+            SfxMixOut(out, sfxmixbuf, n);
+        }
+
+        out += n;
+        samples -= n;
+    }
+}
+
+// Unlock the stopped sounds that the audio thread is done with.
+
+static void SfxUnlockRetired()
+{
+    int i = 0;
+
+    while (i < numsfxretired)
+    {
+        const sfxretired_t *r        = &sfxretired[i];
+        auto                released = static_cast<unsigned int>(SDL_AtomicGet(&sfxreleased[r->channel]));
+
+        if (static_cast<int>(released - r->generation) >= 0)
+        {
+            UnlockAllocatedSound(r->snd);
+            sfxretired[i] = sfxretired[--numsfxretired];
+        }
+        else
+        {
+            i++;
+        }
+    }
+}
+
+static void SfxStop(int channel, allocated_sound_t *snd)
+{
+    SDL_AtomicSet(&sfxstopped[channel], static_cast<int>(sfxgeneration[channel]));
+
+    if (numsfxretired == maxsfxretired)
+    {
+        maxsfxretired = maxsfxretired ? 2 * maxsfxretired : NUM_CHANNELS;
+        sfxretired    = static_cast<sfxretired_t *>(I_Realloc(sfxretired, static_cast<size_t>(maxsfxretired) * sizeof(*sfxretired)));
+    }
+
+    sfxretired[numsfxretired].snd        = snd;
+    sfxretired[numsfxretired].channel    = channel;
+    sfxretired[numsfxretired].generation = sfxgeneration[channel];
+    numsfxretired++;
+}
+
 // When a sound stops, check if it is still playing.  If it is not,
 // we can mark the sound data as CACHE to be freed back for other
 // means.
@@ -339,6 +771,18 @@ static void ReleaseSoundOnChannel(int channel)
 {
     allocated_sound_t *snd = channels_playing[channel];
 
+    // [crispy] unlocked once the mixer is done with it
+    if (sfxmixer)
+    {
+        if (snd != nullptr)
+        {
+            channels_playing[channel] = nullptr;
+            SfxStop(channel, snd);
+        }
+
+        return;
+    }
+
     Mix_HaltChannel(channel);
 
     if (snd == nullptr)
@@ -395,7 +839,7 @@ static int SRC_ConversionMode()
 // DWF 2008-02-10 with cleanups by Simon Howard.
 
 static bool ExpandSoundData_SRC(sfxinfo_t *sfxinfo,
-    byte *                                    data,
+    uint8_t *                                 data,
     int                                       samplerate,
     int                                       bits,
     int                                       length)
@@ -713,21 +1157,15 @@ static bool ExpandSoundData_SDL(sfxinfo_t *sfxinfo, uint8_t *data,
     return true;
 }
 
-// Load and convert a sound effect
+// Convert a sound effect from its lump data
 // Returns true if successful
 
-static bool CacheSFX(sfxinfo_t *sfxinfo)
+static bool ExpandSFX(sfxinfo_t *sfxinfo, uint8_t *data, size_t lumplen)
 {
     int          samplerate = 0;
     unsigned int bits = 0;
     unsigned int length = 0;
 
-    // need to load the sound
-
-    int lumpnum    = sfxinfo->lumpnum;
-    auto *data = cache_lump_num<uint8_t *>(lumpnum, PU_STATIC);
-    size_t lumplen = W_LumpLength(lumpnum);
-
     // [crispy] Check if this is a valid RIFF wav file
     if (lumplen > 44 && memcmp(data, "RIFF", 4) == 0 && memcmp(data + 8, "WAVEfmt ", 8) == 0)
     {
@@ -815,16 +1253,30 @@ static bool CacheSFX(sfxinfo_t *sfxinfo)
 
         M_snprintf(filename, sizeof(filename), "%s.wav",
             DEH_String(sfxinfo->name));
-        snd = GetAllocatedSoundBySfxInfoAndPitch(sfxinfo, NORM_PITCH);
+        snd = ConvertedSound(sfxinfo);
         WriteWAV(filename, snd->chunk.abuf, snd->chunk.alen, mixer_freq);
     }
 #endif
 
+    return true;
+}
+
+// Load and convert a sound effect
+// Returns true if successful
+
+static bool CacheSFX(sfxinfo_t *sfxinfo)
+{
+    // need to load the sound
+
+    int   lumpnum = sfxinfo->lumpnum;
+    auto *data    = cache_lump_num<uint8_t *>(lumpnum, PU_STATIC);
+    bool  result  = ExpandSFX(sfxinfo, data, W_LumpLength(lumpnum));
+
     // don't need the original lump any more
 
     W_ReleaseLumpNum(lumpnum);
 
-    return true;
+    return result;
 }
 
 static void GetSfxLumpName(sfxinfo_t *sfx, char *buf, size_t buf_len)
@@ -852,8 +1304,135 @@ static void GetSfxLumpName(sfxinfo_t *sfx, char *buf, size_t buf_len)
 #ifdef HAVE_LIBSAMPLERATE
 
 // Preload all the sound effects - stops nasty ingame freezes
+// [crispy] This is done in three steps, so that the conversion, which
+// takes most of the time, can run on other threads during startup.
+// Loading and releasing the lumps goes through the zone and must be
+// left to the main thread.
 
-static void I_SDL_PrecacheSounds(sfxinfo_t *sounds, int num_sounds)
+static uint8_t    **precache_data;
+static int          precache_numsounds;
+static SDL_atomic_t precache_next;
+
+// [crispy] Converted sounds are also saved to configdir, keyed by the
+// lump data and the output format, so that later runs can skip the
+// resampling.  nullptr if disabled.
+
+#define SFXCACHEMAGIC   "SFXC"
+#define SFXCACHEVERSION 1
+
+static char *sfxcache_dir;
+
+static char *SfxCacheFile(const uint8_t *data, size_t lumplen)
+{
+    sha1_context_t context;
+    sha1_digest_t  digest;
+    char           hex[sizeof(digest) * 2 + 1];
+
+    SHA1_Init(&context);
+    SHA1_UpdateInt32(&context, SFXCACHEVERSION);
+    SHA1_UpdateInt32(&context, static_cast<unsigned int>(mixer_freq));
+    SHA1_UpdateInt32(&context, mixer_format);
+    SHA1_UpdateInt32(&context, static_cast<unsigned int>(mixer_channels));
+    SHA1_UpdateInt32(&context, static_cast<unsigned int>(use_libsamplerate));
+    SHA1_Update(&context, reinterpret_cast<uint8_t *>(&libsamplerate_scale), sizeof(libsamplerate_scale));
+    SHA1_Update(&context, const_cast<uint8_t *>(data), lumplen);
+    SHA1_Final(digest, &context);
+
+    for (size_t i = 0; i < sizeof(digest); i++)
+    {
+        M_snprintf(hex + i * 2, 3, "%02x", digest[i]);
+    }
+
+    return M_StringJoin(sfxcache_dir, hex, ".pcm", nullptr);
+}
+
+static bool ReadSfxCache(sfxinfo_t *sfxinfo, const char *filename)
+{
+    FILE *             file = fopen(filename, "rb");
+    allocated_sound_t *snd;
+    uint8_t            header[8];
+    Uint32             len;
+
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    if (fread(header, 1, sizeof(header), file) != sizeof(header)
+        || memcmp(header, SFXCACHEMAGIC, 4) != 0)
+    {
+        fclose(file);
+        return false;
+    }
+
+    len = header[4] | (header[5] << 8) | (header[6] << 16) | (static_cast<Uint32>(header[7]) << 24);
+    snd = AllocateSound(sfxinfo, len);
+
+    if (snd == nullptr || fread(snd->chunk.abuf, 1, len, file) != len)
+    {
+        precache_converted[sfxinfo - precache_sounds] = nullptr;
+        free(snd);
+        fclose(file);
+        return false;
+    }
+
+    fclose(file);
+
+    return true;
+}
+
+// Written to a temporary file that is renamed into place, so that a
+// crash never leaves a truncated file behind.  Sounds sharing a lump
+// may be written by several workers at once, so each takes a temporary
+// file of its own, named after the sound's index.
+
+static void WriteSfxCache(sfxinfo_t *sfxinfo, int index, const char *filename)
+{
+    const allocated_sound_t *snd = ConvertedSound(sfxinfo);
+    FILE *                   file;
+    uint8_t                  header[8];
+    Uint32                   len;
+    char                     suffix[16];
+    char *                   tmpname;
+
+    if (snd == nullptr)
+    {
+        return;
+    }
+
+    M_snprintf(suffix, sizeof(suffix), ".%d.tmp", index);
+    tmpname = M_StringJoin(filename, suffix, nullptr);
+
+    if ((file = fopen(tmpname, "wb")) == nullptr)
+    {
+        free(tmpname);
+        return;
+    }
+
+    len = snd->chunk.alen;
+    memcpy(header, SFXCACHEMAGIC, 4);
+    header[4] = len & 0xff;
+    header[5] = (len >> 8) & 0xff;
+    header[6] = (len >> 16) & 0xff;
+    header[7] = (len >> 24) & 0xff;
+
+    bool ok = fwrite(header, 1, sizeof(header), file) == sizeof(header)
+              && fwrite(snd->chunk.abuf, 1, len, file) == len;
+
+    if (fclose(file) != 0 || !ok)
+    {
+        remove(tmpname);
+    }
+    else
+    {
+        remove(filename);
+        rename(tmpname, filename);
+    }
+
+    free(tmpname);
+}
+
+static void I_SDL_LoadSounds(sfxinfo_t *sounds, int num_sounds)
 {
     char namebuf[9];
     int  i;
@@ -867,6 +1446,25 @@ static void I_SDL_PrecacheSounds(sfxinfo_t *sounds, int num_sounds)
 
     printf("I_SDL_PrecacheSounds: Precaching all sound effects..");
 
+    //!
+    // @category sound
+    //
+    // Don't read or write the cache of resampled sound effects in
+    // the configuration directory.
+    //
+
+    if (!M_ParmExists("-nosfxcache"))
+    {
+        sfxcache_dir = M_StringJoin(configdir, "sfxcache", DIR_SEPARATOR_S, nullptr);
+        M_MakeDirectory(sfxcache_dir);
+    }
+
+    precache_sounds    = sounds;
+    precache_numsounds = num_sounds;
+    precache_data      = static_cast<uint8_t **>(I_Realloc(nullptr, static_cast<size_t>(num_sounds) * sizeof(*precache_data)));
+    precache_converted = static_cast<allocated_sound_t **>(I_Realloc(nullptr, static_cast<size_t>(num_sounds) * sizeof(*precache_converted)));
+    SDL_AtomicSet(&precache_next, 0);
+
     for (i = 0; i < num_sounds; ++i)
     {
         if ((i % 6) == 0)
@@ -877,17 +1475,110 @@ static void I_SDL_PrecacheSounds(sfxinfo_t *sounds, int num_sounds)
 
         GetSfxLumpName(&sounds[i], namebuf, sizeof(namebuf));
 
-        sounds[i].lumpnum = W_CheckNumForName(namebuf);
+        sounds[i].lumpnum     = W_CheckNumForName(namebuf);
+        precache_converted[i] = nullptr;
 
         if (sounds[i].lumpnum != -1)
         {
-            CacheSFX(&sounds[i]);
+            precache_data[i] = cache_lump_num<uint8_t *>(sounds[i].lumpnum, PU_STATIC);
+        }
+        else
+        {
+            precache_data[i] = nullptr;
         }
     }
 
     printf("\n");
 }
 
+// [crispy] May run on several threads at once, each taking the next
+// sound that is left.
+
+static void I_SDL_ConvertSounds()
+{
+    int i;
+
+    if (precache_converted == nullptr)
+    {
+        return;
+    }
+
+    while ((i = SDL_AtomicAdd(&precache_next, 1)) < precache_numsounds)
+    {
+        sfxinfo_t *sfxinfo  = &precache_sounds[i];
+        size_t     lumplen;
+        char *     filename = nullptr;
+
+        if (precache_data[i] == nullptr)
+        {
+            continue;
+        }
+
+        lumplen = W_LumpLength(sfxinfo->lumpnum);
+
+        if (sfxcache_dir != nullptr)
+        {
+            filename = SfxCacheFile(precache_data[i], lumplen);
+
+            if (ReadSfxCache(sfxinfo, filename))
+            {
+                free(filename);
+                continue;
+            }
+        }
+
+        if (ExpandSFX(sfxinfo, precache_data[i], lumplen) && filename != nullptr)
+        {
+            WriteSfxCache(sfxinfo, i, filename);
+        }
+
+        free(filename);
+    }
+}
+
+static void I_SDL_ReleaseSounds()
+{
+    if (precache_converted == nullptr)
+    {
+        return;
+    }
+
+    for (int i = 0; i < precache_numsounds; ++i)
+    {
+        allocated_sound_t *snd = precache_converted[i];
+
+        if (precache_data[i] != nullptr)
+        {
+            W_ReleaseLumpNum(precache_sounds[i].lumpnum);
+        }
+
+        // Into the cache, in the same order as when done one by one.
+
+        if (snd != nullptr)
+        {
+            ReserveCacheSpace(snd->chunk.alen);
+            allocated_sounds_size += static_cast<int>(snd->chunk.alen);
+            AllocatedSoundLink(snd);
+        }
+    }
+
+    free(precache_data);
+    free(precache_converted);
+    free(sfxcache_dir);
+    precache_data      = nullptr;
+    precache_converted = nullptr;
+    precache_sounds    = nullptr;
+    precache_numsounds = 0;
+    sfxcache_dir       = nullptr;
+}
+
+static void I_SDL_PrecacheSounds(sfxinfo_t *sounds, int num_sounds)
+{
+    I_SDL_LoadSounds(sounds, num_sounds);
+    I_SDL_ConvertSounds();
+    I_SDL_ReleaseSounds();
+}
+
 #else
 
 static void I_SDL_PrecacheSounds(sfxinfo_t *, int)
@@ -895,6 +1586,18 @@ static void I_SDL_PrecacheSounds(sfxinfo_t *, int)
     // no-op
 }
 
+static void I_SDL_LoadSounds(sfxinfo_t *, int)
+{
+}
+
+static void I_SDL_ConvertSounds()
+{
+}
+
+static void I_SDL_ReleaseSounds()
+{
+}
+
 #endif
 
 // Load a SFX chunk into memory and ensure that it is locked.
@@ -937,6 +1640,16 @@ static void I_SDL_UpdateSoundParams(int handle, int vol, int sep)
         return;
     }
 
+    if (sfxmixer)
+    {
+        int left;
+        int right;
+
+        SfxVolumes(vol, sep, &left, &right);
+        SDL_AtomicSet(&sfxparams[handle], SfxPackParams(sfxgeneration[handle], left, right));
+        return;
+    }
+
     int left  = ((254 - sep) * vol) / 127;
     int right = ((sep)*vol) / 127;
 
@@ -984,6 +1697,34 @@ static int I_SDL_StartSound(sfxinfo_t *sfxinfo, int channel, int vol, int sep, i
         return -1;
     }
 
+    // [crispy] no pitch shifted copies, the mixer steps through the
+    // sound at the pitch's rate instead
+    if (sfxmixer)
+    {
+        allocated_sound_t *snd = GetAllocatedSoundBySfxInfoAndPitch(sfxinfo, NORM_PITCH);
+        sfxcmd_t           cmd = {};
+
+        cmd.channel    = channel;
+        cmd.generation = ++sfxgeneration[channel];
+        cmd.data       = reinterpret_cast<const Sint16 *>(snd->chunk.abuf);
+        cmd.frames     = snd->chunk.alen / 4;
+        cmd.step       = g_i_sound_globals->snd_pitchshift ? SfxPitchStep(pitch) : 1 << 16;
+        SfxVolumes(vol, sep, &cmd.left, &cmd.right);
+
+        if (!SfxQueue(&cmd))
+        {
+            --sfxgeneration[channel];
+            UnlockAllocatedSound(snd);
+            return -1;
+        }
+
+        SDL_AtomicSet(&sfxparams[channel], SfxPackParams(cmd.generation, cmd.left, cmd.right));
+
+        channels_playing[channel] = snd;
+
+        return channel;
+    }
+
     allocated_sound_t *snd = GetAllocatedSoundBySfxInfoAndPitch(sfxinfo, pitch);
 
     if (snd == nullptr)
@@ -1047,6 +1788,14 @@ static bool I_SDL_SoundIsPlaying(int handle)
         return false;
     }
 
+    if (sfxmixer)
+    {
+        auto released = static_cast<unsigned int>(SDL_AtomicGet(&sfxreleased[handle]));
+
+        return channels_playing[handle] != nullptr
+               && static_cast<int>(released - sfxgeneration[handle]) < 0;
+    }
+
     return Mix_Playing(handle);
 }
 
@@ -1070,6 +1819,11 @@ static void I_SDL_UpdateSound()
             ReleaseSoundOnChannel(i);
         }
     }
+
+    if (sfxmixer)
+    {
+        SfxUnlockRetired();
+    }
 }
 
 static void I_SDL_ShutdownSound()
@@ -1079,6 +1833,12 @@ static void I_SDL_ShutdownSound()
         return;
     }
 
+    if (sfxmixer)
+    {
+        Mix_UnregisterEffect(MIX_CHANNEL_POST, SfxMixEffect);
+        sfxmixer = false;
+    }
+
     Mix_CloseAudio();
     SDL_QuitSubSystem(SDL_INIT_AUDIO);
 
@@ -1166,6 +1926,15 @@ static bool I_SDL_InitSound(bool _use_sfx_prefix)
 
     Mix_AllocateChannels(NUM_CHANNELS);
 
+    // [crispy] mix the sound effects in a post effect, if the
+    // output is in the format they are converted to
+    sfxmixer = mixer_format == AUDIO_S16SYS && mixer_channels == 2;
+
+    if (sfxmixer)
+    {
+        Mix_RegisterEffect(MIX_CHANNEL_POST, SfxMixEffect, nullptr, nullptr);
+    }
+
     SDL_PauseAudio(0);
 
     sound_initialized = true;
@@ -1194,4 +1963,7 @@ sound_module_t sound_sdl_module = {
     I_SDL_StopSound,
     I_SDL_SoundIsPlaying,
     I_SDL_PrecacheSounds,
+    I_SDL_LoadSounds,
+    I_SDL_ConvertSounds,
+    I_SDL_ReleaseSounds,
 };
@@ -366,6 +366,37 @@ void I_PrecacheSounds(sfxinfo_t *sounds, int num_sounds)
     }
 }
 
+// [crispy] Modules without the split-up steps just precache
+// everything in the first one.
+
+void I_LoadSounds(sfxinfo_t *sounds, int num_sounds)
+{
+    if (sound_module != nullptr && sound_module->LoadSounds != nullptr)
+    {
+        sound_module->LoadSounds(sounds, num_sounds);
+    }
+    else
+    {
+        I_PrecacheSounds(sounds, num_sounds);
+    }
+}
+
+void I_ConvertSounds()
+{
+    if (sound_module != nullptr && sound_module->ConvertSounds != nullptr)
+    {
+        sound_module->ConvertSounds();
+    }
+}
+
+void I_ReleaseSounds()
+{
+    if (sound_module != nullptr && sound_module->ReleaseSounds != nullptr)
+    {
+        sound_module->ReleaseSounds();
+    }
+}
+
 void I_InitMusic()
 {
 }
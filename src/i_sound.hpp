@@ -148,6 +148,15 @@ struct sound_module_t
 
     void (*CacheSounds)(sfxinfo_t *sounds, int num_sounds){};
 
+    // [crispy] CacheSounds in three steps, for the startup task graph:
+    // the lumps are loaded and released on the main thread, and the
+    // conversion in between may run on any number of threads at once,
+    // each call returning when there is nothing left to convert.
+
+    void (*LoadSounds)(sfxinfo_t *sounds, int num_sounds){};
+    void (*ConvertSounds)(){};
+    void (*ReleaseSounds)(){};
+
 };
 
 void    I_InitSound(bool use_sfx_prefix);
@@ -159,6 +168,9 @@ int     I_StartSound(sfxinfo_t *sfxinfo, int channel, int vol, int sep, int pitc
 void    I_StopSound(int channel);
 bool I_SoundIsPlaying(int channel);
 void    I_PrecacheSounds(sfxinfo_t *sounds, int num_sounds);
+void    I_LoadSounds(sfxinfo_t *sounds, int num_sounds); // [crispy]
+void    I_ConvertSounds();
+void    I_ReleaseSounds();
 
 // Interface for music modules
 
@@ -0,0 +1,475 @@
+//
+// Copyright(C) 2005-2014 Simon Howard
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      Worker thread pool used to split work across CPU cores.
+//
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "SDL.h"
+#include "SDL_thread.h"
+
+#include "i_system.hpp"
+#include "i_thread.hpp"
+#include "i_timer.hpp"
+#include "m_argv.hpp"
+
+static SDL_Thread *threads[MAXWORKERS];
+static int         numworkers = 1;
+
+static SDL_mutex *work_mutex;
+static SDL_cond  *work_start;
+static SDL_cond  *work_done;
+
+static workfunc_t   work_func;
+static void        *work_data;
+static unsigned int work_generation;
+static int          work_pending;
+static bool         work_quit;
+static bool         work_running; // [crispy] I_RunOnWorkers() in progress
+
+static int WorkerThread(void *arg)
+{
+    int          worker     = static_cast<int>(reinterpret_cast<intptr_t>(arg));
+    unsigned int generation = 0;
+
+    SDL_LockMutex(work_mutex);
+
+    while (true)
+    {
+        while (generation == work_generation && !work_quit)
+        {
+            SDL_CondWait(work_start, work_mutex);
+        }
+
+        if (work_quit)
+        {
+            break;
+        }
+
+        generation = work_generation;
+
+        workfunc_t func = work_func;
+        void      *data = work_data;
+
+        SDL_UnlockMutex(work_mutex);
+        func(data, worker);
+        SDL_LockMutex(work_mutex);
+
+        if (--work_pending == 0)
+        {
+            SDL_CondSignal(work_done);
+        }
+    }
+
+    SDL_UnlockMutex(work_mutex);
+
+    return 0;
+}
+
+struct bgjob_t
+{
+    void (*func)(void *data);
+    void *data;
+};
+
+static SDL_Thread  *bg_thread;
+static SDL_mutex   *bg_mutex;
+static SDL_cond    *bg_wake;
+static bgjob_t     *bg_jobs;
+static int          bg_head;
+static int          bg_tail;
+static int          bg_maxjobs;
+static int          bg_queued;
+static SDL_atomic_t bg_done;
+static bool         bg_quit;
+
+static void I_ShutdownWorkers()
+{
+    int i;
+
+    if (bg_thread != nullptr)
+    {
+        SDL_LockMutex(bg_mutex);
+        bg_quit = true;
+        SDL_CondSignal(bg_wake);
+        SDL_UnlockMutex(bg_mutex);
+
+        SDL_WaitThread(bg_thread, nullptr);
+        bg_thread = nullptr;
+    }
+
+    SDL_LockMutex(work_mutex);
+    work_quit = true;
+    SDL_CondBroadcast(work_start);
+    SDL_UnlockMutex(work_mutex);
+
+    for (i = 1; i < numworkers; i++)
+    {
+        SDL_WaitThread(threads[i], nullptr);
+    }
+
+    numworkers = 1;
+}
+
+void I_InitWorkers()
+{
+    int i, p;
+
+    //!
+    // @category video
+    // @arg <n>
+    //
+    // Use n threads for rendering and level loading.  0 uses one
+    // thread per CPU core.  The default is 1, which disables the
+    // worker threads.
+    //
+
+    p = M_CheckParmWithArgs("-threads", 1);
+
+    if (p == 0)
+    {
+        return;
+    }
+
+    numworkers = atoi(myargv[p + 1]);
+
+    if (numworkers <= 0)
+    {
+        numworkers = SDL_GetCPUCount();
+    }
+
+    if (numworkers > MAXWORKERS)
+    {
+        numworkers = MAXWORKERS;
+    }
+
+    if (numworkers <= 1)
+    {
+        numworkers = 1;
+        return;
+    }
+
+    work_mutex = SDL_CreateMutex();
+    work_start = SDL_CreateCond();
+    work_done  = SDL_CreateCond();
+
+    for (i = 1; i < numworkers; i++)
+    {
+        threads[i] = SDL_CreateThread(WorkerThread, "worker",
+            reinterpret_cast<void *>(static_cast<intptr_t>(i)));
+
+        if (threads[i] == nullptr)
+        {
+            I_Error("I_InitWorkers: Failed to create thread: %s",
+                SDL_GetError());
+        }
+    }
+
+    printf("I_InitWorkers: Using %d threads.\n", numworkers);
+
+    I_AtExit(I_ShutdownWorkers, true);
+}
+
+int I_NumWorkers()
+{
+    return numworkers;
+}
+
+void I_RunOnWorkers(workfunc_t func, void *data)
+{
+    if (numworkers == 1)
+    {
+        func(data, 0);
+        return;
+    }
+
+    // The workers are busy with the outer run.
+    if (work_running)
+    {
+        for (int i = 0; i < numworkers; i++)
+        {
+            func(data, i);
+        }
+
+        return;
+    }
+
+    work_running = true;
+
+    SDL_LockMutex(work_mutex);
+    work_func    = func;
+    work_data    = data;
+    work_pending = numworkers - 1;
+    work_generation++;
+    SDL_CondBroadcast(work_start);
+    SDL_UnlockMutex(work_mutex);
+
+    func(data, 0);
+
+    SDL_LockMutex(work_mutex);
+
+    while (work_pending > 0)
+    {
+        SDL_CondWait(work_done, work_mutex);
+    }
+
+    SDL_UnlockMutex(work_mutex);
+
+    work_running = false;
+}
+
+//
+// Task graphs
+//
+
+static workertask_t *task_list;
+static int           task_count;
+static SDL_atomic_t  task_claimed;
+static SDL_atomic_t  task_done;
+static SDL_atomic_t  task_closed; // shared tasks with no work left
+static SDL_atomic_t  task_joined[MAXWORKERTASKS];
+
+static void SetTaskBit(SDL_atomic_t *mask, int task)
+{
+    unsigned int bits;
+
+    do
+    {
+        bits = static_cast<unsigned int>(SDL_AtomicGet(mask));
+    } while (!SDL_AtomicCAS(mask, static_cast<int>(bits), static_cast<int>(bits | (1u << task))));
+}
+
+//
+// RunSharedTask
+// Every worker taking part counts itself in task_joined before it
+// looks at task_closed, so the count can't drop to zero while one of
+// them is still working.
+//
+static void RunSharedTask(int task, int worker)
+{
+    workertask_t *t = &task_list[task];
+    unsigned int  claimed;
+
+    SDL_AtomicIncRef(&task_joined[task]);
+
+    do
+    {
+        claimed = static_cast<unsigned int>(SDL_AtomicGet(&task_claimed));
+
+        if (claimed & (1u << task))
+        {
+            break;
+        }
+
+        if (SDL_AtomicCAS(&task_claimed, static_cast<int>(claimed), static_cast<int>(claimed | (1u << task))))
+        {
+            t->worker = worker;
+            t->start  = I_GetTimeUS();
+            break;
+        }
+    } while (true);
+
+    if (!(SDL_AtomicGet(&task_closed) & (1 << task)))
+    {
+        t->func();
+        SetTaskBit(&task_closed, task);
+    }
+
+    if (SDL_AtomicDecRef(&task_joined[task]))
+    {
+        t->time = I_GetTimeUS() - t->start;
+        SetTaskBit(&task_done, task);
+    }
+}
+
+static void RunTaskWorker(void *, int worker)
+{
+    const unsigned int all = task_count == 32 ? ~0u : (1u << task_count) - 1;
+
+    while (true)
+    {
+        auto claimed = static_cast<unsigned int>(SDL_AtomicGet(&task_claimed));
+        auto done    = static_cast<unsigned int>(SDL_AtomicGet(&task_done));
+        bool waiting = false;
+        int  next    = -1;
+
+        if (done == all)
+        {
+            return;
+        }
+
+        for (int i = 0; i < task_count; i++)
+        {
+            if (task_list[i].mainthread && worker != 0)
+            {
+                continue;
+            }
+
+            if (claimed & (1u << i))
+            {
+                // Help out with a shared task that has work left.
+                if (task_list[i].shared && !(done & (1u << i))
+                    && !(SDL_AtomicGet(&task_closed) & (1 << i)))
+                {
+                    next = i;
+                    break;
+                }
+
+                continue;
+            }
+
+            waiting = true;
+
+            if ((task_list[i].deps & done) == task_list[i].deps)
+            {
+                next = i;
+                break;
+            }
+        }
+
+        if (next < 0)
+        {
+            // Nothing left that this worker may run?
+            if (!waiting)
+            {
+                return;
+            }
+
+            SDL_Delay(1);
+            continue;
+        }
+
+        if (task_list[next].shared)
+        {
+            RunSharedTask(next, worker);
+            continue;
+        }
+
+        if (!SDL_AtomicCAS(&task_claimed, static_cast<int>(claimed), static_cast<int>(claimed | (1u << next))))
+        {
+            continue;
+        }
+
+        task_list[next].worker = worker;
+        task_list[next].start  = I_GetTimeUS();
+        task_list[next].func();
+        task_list[next].time = I_GetTimeUS() - task_list[next].start;
+
+        SetTaskBit(&task_done, next);
+    }
+}
+
+void I_RunTasks(workertask_t *tasks, int numtasks)
+{
+    if (numtasks > MAXWORKERTASKS)
+    {
+        I_Error("I_RunTasks: Too many tasks (%d > %d)", numtasks, MAXWORKERTASKS);
+    }
+
+    task_list  = tasks;
+    task_count = numtasks;
+    SDL_AtomicSet(&task_claimed, 0);
+    SDL_AtomicSet(&task_done, 0);
+    SDL_AtomicSet(&task_closed, 0);
+
+    for (int i = 0; i < numtasks; i++)
+    {
+        SDL_AtomicSet(&task_joined[i], 0);
+    }
+
+    I_RunOnWorkers(RunTaskWorker, nullptr);
+}
+
+//
+// Background jobs
+//
+
+static int BackgroundThread(void *)
+{
+    SDL_LockMutex(bg_mutex);
+
+    while (true)
+    {
+        while (bg_head == bg_tail && !bg_quit)
+        {
+            SDL_CondWait(bg_wake, bg_mutex);
+        }
+
+        if (bg_quit)
+        {
+            break;
+        }
+
+        bgjob_t job = bg_jobs[bg_head++];
+
+        if (bg_head == bg_tail)
+        {
+            bg_head = bg_tail = 0;
+        }
+
+        SDL_UnlockMutex(bg_mutex);
+        job.func(job.data);
+        SDL_AtomicAdd(&bg_done, 1);
+        SDL_LockMutex(bg_mutex);
+    }
+
+    SDL_UnlockMutex(bg_mutex);
+
+    return 0;
+}
+
+int I_QueueBackgroundJob(void (*func)(void *data), void *data)
+{
+    if (numworkers == 1)
+    {
+        func(data);
+        SDL_AtomicAdd(&bg_done, 1);
+        return bg_queued++;
+    }
+
+    if (bg_thread == nullptr)
+    {
+        bg_mutex  = SDL_CreateMutex();
+        bg_wake   = SDL_CreateCond();
+        bg_thread = SDL_CreateThread(BackgroundThread, "background", nullptr);
+
+        if (bg_thread == nullptr)
+        {
+            I_Error("I_QueueBackgroundJob: Failed to create thread: %s",
+                SDL_GetError());
+        }
+    }
+
+    SDL_LockMutex(bg_mutex);
+
+    if (bg_tail == bg_maxjobs)
+    {
+        bg_maxjobs = bg_maxjobs ? 2 * bg_maxjobs : 64;
+        bg_jobs    = static_cast<bgjob_t *>(I_Realloc(bg_jobs, bg_maxjobs * sizeof(*bg_jobs)));
+    }
+
+    bg_jobs[bg_tail++] = { func, data };
+    SDL_CondSignal(bg_wake);
+
+    SDL_UnlockMutex(bg_mutex);
+
+    return bg_queued++;
+}
+
+int I_BackgroundJobsDone()
+{
+    return SDL_AtomicGet(&bg_done);
+}
@@ -0,0 +1,75 @@
+//
+// Copyright(C) 2005-2014 Simon Howard
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      Worker thread pool used to split work across CPU cores.
+//
+
+
+#ifndef __I_THREAD__
+#define __I_THREAD__
+
+#include <cstdint>
+
+#define MAXWORKERS 64
+
+// Called once on each worker with its id in [0, I_NumWorkers()).
+using workfunc_t = void (*)(void *data, int worker);
+
+// Start the worker threads, as selected with -threads.
+void I_InitWorkers();
+
+// Number of workers, including the calling thread.  1 if disabled.
+int I_NumWorkers();
+
+// Run func on every worker and wait for all of them to return.
+// The calling thread acts as worker 0.  Called again from inside func
+// or a task of I_RunTasks(), func runs for each worker id in turn on
+// the calling thread instead.
+void I_RunOnWorkers(workfunc_t func, void *data);
+
+#define MAXWORKERTASKS 32
+
+// A step of a task graph for I_RunTasks().
+struct workertask_t
+{
+    const char  *name;
+    void       (*func)();
+    unsigned int deps;       // bit mask of the tasks that must finish first
+    bool         mainthread; // only run on the calling thread
+    bool         shared;     // every free worker joins in, see below
+    uint64_t     start;      // set to the I_GetTimeUS() it started at
+    uint64_t     time;       // set to the time taken, in microseconds
+    int          worker;     // set to the worker that ran it
+};
+
+// Run each task once all of its dependencies are done, spread across
+// the workers.  Tasks that use the zone allocator or the WAD cache
+// must be mainthread.  Returns when every task has finished.  Not
+// reentrant; I_RunOnWorkers() from a task doesn't run in parallel.
+// The func of a shared task is called by each worker that is free
+// while it runs; it must hand out its work itself, e.g. with an atomic
+// counter, and return once there is none left to hand out.  The task
+// is done when all of the calls have returned.
+void I_RunTasks(workertask_t *tasks, int numtasks);
+
+// Queue func(data) to run on a background thread, one job at a time
+// in the order queued.  Returns the job's sequence number.  Without
+// worker threads, the job runs straight away.
+int I_QueueBackgroundJob(void (*func)(void *data), void *data);
+
+// Number of background jobs finished so far: job n is done once this
+// is greater than n.
+int I_BackgroundJobsDone();
+
+#endif
@@ -57,6 +57,30 @@ int I_GetTimeMS()
     return static_cast<int>(ticks - basetime);
 }
 
+//
+// [crispy] High resolution time in microseconds, for profiling
+//
+
+uint64_t I_GetTimeUS()
+{
+    static Uint64 basecounter = 0;
+    static Uint64 frequency   = 0;
+    Uint64        counter;
+
+    counter = SDL_GetPerformanceCounter();
+
+    if (basecounter == 0)
+    {
+        basecounter = counter;
+        frequency   = SDL_GetPerformanceFrequency();
+    }
+
+    counter -= basecounter;
+
+    // split up to avoid overflowing the multiplication
+    return (counter / frequency) * 1000000 + (counter % frequency) * 1000000 / frequency;
+}
+
 // Sleep for a specified number of ms
 
 void I_Sleep(int ms)
@@ -159,6 +159,11 @@ static bool display_fps_dots;
 
 static bool nographics;
 
+// If this is true, frames are drawn and blitted as usual, but through
+// SDL's dummy video driver, so that no window is shown
+
+static bool headless;
+
 // Callback function to invoke to determine whether to grab the
 // mouse pointer.
 
@@ -1039,6 +1044,15 @@ void I_GraphicsCheckCommandLine()
 
     nographics = M_CheckParm("-nographics");
 
+    //!
+    // @category video
+    //
+    // Draw and blit every frame as usual, but through SDL's dummy
+    // video driver so that no window is shown.  Implied by -benchmark.
+    //
+
+    headless = M_ParmExists("-headless") || M_ParmExists("-benchmark");
+
     //!
     // @category video
     //
@@ -1185,7 +1199,7 @@ static void SetSDLVideoDriver()
     // Allow a default value for the SDL video driver to be specified
     // in the configuration file.
 
-    if (nographics)
+    if (nographics || headless)
     {
         const char *env_string = "SDL_VIDEODRIVER=dummy";
         putenv(env_string);
@@ -1380,8 +1394,9 @@ static void SetVideoMode()
 
         renderer = SDL_CreateRenderer(screen, -1, static_cast<Uint32>(renderer_flags));
 
-        // If this helped, save the setting for later.
-        if (renderer != nullptr)
+        // If this helped, save the setting for later.  The dummy
+        // driver never has an accelerated renderer, so don't.
+        if (renderer != nullptr && !headless)
         {
             g_i_video_globals->force_software_renderer = 1;
         }
@@ -30,6 +30,7 @@
 #ifdef _MSC_VER
 #include <direct.h>
 #endif
+#include <sys/stat.h> // [crispy] M_FileModTime()
 #else
 #include <sys/stat.h>
 #endif
@@ -166,6 +167,21 @@ long M_FileLength(FILE *handle)
     return length;
 }
 
+// [crispy] Returns the modification time of a file, or 0 if it can't
+// be determined
+
+long long M_FileModTime(const char *filename)
+{
+    struct stat st;
+
+    if (stat(filename, &st) != 0)
+    {
+        return 0;
+    }
+
+    return static_cast<long long>(st.st_mtime);
+}
+
 //
 // M_WriteFile
 //
@@ -32,6 +32,7 @@ char *      M_TempFile(const char *s);
 bool     M_FileExists(const char *file);
 char *      M_FileCaseExists(const char *file);
 long        M_FileLength(FILE *handle);
+long long   M_FileModTime(const char *filename);
 bool     M_StrToInt(const char *str, int *result);
 char *      M_DirName(const char *path);
 const char *M_BaseName(const char *path);
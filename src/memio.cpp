@@ -16,6 +16,7 @@
 // memory.
 //
 
+#include <cstdio>
 #include <cstring>
 
 #include "memio.hpp"
@@ -172,7 +173,8 @@ int mem_fseek(MEMFILE *stream, signed long position, mem_rel_t whence)
         return -1;
     }
 
-    if (newpos < stream->buflen)
+    // [crispy] like fseek(), allow seeking to the very end of the stream
+    if (newpos <= stream->buflen)
     {
         stream->position = newpos;
         return 0;
@@ -183,3 +185,48 @@ int mem_fseek(MEMFILE *stream, signed long position, mem_rel_t whence)
         return -1;
     }
 }
+
+// Read a line of at most size - 1 characters, like fgets()
+
+char *mem_fgets(char *s, int size, MEMFILE *stream)
+{
+    if (stream->mode != MODE_READ || size <= 0)
+    {
+        return nullptr;
+    }
+
+    if (stream->position >= stream->buflen)
+    {
+        return nullptr;
+    }
+
+    int i = 0;
+
+    while (i < size - 1 && stream->position < stream->buflen)
+    {
+        char c = static_cast<char>(stream->buf[stream->position++]);
+
+        s[i++] = c;
+
+        if (c == '\n')
+            break;
+    }
+
+    s[i] = '\0';
+
+    return s;
+}
+
+// Write a string without its terminating NUL, like fputs()
+
+int mem_fputs(const char *s, MEMFILE *stream)
+{
+    size_t len = std::strlen(s);
+
+    if (mem_fwrite(s, 1, len, stream) != len)
+    {
+        return EOF;
+    }
+
+    return 0;
+}
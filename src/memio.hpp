@@ -33,5 +33,7 @@ void     mem_get_buf(MEMFILE *stream, void **buf, size_t *buflen);
 void     mem_fclose(MEMFILE *stream);
 long     mem_ftell(MEMFILE *stream);
 int      mem_fseek(MEMFILE *stream, signed long offset, mem_rel_t whence);
+char *   mem_fgets(char *s, int size, MEMFILE *stream);
+int      mem_fputs(const char *s, MEMFILE *stream);
 
 #endif /* #ifndef MEMIO_H */
@@ -24,6 +24,8 @@
 #include "doomtype.hpp"
 #include "i_swap.hpp"
 #include "i_system.hpp"
+#include "m_misc.hpp"
+#include "memio.hpp"
 #include "midifile.hpp"
 
 #define HEADER_CHUNK_ID "MThd"
@@ -105,28 +107,20 @@ static bool CheckChunkHeader(chunk_header_t *chunk,
 
 // Read a single byte.  Returns false on error.
 
-static bool ReadByte(uint8_t *result, FILE *stream)
+static bool ReadByte(uint8_t *result, MEMFILE *stream)
 {
-    int c;
-
-    c = fgetc(stream);
-
-    if (c == EOF)
+    if (mem_fread(result, 1, 1, stream) != 1)
     {
         fprintf(stderr, "ReadByte: Unexpected end of file\n");
         return false;
     }
-    else
-    {
-        *result = static_cast<uint8_t>(c);
 
-        return true;
-    }
+    return true;
 }
 
 // Read a variable-length value.
 
-static bool ReadVariableLength(unsigned int *result, FILE *stream)
+static bool ReadVariableLength(unsigned int *result, MEMFILE *stream)
 {
     int  i;
     uint8_t b = 0;
@@ -162,10 +156,10 @@ static bool ReadVariableLength(unsigned int *result, FILE *stream)
 
 // Read a byte sequence into the data buffer.
 
-static uint8_t *ReadByteSequence(unsigned int num_bytes, FILE *stream)
+static uint8_t *ReadByteSequence(unsigned int num_bytes, MEMFILE *stream)
 {
-    unsigned int i;
-    uint8_t     *result;
+    size_t   read;
+    uint8_t *result;
 
     // Allocate a buffer. Allocate one extra byte, as malloc(0) is
     // non-portable.
@@ -180,15 +174,14 @@ static uint8_t *ReadByteSequence(unsigned int num_bytes, FILE *stream)
 
     // Read the data:
 
-    for (i = 0; i < num_bytes; ++i)
+    read = mem_fread(result, 1, num_bytes, stream);
+
+    if (read < num_bytes)
     {
-        if (!ReadByte(&result[i], stream))
-        {
-            fprintf(stderr, "ReadByteSequence: Error while reading byte %u\n",
-                i);
-            free(result);
-            return nullptr;
-        }
+        fprintf(stderr, "ReadByteSequence: Error while reading byte %u\n",
+            static_cast<unsigned int>(read));
+        free(result);
+        return nullptr;
     }
 
     return result;
@@ -199,7 +192,7 @@ static uint8_t *ReadByteSequence(unsigned int num_bytes, FILE *stream)
 // (three byte) otherwise it is single parameter (two byte)
 
 static bool ReadChannelEvent(midi_event_t *event, uint8_t event_type, bool two_param,
-    FILE *stream)
+    MEMFILE *stream)
 {
     uint8_t b = 0;
 
@@ -239,7 +232,7 @@ static bool ReadChannelEvent(midi_event_t *event, uint8_t event_type, bool two_p
 // Read sysex event:
 
 static bool ReadSysExEvent(midi_event_t *event, int event_type,
-    FILE *stream)
+    MEMFILE *stream)
 {
     event->event_type = static_cast<midi_event_type_t>(event_type);
 
@@ -265,7 +258,7 @@ static bool ReadSysExEvent(midi_event_t *event, int event_type,
 
 // Read meta event:
 
-static bool ReadMetaEvent(midi_event_t *event, FILE *stream)
+static bool ReadMetaEvent(midi_event_t *event, MEMFILE *stream)
 {
     uint8_t b = 0;
 
@@ -304,7 +297,7 @@ static bool ReadMetaEvent(midi_event_t *event, FILE *stream)
 }
 
 static bool ReadEvent(midi_event_t *event, unsigned int *last_event_type,
-    FILE *stream)
+    MEMFILE *stream)
 {
     uint8_t event_type = 0;
 
@@ -329,7 +322,7 @@ static bool ReadEvent(midi_event_t *event, unsigned int *last_event_type,
     {
         event_type = static_cast<uint8_t>(*last_event_type);
 
-        if (fseek(stream, -1, SEEK_CUR) < 0)
+        if (mem_fseek(stream, -1, MEM_SEEK_CUR) < 0)
         {
             fprintf(stderr, "ReadEvent: Unable to seek in stream\n");
             return false;
@@ -408,12 +401,12 @@ static void FreeEvent(midi_event_t *event)
 
 // Read and check the track chunk header
 
-static bool ReadTrackHeader(midi_track_t *track, FILE *stream)
+static bool ReadTrackHeader(midi_track_t *track, MEMFILE *stream)
 {
     size_t         records_read;
     chunk_header_t chunk_header;
 
-    records_read = fread(&chunk_header, sizeof(chunk_header_t), 1, stream);
+    records_read = mem_fread(&chunk_header, sizeof(chunk_header_t), 1, stream);
 
     if (records_read < 1)
     {
@@ -430,7 +423,7 @@ static bool ReadTrackHeader(midi_track_t *track, FILE *stream)
     return true;
 }
 
-static bool ReadTrack(midi_track_t *track, FILE *stream)
+static bool ReadTrack(midi_track_t *track, MEMFILE *stream)
 {
     midi_event_t *new_events;
     midi_event_t *event;
@@ -493,7 +486,7 @@ static void FreeTrack(midi_track_t *track)
     free(track->events);
 }
 
-static bool ReadAllTracks(midi_file_t *file, FILE *stream)
+static bool ReadAllTracks(midi_file_t *file, MEMFILE *stream)
 {
     unsigned int i;
 
@@ -523,12 +516,12 @@ static bool ReadAllTracks(midi_file_t *file, FILE *stream)
 
 // Read and check the header chunk.
 
-static bool ReadFileHeader(midi_file_t *file, FILE *stream)
+static bool ReadFileHeader(midi_file_t *file, MEMFILE *stream)
 {
     size_t       records_read;
     unsigned int format_type;
 
-    records_read = fread(&file->header, sizeof(midi_header_t), 1, stream);
+    records_read = mem_fread(&file->header, sizeof(midi_header_t), 1, stream);
 
     if (records_read < 1)
     {
@@ -573,10 +566,10 @@ void MIDI_FreeFile(midi_file_t *file)
     free(file);
 }
 
-midi_file_t *MIDI_LoadFile(char *filename)
-{
-    FILE *stream;
+// Read a MIDI file from a stream.
 
+static midi_file_t *LoadStream(MEMFILE *stream)
+{
     auto *file = create_struct<midi_file_t>();
 
     if (file == nullptr)
@@ -589,36 +582,69 @@ midi_file_t *MIDI_LoadFile(char *filename)
     file->buffer      = nullptr;
     file->buffer_size = 0;
 
-    // Open file
-
-    stream = fopen(filename, "rb");
+    // Read MIDI file header
 
-    if (stream == nullptr)
+    if (!ReadFileHeader(file, stream))
     {
-        fprintf(stderr, "MIDI_LoadFile: Failed to open '%s'\n", filename);
         MIDI_FreeFile(file);
         return nullptr;
     }
 
-    // Read MIDI file header
+    // Read all tracks:
 
-    if (!ReadFileHeader(file, stream))
+    if (!ReadAllTracks(file, stream))
     {
-        fclose(stream);
         MIDI_FreeFile(file);
         return nullptr;
     }
 
-    // Read all tracks:
+    return file;
+}
 
-    if (!ReadAllTracks(file, stream))
+midi_file_t *MIDI_LoadMemory(void *buf, size_t buflen)
+{
+    MEMFILE *stream = mem_fopen_read(buf, buflen);
+
+    midi_file_t *file = LoadStream(stream);
+
+    mem_fclose(stream);
+
+    return file;
+}
+
+midi_file_t *MIDI_LoadFile(char *filename)
+{
+    FILE *handle;
+
+    // Open file
+
+    handle = fopen(filename, "rb");
+
+    if (handle == nullptr)
     {
-        fclose(stream);
-        MIDI_FreeFile(file);
+        fprintf(stderr, "MIDI_LoadFile: Failed to open '%s'\n", filename);
+        return nullptr;
+    }
+
+    // Read it all in, then parse it from memory
+
+    long  length = M_FileLength(handle);
+    auto *buf    = static_cast<uint8_t *>(malloc(static_cast<size_t>(length) + 1));
+
+    if (buf == nullptr
+        || fread(buf, 1, static_cast<size_t>(length), handle) < static_cast<size_t>(length))
+    {
+        fprintf(stderr, "MIDI_LoadFile: Failed to read '%s'\n", filename);
+        fclose(handle);
+        free(buf);
         return nullptr;
     }
 
-    fclose(stream);
+    fclose(handle);
+
+    midi_file_t *file = MIDI_LoadMemory(buf, static_cast<size_t>(length));
+
+    free(buf);
 
     return file;
 }
@@ -18,6 +18,8 @@
 #ifndef MIDIFILE_H
 #define MIDIFILE_H
 
+#include <cstddef>
+
 using midi_file_t = struct midi_file_s;
 using midi_track_iter_t = struct midi_track_iter_s;
 
@@ -132,6 +134,11 @@ typedef struct
 
 midi_file_t *MIDI_LoadFile(char *filename);
 
+// Load a MIDI file from a memory buffer, such as a lump or the output
+// of mus2mid().  The buffer is not needed once this returns.
+
+midi_file_t *MIDI_LoadMemory(void *buf, size_t buflen);
+
 // Free a MIDI file.
 
 void MIDI_FreeFile(midi_file_t *file);
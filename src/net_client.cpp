@@ -308,9 +308,7 @@ static void NET_CL_SendGameDataACK()
     NET_WriteInt16(packet, NET_PACKET_TYPE_GAMEDATA_ACK);
     NET_WriteInt8(packet, recvwindow_start & 0xff);
 
-    NET_Conn_SendPacket(&client_connection, packet);
-
-    NET_FreePacket(packet);
+    NET_Conn_SendFreePacket(&client_connection, packet);
 
     need_to_acknowledge = false;
 }
@@ -357,11 +355,7 @@ static void NET_CL_SendTics(int start, int end)
 
     // Send the packet
 
-    NET_Conn_SendPacket(&client_connection, packet);
-
-    // All done!
-
-    NET_FreePacket(packet);
+    NET_Conn_SendFreePacket(&client_connection, packet);
 
     // Acknowledgement has been sent as part of the packet
 
@@ -598,8 +592,7 @@ static void NET_CL_SendResendRequest(int start, int end)
     NET_WriteInt16(packet, NET_PACKET_TYPE_GAMEDATA_RESEND);
     NET_WriteInt32(packet, static_cast<unsigned int>(start));
     NET_WriteInt8(packet, static_cast<unsigned int>(end - start + 1));
-    NET_Conn_SendPacket(&client_connection, packet);
-    NET_FreePacket(packet);
+    NET_Conn_SendFreePacket(&client_connection, packet);
 
     nowtime = static_cast<unsigned int>(I_GetTimeMS());
 
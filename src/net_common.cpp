@@ -88,6 +88,12 @@ void NET_Conn_SendPacket(net_connection_t *conn, net_packet_t *packet)
     NET_SendPacket(conn->addr, packet);
 }
 
+void NET_Conn_SendFreePacket(net_connection_t *conn, net_packet_t *packet)
+{
+    conn->keepalive_send_time = I_GetTimeMS();
+    NET_SendFreePacket(conn->addr, packet);
+}
+
 static void NET_Conn_ParseDisconnect(net_connection_t *conn, net_packet_t *)
 {
     net_packet_t *reply;
@@ -200,9 +206,7 @@ static bool NET_Conn_ReliablePacket(net_connection_t *conn,
     NET_WriteInt16(reply, NET_PACKET_TYPE_RELIABLE_ACK);
     NET_WriteInt8(reply, conn->reliable_recv_seq & 0xff);
 
-    NET_Conn_SendPacket(conn, reply);
-
-    NET_FreePacket(reply);
+    NET_Conn_SendFreePacket(conn, reply);
 
     return result;
 }
@@ -297,8 +301,7 @@ void NET_Conn_Run(net_connection_t *conn)
 
             packet = NET_NewPacket(10);
             NET_WriteInt16(packet, NET_PACKET_TYPE_KEEPALIVE);
-            NET_Conn_SendPacket(conn, packet);
-            NET_FreePacket(packet);
+            NET_Conn_SendFreePacket(conn, packet);
         }
 
         // Check the reliable packet list. Has the first packet in the
@@ -363,6 +366,53 @@ void NET_Conn_Run(net_connection_t *conn)
     }
 }
 
+// Returns the number of milliseconds until NET_Conn_Run() next has
+// something to do for this connection, or timeout if that is sooner.
+
+int NET_Conn_Timeout(net_connection_t *conn, int nowtime, int timeout)
+{
+    int left = timeout;
+
+    switch (conn->state)
+    {
+    case NET_CONN_STATE_CONNECTED:
+        left = NET_TimeLeft(nowtime, conn->keepalive_recv_time,
+            CONNECTION_TIMEOUT_LEN * 1000);
+        if (left < timeout)
+            timeout = left;
+
+        left = NET_TimeLeft(nowtime, conn->keepalive_send_time,
+            KEEPALIVE_PERIOD * 1000);
+        if (left < timeout)
+            timeout = left;
+
+        if (conn->reliable_packets != nullptr)
+        {
+            if (conn->reliable_packets->last_send_time < 0)
+                return 0;
+
+            left = NET_TimeLeft(nowtime, conn->reliable_packets->last_send_time, 1000);
+        }
+        break;
+
+    case NET_CONN_STATE_DISCONNECTING:
+        if (conn->last_send_time < 0)
+            return 0;
+
+        left = NET_TimeLeft(nowtime, conn->last_send_time, 1000);
+        break;
+
+    case NET_CONN_STATE_DISCONNECTED_SLEEP:
+        left = NET_TimeLeft(nowtime, conn->last_send_time, 5000);
+        break;
+
+    default:
+        break;
+    }
+
+    return left < timeout ? left : timeout;
+}
+
 net_packet_t *NET_Conn_NewReliable(net_connection_t *conn, int packet_type)
 {
     net_packet_t *          packet;
@@ -423,6 +473,21 @@ unsigned int NET_ExpandTicNum(unsigned int relative, unsigned int b)
     return result;
 }
 
+// Returns the number of milliseconds until a timer started at 'since'
+// expires, checked the way the timers here are: nowtime - since > period.
+
+int NET_TimeLeft(int nowtime, int since, int period)
+{
+    auto elapsed = static_cast<unsigned int>(nowtime) - static_cast<unsigned int>(since);
+
+    if (elapsed > static_cast<unsigned int>(period))
+    {
+        return 0;
+    }
+
+    return period + 1 - static_cast<int>(elapsed);
+}
+
 // Check that game settings are valid
 
 bool NET_ValidGameSettings(GameMode_t mode, GameMission_t mission,
@@ -83,6 +83,7 @@ typedef struct
 
 
 void          NET_Conn_SendPacket(net_connection_t *conn, net_packet_t *packet);
+void          NET_Conn_SendFreePacket(net_connection_t *conn, net_packet_t *packet);
 void          NET_Conn_InitClient(net_connection_t *conn, net_addr_t *addr,
              net_protocol_t protocol);
 void          NET_Conn_InitServer(net_connection_t *conn, net_addr_t *addr,
@@ -91,10 +92,12 @@ bool       NET_Conn_Packet(net_connection_t *conn, net_packet_t *packet,
           unsigned int *packet_type);
 void          NET_Conn_Disconnect(net_connection_t *conn);
 void          NET_Conn_Run(net_connection_t *conn);
+int           NET_Conn_Timeout(net_connection_t *conn, int nowtime, int timeout);
 net_packet_t *NET_Conn_NewReliable(net_connection_t *conn, int packet_type);
 
 // Other miscellaneous common functions
 unsigned int NET_ExpandTicNum(unsigned int relative, unsigned int b);
+int          NET_TimeLeft(int nowtime, int since, int period);
 bool      NET_ValidGameSettings(GameMode_t mode, GameMission_t mission,
          net_gamesettings_t *settings);
 
@@ -16,7 +16,6 @@
 //
 
 #include "i_system.hpp"
-#include "i_timer.hpp"
 
 #include "m_argv.hpp"
 
@@ -88,7 +87,6 @@ static void CheckForClientOptions()
     while (true)
     {
         NET_SV_Run();
-        // TODO: Block on socket instead of polling.
-        I_Sleep(1);
+        NET_SV_WaitForPackets();
     }
 }
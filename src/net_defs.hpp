@@ -69,12 +69,23 @@ struct _net_module_s {
 
     void (*SendPacket)(net_addr_t *addr, net_packet_t *packet);
 
+    // Send a packet that the caller has finished with, taking it over
+    // so that a module which queues packets can keep it rather than a
+    // copy.  nullptr if SendPacket doesn't copy the packet anyway.
+
+    void (*SendFreePacket)(net_addr_t *addr, net_packet_t *packet);
+
     // Check for new packets to receive
     //
     // Returns true if packet received
 
     bool (*RecvPacket)(net_addr_t **addr, net_packet_t **packet);
 
+    // Block until there may be a packet to receive, or for at most
+    // timeout milliseconds.  nullptr if the module can't block.
+
+    void (*WaitForPackets)(int timeout);
+
     // Converts an address to a string
 
     void (*AddrToString)(net_addr_t *addr, char *buffer, int buffer_len);
@@ -148,6 +159,8 @@ enum net_packet_type_t
     NET_PACKET_TYPE_QUERY_RESPONSE,
     NET_PACKET_TYPE_LAUNCH,
     NET_PACKET_TYPE_NAT_HOLE_PUNCH,
+    NET_PACKET_TYPE_SESSION_QUERY,
+    NET_PACKET_TYPE_SESSION_QUERY_RESPONSE,
 };
 
 enum net_master_packet_type_t
@@ -253,6 +266,23 @@ typedef struct
     net_protocol_t protocol;
 } net_querydata_t;
 
+// Statistics for one of the sessions (games) hosted by a server, sent in
+// response to session queries
+
+typedef struct
+{
+    int          id;
+    int          server_state;
+    int          num_players;
+    int          max_players;
+    int          gamemode;
+    int          gamemission;
+    unsigned int uptime; // seconds
+    unsigned int games_started;
+    unsigned int tics_run;
+    unsigned int packets_received;
+} net_sessiondata_t;
+
 // Data sent by the server while waiting for the game to start.
 
 typedef struct
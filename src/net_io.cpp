@@ -18,8 +18,10 @@
 
 #include "memory.hpp"
 #include "i_system.hpp"
+#include "i_timer.hpp"
 #include "net_defs.hpp"
 #include "net_io.hpp"
+#include "net_packet.hpp"
 #include "z_zone.hpp"
 
 #define MAX_MODULES 16
@@ -71,6 +73,19 @@ void NET_SendPacket(net_addr_t *addr, net_packet_t *packet)
     addr->module->SendPacket(addr, packet);
 }
 
+void NET_SendFreePacket(net_addr_t *addr, net_packet_t *packet)
+{
+    if (addr->module->SendFreePacket != nullptr)
+    {
+        addr->module->SendFreePacket(addr, packet);
+    }
+    else
+    {
+        addr->module->SendPacket(addr, packet);
+        NET_FreePacket(packet);
+    }
+}
+
 void NET_SendBroadcast(net_context_t *context, net_packet_t *packet)
 {
     for (int i = 0; i < context->num_modules; ++i)
@@ -97,6 +112,21 @@ bool NET_RecvPacket(net_context_t *context,
     return false;
 }
 
+void NET_WaitForPackets(net_context_t *context, int timeout)
+{
+    // Only a context with a single module can block on it
+
+    if (context->num_modules == 1
+        && context->modules[0]->WaitForPackets != nullptr)
+    {
+        context->modules[0]->WaitForPackets(timeout);
+    }
+    else if (timeout > 0)
+    {
+        I_Sleep(1);
+    }
+}
+
 // Note: this prints into a static buffer, calling again overwrites
 // the first result
 
@@ -31,6 +31,10 @@ void NET_AddModule(net_context_t *context, net_module_t *module);
 // Send a packet to the given address.
 void NET_SendPacket(net_addr_t *addr, net_packet_t *packet);
 
+// Send a packet to the given address and free it.  Saves a copy over
+// NET_SendPacket() and NET_FreePacket() with modules that queue packets.
+void NET_SendFreePacket(net_addr_t *addr, net_packet_t *packet);
+
 // Send a broadcast using all modules in the given context.
 void NET_SendBroadcast(net_context_t *context, net_packet_t *packet);
 
@@ -41,6 +45,10 @@ void NET_SendBroadcast(net_context_t *context, net_packet_t *packet);
 bool NET_RecvPacket(net_context_t *context, net_addr_t **addr,
     net_packet_t **packet);
 
+// Block until a packet may be waiting in the given context, or for at most
+// timeout milliseconds.  Contexts that can't block just sleep briefly.
+void NET_WaitForPackets(net_context_t *context, int timeout);
+
 // Return a string representation of the given address. The result points to a
 // static buffer and will become invalid with the next call.
 char *NET_AddrToString(net_addr_t *addr);
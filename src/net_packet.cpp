@@ -24,19 +24,86 @@
 
 static size_t total_packet_memory = 0;
 
+// Freed packets and their data buffers are kept for reuse instead of
+// going back to the zone, as a packet is allocated for every one sent
+// or received.  Buffers come in power of two size classes from
+// 1 << MIN_PACKET_CLASS to 1 << MAX_PACKET_CLASS bytes; anything
+// bigger is allocated and freed as needed.
+
+#define MIN_PACKET_CLASS   6  // 64 bytes
+#define MAX_PACKET_CLASS   11 // 2048 bytes, enough for any UDP datagram
+#define NUM_PACKET_CLASSES (MAX_PACKET_CLASS - MIN_PACKET_CLASS + 1)
+
+// Most that are kept of each, the rest are freed
+
+#define MAX_FREE_PACKETS 256
+
+static net_packet_t *free_packets[MAX_FREE_PACKETS];
+static int           num_free_packets;
+static uint8_t      *free_buffers[NUM_PACKET_CLASSES][MAX_FREE_PACKETS];
+static int           num_free_buffers[NUM_PACKET_CLASSES];
+
+// Size class of a buffer of at least size bytes, or -1 if too big
+
+static int PacketClass(size_t size)
+{
+    int sizeclass = 0;
+
+    while ((static_cast<size_t>(1) << (sizeclass + MIN_PACKET_CLASS)) < size)
+    {
+        if (++sizeclass >= NUM_PACKET_CLASSES)
+            return -1;
+    }
+
+    return sizeclass;
+}
+
+// Get a buffer of at least *size bytes, rounding *size up to what
+// was actually allocated
+
+static uint8_t *NET_AllocBuffer(size_t *size)
+{
+    int sizeclass = PacketClass(*size);
+
+    if (sizeclass < 0)
+        return zmalloc<uint8_t *>(*size, PU_STATIC, 0);
+
+    *size = static_cast<size_t>(1) << (sizeclass + MIN_PACKET_CLASS);
+
+    if (num_free_buffers[sizeclass] > 0)
+        return free_buffers[sizeclass][--num_free_buffers[sizeclass]];
+
+    return zmalloc<uint8_t *>(*size, PU_STATIC, 0);
+}
+
+static void NET_FreeBuffer(uint8_t *buf, size_t size)
+{
+    int sizeclass = PacketClass(size);
+
+    if (sizeclass >= 0 && num_free_buffers[sizeclass] < MAX_FREE_PACKETS)
+        free_buffers[sizeclass][num_free_buffers[sizeclass]++] = buf;
+    else
+        Z_Free(buf);
+}
+
 net_packet_t *NET_NewPacket(int initial_size)
 {
-    net_packet_t *packet = zmalloc<net_packet_t *>(sizeof(net_packet_t), PU_STATIC, 0);
+    net_packet_t *packet;
+
+    if (num_free_packets > 0)
+        packet = free_packets[--num_free_packets];
+    else
+        packet = zmalloc<net_packet_t *>(sizeof(net_packet_t), PU_STATIC, 0);
 
     if (initial_size == 0)
         initial_size = 256;
 
     packet->alloced = static_cast<size_t>(initial_size);
-    packet->data    = zmalloc<uint8_t *>(static_cast<size_t>(initial_size), PU_STATIC, 0);
+    packet->data    = NET_AllocBuffer(&packet->alloced);
     packet->len     = 0;
     packet->pos     = 0;
 
-    total_packet_memory += sizeof(net_packet_t) + static_cast<unsigned long>(initial_size);
+    total_packet_memory += sizeof(net_packet_t) + packet->alloced;
 
     //printf("total packet memory: %i bytes\n", total_packet_memory);
     //printf("%p: allocated\n", packet);
@@ -60,8 +127,12 @@ void NET_FreePacket(net_packet_t *packet)
     //printf("%p: destroyed\n", packet);
 
     total_packet_memory -= sizeof(net_packet_t) + packet->alloced;
-    Z_Free(packet->data);
-    Z_Free(packet);
+    NET_FreeBuffer(packet->data, packet->alloced);
+
+    if (num_free_packets < MAX_FREE_PACKETS)
+        free_packets[num_free_packets++] = packet;
+    else
+        Z_Free(packet);
 }
 
 // Read a byte from the packet, returning true if read
@@ -227,16 +298,17 @@ char *NET_ReadSafeString(net_packet_t *packet)
 
 static void NET_IncreasePacket(net_packet_t *packet)
 {
-    total_packet_memory -= packet->alloced;
+    size_t newsize = packet->alloced * 2;
 
-    packet->alloced *= 2;
+    total_packet_memory -= packet->alloced;
 
-    auto *newdata = zmalloc<uint8_t *>(packet->alloced, PU_STATIC, 0);
+    auto *newdata = NET_AllocBuffer(&newsize);
 
     std::memcpy(newdata, packet->data, packet->len);
 
-    Z_Free(packet->data);
-    packet->data = newdata;
+    NET_FreeBuffer(packet->data, packet->alloced);
+    packet->data    = newdata;
+    packet->alloced = newsize;
 
     total_packet_memory += packet->alloced;
 }
@@ -859,6 +859,118 @@ static net_packet_t *BlockForPacket(net_addr_t *addr, unsigned int packet_type,
     return nullptr;
 }
 
+// The server states of net_server.cpp
+
+static const char *SessionStateString(int state)
+{
+    switch (state)
+    {
+    case 0:
+        return "waiting";
+    case 1:
+        return "starting";
+    default:
+        return "in game";
+    }
+}
+
+// Print the statistics of each session hosted by the server at the
+// given address.
+
+void NET_QuerySessions(char *addr_str)
+{
+    NET_Query_Init();
+
+    net_addr_t *addr = NET_ResolveAddress(query_context, addr_str);
+
+    if (addr == nullptr)
+    {
+        I_Error("NET_QuerySessions: Host '%s' not found!", addr_str);
+    }
+
+    printf("\nQuerying sessions on '%s'...\n", addr_str);
+
+    net_packet_t *request = NET_NewPacket(10);
+    NET_WriteInt16(request, NET_PACKET_TYPE_SESSION_QUERY);
+    NET_SendPacket(addr, request);
+    NET_FreePacket(request);
+
+    // The sessions may be split over several packets
+
+    int total    = -1;
+    int received = 0;
+
+    while (total < 0 || received < total)
+    {
+        net_packet_t *response = BlockForPacket(addr,
+            NET_PACKET_TYPE_SESSION_QUERY_RESPONSE, QUERY_TIMEOUT_SECS * 1000);
+
+        if (response == nullptr)
+        {
+            break;
+        }
+
+        unsigned int num_sessions = 0;
+        unsigned int count        = 0;
+
+        if (NET_ReadInt16(response, &num_sessions)
+            && NET_ReadInt8(response, &count))
+        {
+            if (total < 0)
+            {
+                total = static_cast<int>(num_sessions);
+
+                putchar('\n');
+                formatted_printf(6, "Id");
+                formatted_printf(10, "State");
+                formatted_printf(8, "Players");
+                formatted_printf(10, "Game");
+                formatted_printf(10, "Uptime");
+                formatted_printf(7, "Games");
+                formatted_printf(10, "Tics");
+                puts("Packets");
+
+                for (int i = 0; i < 70; ++i)
+                    putchar('=');
+                putchar('\n');
+            }
+
+            for (unsigned int i = 0; i < count; ++i)
+            {
+                net_sessiondata_t data;
+
+                if (!NET_ReadSessionData(response, &data))
+                {
+                    break;
+                }
+
+                formatted_printf(6, "%i", data.id);
+                formatted_printf(10, "%s", SessionStateString(data.server_state));
+                formatted_printf(8, "%i/%i", data.num_players, data.max_players);
+                formatted_printf(10, "%s", data.gamemode != indetermined ?
+                    GameDescription(data.gamemode, data.gamemission) : "-");
+                formatted_printf(10, "%us", data.uptime);
+                formatted_printf(7, "%u", data.games_started);
+                formatted_printf(10, "%u", data.tics_run);
+                printf("%u\n", data.packets_received);
+
+                ++received;
+            }
+        }
+
+        NET_FreePacket(response);
+    }
+
+    NET_ReleaseAddress(addr);
+
+    if (total < 0)
+    {
+        I_Error("No response from '%s'", addr_str);
+    }
+
+    printf("\n%i session(s).\n", total);
+}
+
 // Query master server for secure demo start seed value.
 
 [[maybe_unused]] bool NET_StartSecureDemo(prng_seed_t seed)
@@ -38,29 +38,90 @@
 
 static bool    initted = false;
 static int        port    = DEFAULT_PORT;
-static UDPsocket  udpsocket;
-static UDPpacket *recvpacket;
+static UDPsocket        udpsocket;
+static SDLNet_SocketSet udpsocketset;
 
-typedef struct
+// Packets are received in batches of up to RECVBATCH at a time.  Each
+// slot of the batch reads straight into the buffer of a net_packet_t,
+// which is handed out as it is and replaced with a new one from the
+// packet pool, so nothing is copied.
+
+#define RECVBATCH 16
+#define RECVSIZE  1500
+
+static UDPpacket     recvudp[RECVBATCH];
+static UDPpacket    *recvpackets[RECVBATCH + 1];
+static net_packet_t *recvslots[RECVBATCH];
+static int           recvpackets_count;
+static int           recvpackets_next;
+
+// Addresses are kept in a hash table keyed on host and port, so that
+// finding the sender of each packet received doesn't depend on how
+// many addresses have been seen.  An entry is freed when the last
+// reference to its address is released.
+
+typedef struct addrpair_s
 {
-    net_addr_t net_addr;
-    IPaddress  sdl_addr;
+    net_addr_t         net_addr;
+    IPaddress          sdl_addr;
+    struct addrpair_s *next;
 } addrpair_t;
 
 static addrpair_t **addr_table;
-static int          addr_table_size = -1;
+static int          addr_table_size = -1; // always a power of two
+static int          addr_table_count;
+
+static unsigned int AddressHash(IPaddress *addr)
+{
+    unsigned int h = addr->host * 2654435761u;
+
+    h ^= addr->port * 40503u;
+
+    return h ^ (h >> 16);
+}
 
 // Initializes the address table
 
 static void NET_SDL_InitAddrTable()
 {
-    addr_table_size = 16;
+    addr_table_size = 64;
 
     addr_table = zmalloc<decltype(addr_table)>(sizeof(addrpair_t *) * static_cast<unsigned long>(addr_table_size),
         PU_STATIC, 0);
     std::memset(addr_table, 0, sizeof(addrpair_t *) * static_cast<unsigned long>(addr_table_size));
 }
 
+// Doubles the number of hash chains; the entries themselves stay put,
+// as net_addr_t pointers to them are held elsewhere.
+
+static void NET_SDL_GrowAddrTable()
+{
+    int new_addr_table_size = addr_table_size * 2;
+
+    addrpair_t **new_addr_table = zmalloc<decltype(new_addr_table)>(sizeof(addrpair_t *) * static_cast<unsigned long>(new_addr_table_size),
+        PU_STATIC, 0);
+    std::memset(new_addr_table, 0, sizeof(addrpair_t *) * static_cast<unsigned long>(new_addr_table_size));
+
+    for (int i = 0; i < addr_table_size; ++i)
+    {
+        addrpair_t *entry = addr_table[i];
+
+        while (entry != nullptr)
+        {
+            addrpair_t *next = entry->next;
+            unsigned int bucket = AddressHash(&entry->sdl_addr) & static_cast<unsigned int>(new_addr_table_size - 1);
+
+            entry->next = new_addr_table[bucket];
+            new_addr_table[bucket] = entry;
+            entry = next;
+        }
+    }
+
+    Z_Free(addr_table);
+    addr_table      = new_addr_table;
+    addr_table_size = new_addr_table_size;
+}
+
 static bool AddressesEqual(IPaddress *a, IPaddress *b)
 {
     return a->host == b->host
@@ -72,78 +133,96 @@ static bool AddressesEqual(IPaddress *a, IPaddress *b)
 
 static net_addr_t *NET_SDL_FindAddress(IPaddress *addr)
 {
-    int empty_entry = -1;
-
     if (addr_table_size < 0)
     {
         NET_SDL_InitAddrTable();
     }
 
-    for (int i = 0; i < addr_table_size; ++i)
+    unsigned int hash = AddressHash(addr);
+
+    for (addrpair_t *entry = addr_table[hash & static_cast<unsigned int>(addr_table_size - 1)];
+         entry != nullptr;
+         entry = entry->next)
     {
-        if (addr_table[i] != nullptr
-            && AddressesEqual(addr, &addr_table[i]->sdl_addr))
+        if (AddressesEqual(addr, &entry->sdl_addr))
         {
-            return &addr_table[i]->net_addr;
+            return &entry->net_addr;
         }
-
-        if (empty_entry < 0 && addr_table[i] == nullptr)
-            empty_entry = i;
     }
 
     // Was not found in list.  We need to add it.
+    // Keep the chains short by growing the table along with the
+    // number of addresses.
 
-    // Is there any space in the table? If not, increase the table size
-
-    if (empty_entry < 0)
+    if (addr_table_count >= addr_table_size)
     {
-        // after reallocing, we will add this in as the first entry
-        // in the new block of memory
-
-        empty_entry = addr_table_size;
-
-        // allocate a new array twice the size, init to 0 and copy
-        // the existing table in.  replace the old table.
-
-        int new_addr_table_size = addr_table_size * 2;
-        addrpair_t **new_addr_table = zmalloc<decltype(new_addr_table)>(sizeof(addrpair_t *) * static_cast<unsigned long>(new_addr_table_size),
-            PU_STATIC, 0);
-        std::memset(new_addr_table, 0, sizeof(addrpair_t *) * static_cast<unsigned long>(new_addr_table_size));
-        std::memcpy(new_addr_table, addr_table,
-            sizeof(addrpair_t *) * static_cast<unsigned long>(addr_table_size));
-        Z_Free(addr_table);
-        addr_table      = new_addr_table;
-        addr_table_size = new_addr_table_size;
+        NET_SDL_GrowAddrTable();
     }
 
+    unsigned int bucket = hash & static_cast<unsigned int>(addr_table_size - 1);
+
     // Add a new entry
 
     addrpair_t *new_entry = zmalloc<decltype(new_entry)>(sizeof(addrpair_t), PU_STATIC, 0);
+
     new_entry->sdl_addr          = *addr;
     new_entry->net_addr.refcount = 0;
     new_entry->net_addr.handle   = &new_entry->sdl_addr;
     new_entry->net_addr.module   = &net_sdl_module;
+    new_entry->next              = addr_table[bucket];
 
-    addr_table[empty_entry] = new_entry;
+    addr_table[bucket] = new_entry;
+    ++addr_table_count;
 
     return &new_entry->net_addr;
 }
 
 static void NET_SDL_FreeAddress(net_addr_t *addr)
 {
-    for (int i = 0; i < addr_table_size; ++i)
+    if (addr_table_size > 0)
     {
-        if (addr == &addr_table[i]->net_addr)
+        auto *       ip     = reinterpret_cast<IPaddress *>(addr->handle);
+        unsigned int bucket = AddressHash(ip) & static_cast<unsigned int>(addr_table_size - 1);
+
+        for (addrpair_t **entry = &addr_table[bucket];
+             *entry != nullptr;
+             entry = &(*entry)->next)
         {
-            Z_Free(addr_table[i]);
-            addr_table[i] = nullptr;
-            return;
+            if (addr == &(*entry)->net_addr)
+            {
+                addrpair_t *freed = *entry;
+
+                *entry = freed->next;
+                Z_Free(freed);
+                --addr_table_count;
+                return;
+            }
         }
     }
 
     I_Error("NET_SDL_FreeAddress: Attempted to remove an unused address!");
 }
 
+// Give a receive slot a new packet to read into
+
+static void NET_SDL_FillRecvSlot(int i)
+{
+    recvslots[i]      = NET_NewPacket(RECVSIZE);
+    recvudp[i].data   = recvslots[i]->data;
+    recvudp[i].maxlen = static_cast<int>(recvslots[i]->alloced);
+}
+
+static void NET_SDL_InitRecvPackets()
+{
+    for (int i = 0; i < RECVBATCH; ++i)
+    {
+        NET_SDL_FillRecvSlot(i);
+        recvpackets[i] = &recvudp[i];
+    }
+
+    recvpackets[RECVBATCH] = nullptr;
+}
+
 static bool NET_SDL_InitClient()
 {
     if (initted)
@@ -170,7 +249,9 @@ static bool NET_SDL_InitClient()
         I_Error("NET_SDL_InitClient: Unable to open a socket!");
     }
 
-    recvpacket = SDLNet_AllocPacket(1500);
+    NET_SDL_InitRecvPackets();
+    udpsocketset = SDLNet_AllocSocketSet(1);
+    SDLNet_UDP_AddSocket(udpsocketset, udpsocket);
 
 #ifdef DROP_PACKETS
     srand(time(nullptr));
@@ -199,7 +280,9 @@ static bool NET_SDL_InitServer()
         I_Error("NET_SDL_InitServer: Unable to bind to port %i", port);
     }
 
-    recvpacket = SDLNet_AllocPacket(1500);
+    NET_SDL_InitRecvPackets();
+    udpsocketset = SDLNet_AllocSocketSet(1);
+    SDLNet_UDP_AddSocket(udpsocketset, udpsocket);
 #ifdef DROP_PACKETS
     srand(time(nullptr));
 #endif
@@ -259,32 +342,59 @@ static void NET_SDL_SendPacket(net_addr_t *addr, net_packet_t *packet)
 
 static bool NET_SDL_RecvPacket(net_addr_t **addr, net_packet_t **packet)
 {
-    int result = SDLNet_UDP_Recv(udpsocket, recvpacket);
+    // Read everything waiting on the socket once the last batch has
+    // been handed out
 
-    if (result < 0)
+    if (recvpackets_next >= recvpackets_count)
     {
-        I_Error("NET_SDL_RecvPacket: Error receiving packet: %s",
-            SDLNet_GetError());
-    }
+        int result = SDLNet_UDP_RecvV(udpsocket, recvpackets);
 
-    // no packets received
+        if (result < 0)
+        {
+            I_Error("NET_SDL_RecvPacket: Error receiving packet: %s",
+                SDLNet_GetError());
+        }
+
+        recvpackets_count = result;
+        recvpackets_next  = 0;
+
+        // no packets received
+
+        if (result == 0)
+            return false;
+    }
 
-    if (result == 0)
-        return false;
+    int i = recvpackets_next++;
 
-    // Put the data into a new packet structure
+    // The data is already in a packet structure
 
-    *packet = NET_NewPacket(recvpacket->len);
-    std::memcpy((*packet)->data, recvpacket->data, static_cast<size_t>(recvpacket->len));
-    (*packet)->len = static_cast<size_t>(recvpacket->len);
+    *packet        = recvslots[i];
+    (*packet)->len = static_cast<size_t>(recvudp[i].len);
 
     // Address
 
-    *addr = NET_SDL_FindAddress(&recvpacket->address);
+    *addr = NET_SDL_FindAddress(&recvudp[i].address);
+
+    NET_SDL_FillRecvSlot(i);
 
     return true;
 }
 
+static void NET_SDL_WaitForPackets(int timeout)
+{
+    // Still working through the last batch?
+
+    if (recvpackets_next < recvpackets_count)
+    {
+        return;
+    }
+
+    // An error here (eg. an interrupted select()) just means the
+    // caller polls a little early.
+
+    SDLNet_CheckSockets(udpsocketset, static_cast<Uint32>(timeout));
+}
+
 void NET_SDL_AddrToString(net_addr_t *addr, char *buffer, int buffer_len)
 {
     auto *ip   = reinterpret_cast<IPaddress *>(addr->handle);
@@ -346,8 +456,80 @@ net_module_t net_sdl_module = {
     NET_SDL_InitClient,
     NET_SDL_InitServer,
     NET_SDL_SendPacket,
+    nullptr,
     NET_SDL_RecvPacket,
+    NET_SDL_WaitForPackets,
     NET_SDL_AddrToString,
     NET_SDL_FreeAddress,
     NET_SDL_ResolveAddress,
 };
+
+#ifdef BENCHMARK
+
+#include <cstdio>
+
+#include "i_timer.hpp"
+
+// Micro-benchmark for the address table: a number of clients hold
+// references to their addresses while datagrams are looked up, one in
+// eight of them from a one-off address that is freed again, as query
+// and master server traffic is.
+
+#define BENCHPACKETS 2000000
+
+int main()
+{
+    static const int numaddrs[] = { 16, 256, 4096 };
+
+    for (int n : numaddrs)
+    {
+        auto **held = static_cast<net_addr_t **>(malloc(sizeof(net_addr_t *) * static_cast<size_t>(n)));
+
+        for (int i = 0; i < n; ++i)
+        {
+            IPaddress ip = { 0x0a000000u + static_cast<Uint32>(i), DEFAULT_PORT };
+
+            held[i] = NET_SDL_FindAddress(&ip);
+            NET_ReferenceAddress(held[i]);
+        }
+
+        uint64_t start = I_GetTimeUS();
+
+        for (int k = 0; k < BENCHPACKETS; ++k)
+        {
+            if (k % 8 == 0)
+            {
+                IPaddress ip = { 0xc0000000u + static_cast<Uint32>(k), 1000 };
+
+                NET_SDL_FreeAddress(NET_SDL_FindAddress(&ip));
+            }
+            else
+            {
+                int       i  = static_cast<int>((k * 7919LL) % n);
+                IPaddress ip = { 0x0a000000u + static_cast<Uint32>(i), DEFAULT_PORT };
+
+                if (NET_SDL_FindAddress(&ip) != held[i])
+                {
+                    fprintf(stderr, "Address %d not found\n", i);
+                    exit(1);
+                }
+            }
+        }
+
+        uint64_t elapsed = I_GetTimeUS() - start;
+
+        printf("%5d addresses: %.1f ns/packet\n", n,
+               static_cast<double>(elapsed) * 1000.0 / BENCHPACKETS);
+
+        for (int i = 0; i < n; ++i)
+        {
+            NET_SDL_FreeAddress(held[i]);
+        }
+
+        free(held);
+    }
+
+    return 0;
+}
+
+#endif
@@ -27,6 +27,7 @@
 #include "i_timer.hpp"
 #include "m_argv.hpp"
 #include "m_misc.hpp"
+#include "memory.hpp"
 
 #include "net_client.hpp"
 #include "net_common.hpp"
@@ -141,14 +142,52 @@ typedef struct
     net_ticdiff_t diff;
 } net_client_recv_t;
 
-static net_server_state_t server_state;
-static bool            server_initialized = false;
-static net_client_t       clients[MAXNETNODES];
-static net_client_t *     sv_players[NET_MAXPLAYERS];
-static net_context_t *    server_context;
-static unsigned int       sv_gamemode;
-static unsigned int       sv_gamemission;
-static net_gamesettings_t sv_settings;
+// A game hosted by the server.  The server holds any number of these,
+// each with its own set of clients, all sharing one network context.
+
+typedef struct
+{
+    int                id;
+    net_server_state_t state;
+    net_client_t       clients[MAXNETNODES];
+    net_client_t *     players[NET_MAXPLAYERS];
+    unsigned int       gamemode;
+    unsigned int       gamemission;
+    net_gamesettings_t settings;
+
+    // receive window
+
+    unsigned int      recvwindow_start;
+    net_client_recv_t recvwindow[BACKUPTICS][NET_MAXPLAYERS];
+
+    // Statistics, reported to session queries
+
+    int          create_time;
+    unsigned int games_started;
+    unsigned int tics_run;
+    unsigned int packets_received;
+} net_session_t;
+
+static bool           server_initialized = false;
+static net_context_t *server_context;
+
+static net_session_t **sessions;
+static int             num_sessions;
+static int             max_sessions = 1;
+
+// The session being worked on
+
+static net_session_t *sv;
+
+// Set when NET_SV_Run() left work that the next call will pick up
+// straight away, so NET_SV_WaitForPackets() shouldn't block
+
+static bool sv_run_again;
+
+// Longest that NET_SV_WaitForPackets() blocks for, in case some
+// deadline was missed
+
+#define MAX_WAIT_TIME 1000
 
 // For registration with master server:
 
@@ -156,12 +195,7 @@ static net_addr_t * master_server = nullptr;
 static unsigned int master_refresh_time;
 static unsigned int master_resolve_time;
 
-// receive window
-
-static unsigned int      recvwindow_start;
-static net_client_recv_t recvwindow[BACKUPTICS][NET_MAXPLAYERS];
-
-#define NET_SV_ExpandTicNum(b) NET_ExpandTicNum(recvwindow_start, (b))
+#define NET_SV_ExpandTicNum(b) NET_ExpandTicNum(sv->recvwindow_start, (b))
 
 static void NET_SV_DisconnectClient(net_client_t *client)
 {
@@ -210,7 +244,7 @@ static void NET_SV_BroadcastMessage(const char *s, ...)
     M_vsnprintf(buf, sizeof(buf), s, args);
     va_end(args);
 
-    for (auto & client : clients)
+    for (auto & client : sv->clients)
     {
         if (ClientConnected(&client))
         {
@@ -228,14 +262,14 @@ static void NET_SV_AssignPlayers()
 {
     int pl = 0;
 
-    for (auto & client : clients)
+    for (auto & client : sv->clients)
     {
         if (ClientConnected(&client))
         {
             if (!client.drone)
             {
-                sv_players[pl]                = &client;
-                sv_players[pl]->player_number = pl;
+                sv->players[pl]                = &client;
+                sv->players[pl]->player_number = pl;
                 ++pl;
             }
             else
@@ -247,7 +281,7 @@ static void NET_SV_AssignPlayers()
 
     for (; pl < NET_MAXPLAYERS; ++pl)
     {
-        sv_players[pl] = nullptr;
+        sv->players[pl] = nullptr;
     }
 }
 
@@ -257,7 +291,7 @@ static int NET_SV_NumPlayers()
 {
     int result = 0;
 
-    for (auto & sv_player : sv_players)
+    for (auto & sv_player : sv->players)
     {
         if (sv_player != nullptr && ClientConnected(sv_player))
         {
@@ -274,7 +308,7 @@ static int NET_SV_NumReadyPlayers()
 {
     int result = 0;
 
-    for (auto & client : clients)
+    for (auto & client : sv->clients)
     {
         if (ClientConnected(&client)
             && !client.drone && client.ready)
@@ -290,7 +324,7 @@ static int NET_SV_NumReadyPlayers()
 
 static int NET_SV_MaxPlayers()
 {
-    for (auto & client : clients)
+    for (auto & client : sv->clients)
     {
         if (ClientConnected(&client))
         {
@@ -307,7 +341,7 @@ static int NET_SV_NumDrones()
 {
     int result = 0;
 
-    for (auto & client : clients)
+    for (auto & client : sv->clients)
     {
         if (ClientConnected(&client) && client.drone)
         {
@@ -324,7 +358,7 @@ static int NET_SV_NumClients()
 {
     int count = 0;
 
-    for (auto & client : clients)
+    for (auto & client : sv->clients)
     {
         if (ClientConnected(&client))
         {
@@ -342,7 +376,7 @@ static net_client_t *NET_SV_Controller()
     // Find the oldest client (first to connect).
     net_client_t *best = nullptr;
 
-    for (auto & client : clients)
+    for (auto & client : sv->clients)
     {
         // Can't be controller?
         if (!ClientConnected(&client) || client.drone)
@@ -393,10 +427,10 @@ static void NET_SV_SendWaitingData(net_client_t *client)
     for (int i = 0; i < wait_data.num_players; ++i)
     {
         M_StringCopy(wait_data.player_names[i],
-            sv_players[i]->name,
+            sv->players[i]->name,
             MAXPLAYERNAME);
         M_StringCopy(wait_data.player_addrs[i],
-            NET_AddrToString(sv_players[i]->addr),
+            NET_AddrToString(sv->players[i]->addr),
             MAXPLAYERNAME);
     }
 
@@ -408,8 +442,7 @@ static void NET_SV_SendWaitingData(net_client_t *client)
 
     // Send packet to client and free
 
-    NET_Conn_SendPacket(&client->connection, packet);
-    NET_FreePacket(packet);
+    NET_Conn_SendFreePacket(&client->connection, packet);
 }
 
 // Find the latest tic which has been acknowledged as received by
@@ -419,7 +452,7 @@ static unsigned int NET_SV_LatestAcknowledged()
 {
     unsigned int lowtic = UINT_MAX;
 
-    for (auto & client : clients)
+    for (auto & client : sv->clients)
     {
         if (ClientConnected(&client))
         {
@@ -448,7 +481,7 @@ static void NET_SV_AdvanceWindow()
 
     // Advance the recv window until it catches up with lowtic
 
-    while (recvwindow_start < lowtic)
+    while (sv->recvwindow_start < lowtic)
     {
         // Check we have tics from all players for first tic in
         // the recv window
@@ -457,12 +490,12 @@ static void NET_SV_AdvanceWindow()
 
         for (int i = 0; i < NET_MAXPLAYERS; ++i)
         {
-            if (sv_players[i] == nullptr || !ClientConnected(sv_players[i]))
+            if (sv->players[i] == nullptr || !ClientConnected(sv->players[i]))
             {
                 continue;
             }
 
-            if (!recvwindow[0][i].active)
+            if (!sv->recvwindow[0][i].active)
             {
                 should_advance = false;
                 break;
@@ -480,30 +513,104 @@ static void NET_SV_AdvanceWindow()
 
         // Advance the window
 
-        std::memmove(recvwindow, recvwindow + 1,
-            sizeof(*recvwindow) * (BACKUPTICS - 1));
-        std::memset(&recvwindow[BACKUPTICS - 1], 0, sizeof(*recvwindow));
-        ++recvwindow_start;
-        NET_Log("server: advanced receive window to %d", recvwindow_start);
+        std::memmove(sv->recvwindow, sv->recvwindow + 1,
+            sizeof(*sv->recvwindow) * (BACKUPTICS - 1));
+        std::memset(&sv->recvwindow[BACKUPTICS - 1], 0, sizeof(*sv->recvwindow));
+        ++sv->recvwindow_start;
+        ++sv->tics_run;
+        NET_Log("server: advanced receive window to %d", sv->recvwindow_start);
     }
 }
 
-// Given an address, find the corresponding client
+// Given an address, find the corresponding client, and make its
+// session the current one
 
 static net_client_t *NET_SV_FindClient(net_addr_t *addr)
 {
-    for (auto & client : clients)
+    for (int i = 0; i < num_sessions; ++i)
     {
-        if (client.active && client.addr == addr)
+        for (auto & client : sessions[i]->clients)
         {
-            // found the client
-            return &client;
+            if (client.active && client.addr == addr)
+            {
+                // found the client
+                sv = sessions[i];
+                return &client;
+            }
         }
     }
 
     return nullptr;
 }
 
+static net_session_t *NET_SV_NewSession()
+{
+    auto *session = create_struct<net_session_t>();
+
+    session->id          = num_sessions;
+    session->state       = SERVER_WAITING_LAUNCH;
+    session->gamemode    = indetermined;
+    session->create_time = I_GetTimeMS();
+
+    sessions = static_cast<net_session_t **>(I_Realloc(sessions,
+        (num_sessions + 1) * sizeof(*sessions)));
+    sessions[num_sessions++] = session;
+
+    return session;
+}
+
+// Pick the session that a new client should join, and make it the
+// current one: a game of the same kind that is still waiting for
+// players, or else an empty one, or else a new one.  If there is no
+// room for another session the first one is used, which rejects the
+// client with the usual message.
+
+static void NET_SV_SelectSession(net_connect_data_t *data)
+{
+    net_session_t *empty = nullptr;
+
+    for (int i = 0; i < num_sessions; ++i)
+    {
+        sv = sessions[i];
+
+        if (sv->state != SERVER_WAITING_LAUNCH
+            || NET_SV_NumClients() >= MAXNETNODES)
+        {
+            continue;
+        }
+
+        NET_SV_AssignPlayers();
+
+        if (NET_SV_NumPlayers() == 0)
+        {
+            if (empty == nullptr)
+            {
+                empty = sv;
+            }
+        }
+        else if (data->gamemode == static_cast<int>(sv->gamemode)
+                 && data->gamemission == static_cast<int>(sv->gamemission)
+                 && (data->drone || NET_SV_NumPlayers() < NET_SV_MaxPlayers()))
+        {
+            return;
+        }
+    }
+
+    if (empty != nullptr)
+    {
+        sv = empty;
+    }
+    else if (num_sessions < max_sessions)
+    {
+        sv = NET_SV_NewSession();
+        NET_Log("server: started session %d", sv->id);
+    }
+    else
+    {
+        sv = sessions[0];
+    }
+}
+
 // send a rejection packet to a client
 
 static void NET_SV_SendReject(net_addr_t *addr, const char *msg)
@@ -629,11 +736,16 @@ static void NET_SV_ParseSYN(net_packet_t *packet, net_client_t *client,
 
     // At this point we have received a valid SYN.
 
+    if (client == nullptr)
+    {
+        NET_SV_SelectSession(&data);
+    }
+
     // Not accepting new connections?
-    if (server_state != SERVER_WAITING_LAUNCH)
+    if (sv->state != SERVER_WAITING_LAUNCH)
     {
         NET_Log("server: error: not in waiting launch state, server_state=%d",
-            server_state);
+            sv->state);
         NET_SV_SendReject(addr,
             "Server is not currently accepting connections");
         return;
@@ -659,23 +771,23 @@ static void NET_SV_ParseSYN(net_packet_t *packet, net_client_t *client,
     // Adopt the game mode and mission of the first connecting client:
     if (num_players == 0 && !data.drone)
     {
-        sv_gamemode    = static_cast<unsigned int>(data.gamemode);
-        sv_gamemission = static_cast<unsigned int>(data.gamemission);
+        sv->gamemode    = static_cast<unsigned int>(data.gamemode);
+        sv->gamemission = static_cast<unsigned int>(data.gamemission);
         NET_Log("server: new game, mode=%d, mission=%d",
-            sv_gamemode, sv_gamemission);
+            sv->gamemode, sv->gamemission);
     }
 
     // Check the connecting client is playing the same game as all
     // the other clients
-    if (data.gamemode != static_cast<int>(sv_gamemode) || data.gamemission != static_cast<int>(sv_gamemission))
+    if (data.gamemode != static_cast<int>(sv->gamemode) || data.gamemission != static_cast<int>(sv->gamemission))
     {
         char msg[128];
         NET_Log("server: wrong mode/mission, %d != %d || %d != %d",
-            data.gamemode, sv_gamemode, data.gamemission, sv_gamemission);
+            data.gamemode, sv->gamemode, data.gamemission, sv->gamemission);
         M_snprintf(msg, sizeof(msg),
             "Game mismatch: server is %s (%s), client is %s (%s)",
-            D_GameMissionString(static_cast<GameMission_t>(sv_gamemission)),
-            D_GameModeString(static_cast<GameMode_t>(sv_gamemode)),
+            D_GameMissionString(static_cast<GameMission_t>(sv->gamemission)),
+            D_GameModeString(static_cast<GameMode_t>(sv->gamemode)),
             D_GameMissionString(static_cast<GameMission_t>(data.gamemission)),
             D_GameModeString(static_cast<GameMode_t>(data.gamemode)));
 
@@ -688,7 +800,7 @@ static void NET_SV_ParseSYN(net_packet_t *packet, net_client_t *client,
     {
         // find a slot, or return if none found
 
-        for (auto & i : clients)
+        for (auto & i : sv->clients)
         {
             if (!i.active)
             {
@@ -758,10 +870,10 @@ static void NET_SV_ParseLaunch(net_packet_t *, net_client_t *client)
 
     // Can only launch when we are in the waiting state.
 
-    if (server_state != SERVER_WAITING_LAUNCH)
+    if (sv->state != SERVER_WAITING_LAUNCH)
     {
         NET_Log("server: error: not in waiting launch state, state=%d",
-            server_state);
+            sv->state);
         return;
     }
 
@@ -770,7 +882,7 @@ static void NET_SV_ParseLaunch(net_packet_t *, net_client_t *client)
     NET_SV_AssignPlayers();
     int num_players = NET_SV_NumPlayers();
 
-    for (auto &item : clients)
+    for (auto &item : sv->clients)
     {
         if (!ClientConnected(&item))
             continue;
@@ -782,7 +894,7 @@ static void NET_SV_ParseLaunch(net_packet_t *, net_client_t *client)
 
     // Now in launch state.
 
-    server_state = SERVER_WAITING_START;
+    sv->state = SERVER_WAITING_START;
 }
 
 // Transition to the in-game state and send all players the start game
@@ -797,29 +909,29 @@ static void StartGame()
 
     // Check if anyone is recording a demo and set lowres_turn if so.
 
-    sv_settings.lowres_turn = false;
+    sv->settings.lowres_turn = false;
 
-    for (auto & sv_player : sv_players)
+    for (auto & sv_player : sv->players)
     {
         if (sv_player != nullptr && sv_player->recording_lowres)
         {
-            sv_settings.lowres_turn = true;
+            sv->settings.lowres_turn = true;
         }
     }
 
-    sv_settings.num_players = NET_SV_NumPlayers();
+    sv->settings.num_players = NET_SV_NumPlayers();
 
     // Copy player classes:
 
     for (unsigned int i = 0; i < NET_MAXPLAYERS; ++i)
     {
-        if (sv_players[i] != nullptr)
+        if (sv->players[i] != nullptr)
         {
-            sv_settings.player_classes[i] = sv_players[i]->player_class;
+            sv->settings.player_classes[i] = sv->players[i]->player_class;
         }
         else
         {
-            sv_settings.player_classes[i] = 0;
+            sv->settings.player_classes[i] = 0;
         }
     }
 
@@ -827,7 +939,7 @@ static void StartGame()
 
     // Send start packets to each connected node
 
-    for (auto & client : clients)
+    for (auto & client : sv->clients)
     {
         if (!ClientConnected(&client))
             continue;
@@ -837,24 +949,25 @@ static void StartGame()
         net_packet_t *startpacket = NET_Conn_NewReliable(&client.connection,
             NET_PACKET_TYPE_GAMESTART);
 
-        sv_settings.consoleplayer = client.player_number;
+        sv->settings.consoleplayer = client.player_number;
 
-        NET_WriteSettings(startpacket, &sv_settings);
+        NET_WriteSettings(startpacket, &sv->settings);
     }
 
     // Change server state
     NET_Log("server: beginning game state");
-    server_state = SERVER_IN_GAME;
+    sv->state = SERVER_IN_GAME;
+    ++sv->games_started;
 
-    std::memset(recvwindow, 0, sizeof(recvwindow));
-    recvwindow_start = 0;
+    std::memset(sv->recvwindow, 0, sizeof(sv->recvwindow));
+    sv->recvwindow_start = 0;
 }
 
 // Returns true when all nodes have indicated readiness to start the game.
 
 static bool AllNodesReady()
 {
-    for (auto & client : clients)
+    for (auto & client : sv->clients)
     {
         if (ClientConnected(&client) && !client.ready)
         {
@@ -884,7 +997,7 @@ static void CheckStartGame()
 
 static void SendAllWaitingData()
 {
-    for (auto & client : clients)
+    for (auto & client : sv->clients)
     {
         if (ClientConnected(&client) && client.ready)
         {
@@ -903,10 +1016,10 @@ static void NET_SV_ParseGameStart(net_packet_t *packet, net_client_t *client)
 
     // Can only start a game if we are in the waiting start state.
 
-    if (server_state != SERVER_WAITING_START)
+    if (sv->state != SERVER_WAITING_START)
     {
         NET_Log("server: error: not in waiting start state, server_state=%d",
-            server_state);
+            sv->state);
         return;
     }
 
@@ -921,14 +1034,14 @@ static void NET_SV_ParseGameStart(net_packet_t *packet, net_client_t *client)
 
         // Check the game settings are valid
 
-        if (!NET_ValidGameSettings(static_cast<GameMode_t>(sv_gamemode),
-                static_cast<GameMission_t>(sv_gamemission), &settings))
+        if (!NET_ValidGameSettings(static_cast<GameMode_t>(sv->gamemode),
+                static_cast<GameMission_t>(sv->gamemission), &settings))
         {
             NET_Log("server: error: invalid game settings");
             return;
         }
 
-        sv_settings = settings;
+        sv->settings = settings;
     }
 
     client->ready = true;
@@ -955,8 +1068,7 @@ static void NET_SV_SendResendRequest(net_client_t *client, int start, int end)
     NET_WriteInt32(packet, static_cast<unsigned int>(start));
     NET_WriteInt8(packet, static_cast<unsigned int>(end - start + 1));
 
-    NET_Conn_SendPacket(&client->connection, packet);
-    NET_FreePacket(packet);
+    NET_Conn_SendFreePacket(&client->connection, packet);
 
     // Store the time we send the resend request
 
@@ -964,7 +1076,7 @@ static void NET_SV_SendResendRequest(net_client_t *client, int start, int end)
 
     for (int i = start; i <= end; ++i)
     {
-        int index = static_cast<int>(static_cast<unsigned int>(i) - recvwindow_start);
+        int index = static_cast<int>(static_cast<unsigned int>(i) - sv->recvwindow_start);
 
         if (index >= BACKUPTICS)
         {
@@ -973,7 +1085,7 @@ static void NET_SV_SendResendRequest(net_client_t *client, int start, int end)
             continue;
         }
 
-        net_client_recv_t *recvobj = &recvwindow[index][client->player_number];
+        net_client_recv_t *recvobj = &sv->recvwindow[index][client->player_number];
 
         recvobj->resend_time = nowtime;
     }
@@ -990,7 +1102,7 @@ static void NET_SV_CheckResends(net_client_t *client)
 
     for (int i = 0; i < BACKUPTICS; ++i)
     {
-        net_client_recv_t *recvobj = &recvwindow[i][player];
+        net_client_recv_t *recvobj = &sv->recvwindow[i][player];
 
         // if need_resend is true, this tic needs another retransmit
         // request (300ms timeout)
@@ -1013,10 +1125,10 @@ static void NET_SV_CheckResends(net_client_t *client)
             // End of a run of resend tics
             NET_Log("server: resend request to %s timed out for %d-%d (%d)",
                 NET_AddrToString(client->addr),
-                recvwindow_start + static_cast<unsigned int>(resend_start),
-                recvwindow_start + static_cast<unsigned int>(resend_end),
-                &recvwindow[resend_start][player].resend_time);
-            NET_SV_SendResendRequest(client, static_cast<int>(recvwindow_start + static_cast<unsigned int>(resend_start)), static_cast<int>(recvwindow_start + static_cast<unsigned int>(resend_end)));
+                sv->recvwindow_start + static_cast<unsigned int>(resend_start),
+                sv->recvwindow_start + static_cast<unsigned int>(resend_end),
+                &sv->recvwindow[resend_start][player].resend_time);
+            NET_SV_SendResendRequest(client, static_cast<int>(sv->recvwindow_start + static_cast<unsigned int>(resend_start)), static_cast<int>(sv->recvwindow_start + static_cast<unsigned int>(resend_end)));
 
             resend_start = -1;
         }
@@ -1026,10 +1138,10 @@ static void NET_SV_CheckResends(net_client_t *client)
     {
         NET_Log("server: resend request to %s timed out for %d-%d (%d)",
             NET_AddrToString(client->addr),
-            recvwindow_start + static_cast<unsigned int>(resend_start),
-            recvwindow_start + static_cast<unsigned int>(resend_end),
-            &recvwindow[resend_start][player].resend_time);
-        NET_SV_SendResendRequest(client, static_cast<int>(recvwindow_start + static_cast<unsigned int>(resend_start)), static_cast<int>(recvwindow_start + static_cast<unsigned int>(resend_end)));
+            sv->recvwindow_start + static_cast<unsigned int>(resend_start),
+            sv->recvwindow_start + static_cast<unsigned int>(resend_end),
+            &sv->recvwindow[resend_start][player].resend_time);
+        NET_SV_SendResendRequest(client, static_cast<int>(sv->recvwindow_start + static_cast<unsigned int>(resend_start)), static_cast<int>(sv->recvwindow_start + static_cast<unsigned int>(resend_end)));
     }
 }
 
@@ -1037,10 +1149,10 @@ static void NET_SV_CheckResends(net_client_t *client)
 
 static void NET_SV_ParseGameData(net_packet_t *packet, net_client_t *client)
 {
-    if (server_state != SERVER_IN_GAME)
+    if (sv->state != SERVER_IN_GAME)
     {
         NET_Log("server: error: not in game state: server_state=%d",
-            server_state);
+            sv->state);
         return;
     }
 
@@ -1083,12 +1195,12 @@ static void NET_SV_ParseGameData(net_packet_t *packet, net_client_t *client)
         signed int latency = 0;
 
         if (!NET_ReadSInt16(packet, &latency)
-            || !NET_ReadTiccmdDiff(packet, &diff, sv_settings.lowres_turn))
+            || !NET_ReadTiccmdDiff(packet, &diff, sv->settings.lowres_turn))
         {
             return;
         }
 
-        int index = static_cast<int>(seq + i - recvwindow_start);
+        int index = static_cast<int>(seq + i - sv->recvwindow_start);
 
         if (index < 0 || index >= BACKUPTICS)
         {
@@ -1097,7 +1209,7 @@ static void NET_SV_ParseGameData(net_packet_t *packet, net_client_t *client)
             continue;
         }
 
-        net_client_recv_t *recvobj = &recvwindow[index][player];
+        net_client_recv_t *recvobj = &sv->recvwindow[index][player];
         recvobj->active  = true;
         recvobj->diff    = diff;
         recvobj->latency = latency;
@@ -1120,7 +1232,7 @@ static void NET_SV_ParseGameData(net_packet_t *packet, net_client_t *client)
 
     //printf("SV: %p: %i\n", client, seq);
 
-    int resend_end = static_cast<int>(seq - recvwindow_start);
+    int resend_end = static_cast<int>(seq - sv->recvwindow_start);
 
     if (resend_end <= 0)
         return;
@@ -1133,7 +1245,7 @@ static void NET_SV_ParseGameData(net_packet_t *packet, net_client_t *client)
 
     while (index >= 0)
     {
-        net_client_recv_t *recvobj = &recvwindow[index][player];
+        net_client_recv_t *recvobj = &sv->recvwindow[index][player];
 
         if (recvobj->active)
         {
@@ -1157,9 +1269,9 @@ static void NET_SV_ParseGameData(net_packet_t *packet, net_client_t *client)
     if (resend_start < resend_end)
     {
         NET_Log("server: request resend for %d-%d before %d",
-            recvwindow_start + static_cast<unsigned int>(resend_start),
-            recvwindow_start + static_cast<unsigned int>(resend_end) - 1, seq);
-        NET_SV_SendResendRequest(client, static_cast<int>(recvwindow_start + static_cast<unsigned int>(resend_start)), static_cast<int>(recvwindow_start + static_cast<unsigned int>(resend_end) - 1));
+            sv->recvwindow_start + static_cast<unsigned int>(resend_start),
+            sv->recvwindow_start + static_cast<unsigned int>(resend_end) - 1, seq);
+        NET_SV_SendResendRequest(client, static_cast<int>(sv->recvwindow_start + static_cast<unsigned int>(resend_start)), static_cast<int>(sv->recvwindow_start + static_cast<unsigned int>(resend_end) - 1));
     }
 }
 
@@ -1167,10 +1279,10 @@ static void NET_SV_ParseGameDataACK(net_packet_t *packet, net_client_t *client)
 {
     NET_Log("server: processing game data ack packet");
 
-    if (server_state != SERVER_IN_GAME)
+    if (sv->state != SERVER_IN_GAME)
     {
         NET_Log("server: error: not in game state, server_state=%d",
-            server_state);
+            sv->state);
         return;
     }
 
@@ -1220,14 +1332,12 @@ static void NET_SV_SendTics(net_client_t *client,
 
         // Add command
 
-        NET_WriteFullTiccmd(packet, cmd, sv_settings.lowres_turn);
+        NET_WriteFullTiccmd(packet, cmd, sv->settings.lowres_turn);
     }
 
     // Send packet
 
-    NET_Conn_SendPacket(&client->connection, packet);
-
-    NET_FreePacket(packet);
+    NET_Conn_SendFreePacket(&client->connection, packet);
 }
 
 // Parse a retransmission request from a client
@@ -1282,13 +1392,27 @@ void NET_SV_SendQueryResponse(net_addr_t *addr)
 {
     net_querydata_t querydata;
 
+    // Describe the game that a new player would join: the first one
+    // still waiting for players, if any
+
+    sv = sessions[0];
+
+    for (int i = 0; i < num_sessions; ++i)
+    {
+        if (sessions[i]->state == SERVER_WAITING_LAUNCH)
+        {
+            sv = sessions[i];
+            break;
+        }
+    }
+
     // Version
 
     querydata.version = PACKAGE_STRING;
 
     // Server state
 
-    querydata.server_state = server_state;
+    querydata.server_state = sv->state;
 
     // Number of players/maximum players
 
@@ -1297,8 +1421,8 @@ void NET_SV_SendQueryResponse(net_addr_t *addr)
 
     // Game mode/mission
 
-    querydata.gamemode    = static_cast<int>(sv_gamemode);
-    querydata.gamemission = static_cast<int>(sv_gamemission);
+    querydata.gamemode    = static_cast<int>(sv->gamemode);
+    querydata.gamemission = static_cast<int>(sv->gamemission);
 
     //!
     // @category net
@@ -1327,6 +1451,57 @@ void NET_SV_SendQueryResponse(net_addr_t *addr)
     NET_FreePacket(reply);
 }
 
+// Send the statistics of every session, split over as many packets as
+// needed
+
+#define SESSIONS_PER_PACKET 32
+
+static void NET_SV_SendSessionQueryResponse(net_addr_t *addr)
+{
+    int nowtime = I_GetTimeMS();
+
+    NET_Log("server: sending session query response to %s",
+        NET_AddrToString(addr));
+
+    for (int first = 0; first < num_sessions; first += SESSIONS_PER_PACKET)
+    {
+        int count = num_sessions - first;
+
+        if (count > SESSIONS_PER_PACKET)
+        {
+            count = SESSIONS_PER_PACKET;
+        }
+
+        net_packet_t *reply = NET_NewPacket(32 + count * 32);
+        NET_WriteInt16(reply, NET_PACKET_TYPE_SESSION_QUERY_RESPONSE);
+        NET_WriteInt16(reply, static_cast<unsigned int>(num_sessions));
+        NET_WriteInt8(reply, static_cast<unsigned int>(count));
+
+        for (int i = first; i < first + count; ++i)
+        {
+            net_sessiondata_t data;
+
+            sv = sessions[i];
+
+            data.id               = sv->id;
+            data.server_state     = sv->state;
+            data.num_players      = NET_SV_NumPlayers();
+            data.max_players      = NET_SV_MaxPlayers();
+            data.gamemode         = static_cast<int>(sv->gamemode);
+            data.gamemission      = static_cast<int>(sv->gamemission);
+            data.uptime           = static_cast<unsigned int>(nowtime - sv->create_time) / 1000;
+            data.games_started    = sv->games_started;
+            data.tics_run         = sv->tics_run;
+            data.packets_received = sv->packets_received;
+
+            NET_WriteSessionData(reply, &data);
+        }
+
+        NET_SendPacket(addr, reply);
+        NET_FreePacket(reply);
+    }
+}
+
 static void NET_SV_ParseHolePunch(net_packet_t *packet)
 {
     const char *addr_string = NET_ReadString(packet);
@@ -1394,6 +1569,11 @@ static void NET_SV_Packet(net_packet_t *packet, net_addr_t *addr)
 
     net_client_t *client = NET_SV_FindClient(addr);
 
+    if (client != nullptr)
+    {
+        ++sv->packets_received;
+    }
+
     // Read the packet type
 
     unsigned int packet_type = 0;
@@ -1416,6 +1596,10 @@ static void NET_SV_Packet(net_packet_t *packet, net_addr_t *addr)
     {
         NET_SV_SendQueryResponse(addr);
     }
+    else if (packet_type == NET_PACKET_TYPE_SESSION_QUERY)
+    {
+        NET_SV_SendSessionQueryResponse(addr);
+    }
     else if (client == nullptr)
     {
         // Must come from a valid client; ignore otherwise
@@ -1467,7 +1651,7 @@ static void NET_SV_PumpSendQueue(net_client_t *client)
 
     // Work out the index into the receive window
 
-    int recv_index = static_cast<int>(static_cast<unsigned int>(client->sendseq) - recvwindow_start);
+    int recv_index = static_cast<int>(static_cast<unsigned int>(client->sendseq) - sv->recvwindow_start);
 
     if (recv_index < 0 || recv_index >= BACKUPTICS)
     {
@@ -1481,19 +1665,19 @@ static void NET_SV_PumpSendQueue(net_client_t *client)
 
     for (int i = 0; i < NET_MAXPLAYERS; ++i)
     {
-        if (sv_players[i] == client)
+        if (sv->players[i] == client)
         {
             // Client does not rely on itself for data
 
             continue;
         }
 
-        if (sv_players[i] == nullptr || !ClientConnected(sv_players[i]))
+        if (sv->players[i] == nullptr || !ClientConnected(sv->players[i]))
         {
             continue;
         }
 
-        if (!recvwindow[recv_index][i].active)
+        if (!sv->recvwindow[recv_index][i].active)
         {
             // We do not have this player's ticcmd, so we cannot
             // generate a complete command yet.
@@ -1510,7 +1694,7 @@ static void NET_SV_PumpSendQueue(net_client_t *client)
     // and never stopping. Don't let the server get too far ahead
     // of the client.
 
-    if (num_players == 0 && client->sendseq > static_cast<int>(recvwindow_start) + 10)
+    if (num_players == 0 && client->sendseq > static_cast<int>(sv->recvwindow_start) + 10)
     {
         return;
     }
@@ -1526,7 +1710,7 @@ static void NET_SV_PumpSendQueue(net_client_t *client)
 
     for (int i = 0; i < NET_MAXPLAYERS; ++i)
     {
-        if (sv_players[i] == client)
+        if (sv->players[i] == client)
         {
             // Not the player we are sending to
 
@@ -1534,7 +1718,7 @@ static void NET_SV_PumpSendQueue(net_client_t *client)
             continue;
         }
 
-        if (sv_players[i] == nullptr || !recvwindow[recv_index][i].active)
+        if (sv->players[i] == nullptr || !sv->recvwindow[recv_index][i].active)
         {
             cmd.playeringame[i] = false;
             continue;
@@ -1542,7 +1726,7 @@ static void NET_SV_PumpSendQueue(net_client_t *client)
 
         cmd.playeringame[i] = true;
 
-        net_client_recv_t *recvobj= &recvwindow[recv_index][i];
+        net_client_recv_t *recvobj= &sv->recvwindow[recv_index][i];
 
         cmd.cmds[i] = recvobj->diff;
 
@@ -1558,7 +1742,7 @@ static void NET_SV_PumpSendQueue(net_client_t *client)
 
     // Transmit the new tic to the client
 
-    int starttic = client->sendseq - sv_settings.extratics;
+    int starttic = client->sendseq - sv->settings.extratics;
     int endtic   = client->sendseq;
 
     if (starttic < 0)
@@ -1569,6 +1753,10 @@ static void NET_SV_PumpSendQueue(net_client_t *client)
     NET_SV_SendTics(client, static_cast<unsigned int>(starttic), static_cast<unsigned int>(endtic));
 
     ++client->sendseq;
+
+    // Only one tic is generated per run; there may be more ready
+
+    sv_run_again = true;
 }
 
 // Prevent against deadlock: resend requests are usually only
@@ -1602,14 +1790,14 @@ void NET_SV_CheckDeadlock(net_client_t *client)
         int i = 0;
         for (i = 0; i < BACKUPTICS; ++i)
         {
-            if (!recvwindow[client->player_number][i].active)
+            if (!sv->recvwindow[client->player_number][i].active)
             {
                 NET_Log("server: deadlock: sending resend request for %d-%d",
-                    recvwindow_start + static_cast<unsigned int>(i), recvwindow_start + static_cast<unsigned int>(i) + 5);
+                    sv->recvwindow_start + static_cast<unsigned int>(i), sv->recvwindow_start + static_cast<unsigned int>(i) + 5);
 
                 // Found a tic we haven't received.  Send a resend request.
 
-                NET_SV_SendResendRequest(client, static_cast<int>(recvwindow_start + static_cast<unsigned int>(i)), static_cast<int>(recvwindow_start + static_cast<unsigned int>(i) + 5));
+                NET_SV_SendResendRequest(client, static_cast<int>(sv->recvwindow_start + static_cast<unsigned int>(i)), static_cast<int>(sv->recvwindow_start + static_cast<unsigned int>(i) + 5));
 
                 client->last_gamedata_time = nowtime;
                 break;
@@ -1635,10 +1823,10 @@ void NET_SV_CheckDeadlock(net_client_t *client)
 
 static void NET_SV_GameEnded()
 {
-    server_state = SERVER_WAITING_LAUNCH;
-    sv_gamemode  = indetermined;
+    sv->state    = SERVER_WAITING_LAUNCH;
+    sv->gamemode = indetermined;
 
-    for (auto & client : clients)
+    for (auto & client : sv->clients)
     {
         if (client.active)
         {
@@ -1673,7 +1861,7 @@ static void NET_SV_RunClient(net_client_t *client)
         // If we were about to start a game, any player disconnecting
         // should cause an abort.
 
-        if (server_state == SERVER_WAITING_START && !client->drone)
+        if (sv->state == SERVER_WAITING_START && !client->drone)
         {
             NET_SV_BroadcastMessage("Game startup aborted because "
                                     "player '%s' disconnected.",
@@ -1703,7 +1891,7 @@ static void NET_SV_RunClient(net_client_t *client)
         return;
     }
 
-    if (server_state == SERVER_WAITING_LAUNCH)
+    if (sv->state == SERVER_WAITING_LAUNCH)
     {
         // Waiting for the game to start
 
@@ -1717,7 +1905,7 @@ static void NET_SV_RunClient(net_client_t *client)
         }
     }
 
-    if (server_state == SERVER_IN_GAME)
+    if (sv->state == SERVER_IN_GAME)
     {
         NET_SV_PumpSendQueue(client);
         NET_SV_CheckDeadlock(client);
@@ -1740,17 +1928,31 @@ void NET_SV_Init()
 
     server_context = NET_NewContext();
 
-    // no clients yet
+    //!
+    // @arg <n>
+    // @category net
+    //
+    // When running a server, host up to <n> independent games at once
+    // (default 1).  New players join a game of the same kind that is
+    // still waiting for players, or else start a new one.
+    //
+
+    int p = M_CheckParmWithArgs("-sessions", 1);
 
-    for (auto & client : clients)
+    if (p > 0)
     {
-        client.active = false;
+        max_sessions = std::atoi(myargv[p + 1]);
+
+        if (max_sessions < 1)
+        {
+            max_sessions = 1;
+        }
     }
 
-    NET_SV_AssignPlayers();
+    // Start with one session and no clients
+
+    sv = NET_SV_NewSession();
 
-    server_state       = SERVER_WAITING_LAUNCH;
-    sv_gamemode        = indetermined;
     server_initialized = true;
 }
 
@@ -1807,6 +2009,44 @@ void NET_SV_RegisterWithMaster()
     }
 }
 
+// Run the current session
+
+static void NET_SV_RunSession()
+{
+    // "Run" any clients that may have things to do, independent of responses
+    // to received packets
+
+    for (auto & client : sv->clients)
+    {
+        if (client.active)
+        {
+            NET_SV_RunClient(&client);
+        }
+    }
+
+    switch (sv->state)
+    {
+    case SERVER_WAITING_LAUNCH:
+        break;
+
+    case SERVER_WAITING_START:
+        CheckStartGame();
+        break;
+
+    case SERVER_IN_GAME:
+        NET_SV_AdvanceWindow();
+
+        for (auto & sv_player : sv->players)
+        {
+            if (sv_player != nullptr && ClientConnected(sv_player))
+            {
+                NET_SV_CheckResends(sv_player);
+            }
+        }
+        break;
+    }
+}
+
 // Run server code to check for new packets/send packets as the server
 // requires
 
@@ -1818,6 +2058,9 @@ void NET_SV_Run()
     }
     net_addr_t   *addr   = nullptr;
     net_packet_t *packet = nullptr;
+
+    sv_run_again = false;
+
     while (NET_RecvPacket(server_context, &addr, &packet))
     {
         NET_SV_Packet(packet, addr);
@@ -1830,38 +2073,133 @@ void NET_SV_Run()
         UpdateMasterServer();
     }
 
-    // "Run" any clients that may have things to do, independent of responses
-    // to received packets
+    for (int i = 0; i < num_sessions; ++i)
+    {
+        sv = sessions[i];
+        NET_SV_RunSession();
+    }
+}
 
-    for (auto & client : clients)
+// The part of NET_SV_Timeout() for the current session
+
+static int NET_SV_SessionTimeout(int nowtime, int timeout)
+{
+    int left;
+
+    for (auto & client : sv->clients)
     {
-        if (client.active)
+        if (!client.active)
         {
-            NET_SV_RunClient(&client);
+            continue;
         }
-    }
 
-    switch (server_state)
-    {
-    case SERVER_WAITING_LAUNCH:
-        break;
+        if (client.connection.state == NET_CONN_STATE_DISCONNECTED)
+        {
+            return 0;
+        }
 
-    case SERVER_WAITING_START:
-        CheckStartGame();
-        break;
+        timeout = NET_Conn_Timeout(&client.connection, nowtime, timeout);
 
-    case SERVER_IN_GAME:
-        NET_SV_AdvanceWindow();
+        if (!ClientConnected(&client))
+        {
+            continue;
+        }
 
-        for (auto & sv_player : sv_players)
+        if (sv->state == SERVER_WAITING_LAUNCH)
         {
-            if (sv_player != nullptr && ClientConnected(sv_player))
+            if (client.last_send_time < 0)
             {
-                NET_SV_CheckResends(sv_player);
+                return 0;
+            }
+
+            left = NET_TimeLeft(nowtime, client.last_send_time, 1000);
+        }
+        else if (sv->state == SERVER_IN_GAME && !client.drone)
+        {
+            // NET_SV_CheckDeadlock() keeps checking every run until the
+            // client sends something, so don't spin while it does.
+
+            left = NET_TimeLeft(nowtime, client.last_gamedata_time, 1000);
+            if (left < 1)
+                left = 1;
+        }
+        else
+        {
+            continue;
+        }
+
+        if (left < timeout)
+            timeout = left;
+    }
+
+    if (sv->state == SERVER_IN_GAME)
+    {
+        for (auto & sv_player : sv->players)
+        {
+            if (sv_player == nullptr || !ClientConnected(sv_player))
+            {
+                continue;
+            }
+
+            for (auto & recv : sv->recvwindow)
+            {
+                net_client_recv_t *recvobj = &recv[sv_player->player_number];
+
+                if (!recvobj->active && recvobj->resend_time != 0)
+                {
+                    left = NET_TimeLeft(nowtime,
+                        static_cast<int>(recvobj->resend_time), 300);
+                    if (left < timeout)
+                        timeout = left;
+                }
             }
         }
-        break;
     }
+
+    return timeout;
+}
+
+// Returns the number of milliseconds until NET_SV_Run() next has
+// something to do that isn't triggered by a packet arriving: keepalives,
+// reliable packet and resend request timeouts, and so on.  These mirror
+// the checks in NET_SV_RunClient() and NET_SV_CheckResends().
+
+static int NET_SV_Timeout()
+{
+    if (sv_run_again)
+    {
+        return 0;
+    }
+
+    int nowtime = I_GetTimeMS();
+    int timeout = MAX_WAIT_TIME;
+    int left;
+
+    if (master_server != nullptr)
+    {
+        left = NET_TimeLeft(nowtime, static_cast<int>(master_refresh_time),
+            MASTER_REFRESH_PERIOD * 1000);
+        if (left < timeout)
+            timeout = left;
+    }
+
+    for (int i = 0; i < num_sessions && timeout > 0; ++i)
+    {
+        sv      = sessions[i];
+        timeout = NET_SV_SessionTimeout(nowtime, timeout);
+    }
+
+    return timeout;
+}
+
+void NET_SV_WaitForPackets()
+{
+    if (!server_initialized)
+    {
+        return;
+    }
+
+    NET_WaitForPackets(server_context, NET_SV_Timeout());
 }
 
 void NET_SV_Shutdown()
@@ -1875,11 +2213,14 @@ void NET_SV_Shutdown()
 
     // Disconnect all clients
 
-    for (auto & client : clients)
+    for (int i = 0; i < num_sessions; ++i)
     {
-        if (client.active)
+        for (auto & client : sessions[i]->clients)
         {
-            NET_SV_DisconnectClient(&client);
+            if (client.active)
+            {
+                NET_SV_DisconnectClient(&client);
+            }
         }
     }
 
@@ -1894,11 +2235,14 @@ void NET_SV_Shutdown()
 
         running = false;
 
-        for (auto & client : clients)
+        for (int i = 0; i < num_sessions; ++i)
         {
-            if (client.active)
+            for (auto & client : sessions[i]->clients)
             {
-                running = true;
+                if (client.active)
+                {
+                    running = true;
+                }
             }
         }
 
@@ -25,6 +25,10 @@ void NET_SV_Init();
 
 void NET_SV_Run();
 
+// Block until a packet arrives or NET_SV_Run() has something to do
+
+void NET_SV_WaitForPackets();
+
 // Shut down the server
 // Blocks until all clients disconnect, or until a 5-second timeout
 
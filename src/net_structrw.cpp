@@ -161,6 +161,34 @@ void NET_WriteQueryData(net_packet_t *packet, net_querydata_t *query)
     NET_WriteProtocolList(packet);
 }
 
+bool NET_ReadSessionData(net_packet_t *packet, net_sessiondata_t *data)
+{
+    return NET_ReadInt16(packet, reinterpret_cast<unsigned int *>(&data->id))
+           && NET_ReadInt8(packet, reinterpret_cast<unsigned int *>(&data->server_state))
+           && NET_ReadInt8(packet, reinterpret_cast<unsigned int *>(&data->num_players))
+           && NET_ReadInt8(packet, reinterpret_cast<unsigned int *>(&data->max_players))
+           && NET_ReadInt8(packet, reinterpret_cast<unsigned int *>(&data->gamemode))
+           && NET_ReadInt8(packet, reinterpret_cast<unsigned int *>(&data->gamemission))
+           && NET_ReadInt32(packet, &data->uptime)
+           && NET_ReadInt32(packet, &data->games_started)
+           && NET_ReadInt32(packet, &data->tics_run)
+           && NET_ReadInt32(packet, &data->packets_received);
+}
+
+void NET_WriteSessionData(net_packet_t *packet, net_sessiondata_t *data)
+{
+    NET_WriteInt16(packet, static_cast<unsigned int>(data->id));
+    NET_WriteInt8(packet, static_cast<unsigned int>(data->server_state));
+    NET_WriteInt8(packet, static_cast<unsigned int>(data->num_players));
+    NET_WriteInt8(packet, static_cast<unsigned int>(data->max_players));
+    NET_WriteInt8(packet, static_cast<unsigned int>(data->gamemode));
+    NET_WriteInt8(packet, static_cast<unsigned int>(data->gamemission));
+    NET_WriteInt32(packet, data->uptime);
+    NET_WriteInt32(packet, data->games_started);
+    NET_WriteInt32(packet, data->tics_run);
+    NET_WriteInt32(packet, data->packets_received);
+}
+
 void NET_WriteTiccmdDiff(net_packet_t *packet, net_ticdiff_t *diff,
     bool lowres_turn)
 {
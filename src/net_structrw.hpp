@@ -29,6 +29,9 @@ extern bool NET_ReadSettings(net_packet_t *packet, net_gamesettings_t *settings)
 extern void    NET_WriteQueryData(net_packet_t *packet, net_querydata_t *querydata);
 extern bool NET_ReadQueryData(net_packet_t *packet, net_querydata_t *querydata);
 
+extern void    NET_WriteSessionData(net_packet_t *packet, net_sessiondata_t *data);
+extern bool NET_ReadSessionData(net_packet_t *packet, net_sessiondata_t *data);
+
 extern void    NET_WriteTiccmdDiff(net_packet_t *packet, net_ticdiff_t *diff, bool lowres_turn);
 extern bool NET_ReadTiccmdDiff(net_packet_t *packet, net_ticdiff_t *diff, bool lowres_turn);
 extern void    NET_TiccmdDiff(ticcmd_t *tic1, ticcmd_t *tic2, net_ticdiff_t *diff);
@@ -0,0 +1,204 @@
+//
+// Copyright(C) 2005-2014 Simon Howard
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//     Regression test for the OPL3 emulator: renders fixed register
+//     streams through the block based OPL3_GenerateStream() and the
+//     per-sample reference in opl3_ref.cpp, and checks that every
+//     output sample is the same.
+//
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "opl3.hpp"
+
+namespace opl3_ref
+{
+void OPL3_Reset(opl3_chip *chip, Bit32u samplerate);
+void OPL3_WriteRegBuffered(opl3_chip *chip, Bit16u reg, Bit8u v);
+void OPL3_GenerateStream(opl3_chip *chip, Bit16s *sndptr, Bit32u numsamples);
+}
+
+#define MAXSAMPLES 5000 // 1/20 s at 96000 Hz
+
+static opl3_chip chip, refchip;
+static Bit16s    buf[MAXSAMPLES * 2], refbuf[MAXSAMPLES * 2];
+
+// Fixed pseudo-random numbers, the same everywhere unlike rand()
+
+static unsigned int seed;
+
+static unsigned int Random()
+{
+    seed = seed * 1103515245 + 12345;
+    return (seed >> 16) & 0x7fff;
+}
+
+static void WriteReg(unsigned int reg, unsigned int val)
+{
+    OPL3_WriteRegBuffered(&chip, reg, val);
+    opl3_ref::OPL3_WriteRegBuffered(&refchip, reg, val);
+}
+
+// Returns the index of the first sample that differs, or -1
+
+static int Generate(unsigned int numsamples)
+{
+    OPL3_GenerateStream(&chip, buf, numsamples);
+    opl3_ref::OPL3_GenerateStream(&refchip, refbuf, numsamples);
+
+    for (unsigned int i = 0; i < numsamples * 2; ++i)
+    {
+        if (buf[i] != refbuf[i])
+        {
+            return i / 2;
+        }
+    }
+
+    return -1;
+}
+
+// Notes on all channels in OPL3 mode, with every waveform, some 4-op
+// channels and the rhythm section, keyed on and off in turn.
+
+static int MusicStream(unsigned int rate)
+{
+    WriteReg(0x105, 0x01); // OPL3 mode
+    WriteReg(0x104, 0x09); // 4-op on channels 0 and 3 of both banks
+    WriteReg(0x01, 0x20);  // waveform select
+
+    for (unsigned int bank = 0; bank < 0x200; bank += 0x100)
+    {
+        for (unsigned int op = 0; op < 0x16; ++op)
+        {
+            if ((op & 7) > 5)
+            {
+                continue;
+            }
+
+            WriteReg(bank + 0x20 + op, 0x21 + (op & 0x0f));
+            WriteReg(bank + 0x40 + op, (op * 5) & 0x3f);
+            WriteReg(bank + 0x60 + op, 0xf1 + (op & 3) * 0x10);
+            WriteReg(bank + 0x80 + op, 0x36 + (op & 7));
+            WriteReg(bank + 0xe0 + op, op & 7);
+        }
+
+        for (unsigned int ch = 0; ch < 9; ++ch)
+        {
+            WriteReg(bank + 0xc0 + ch, 0x30 | (ch & 1) | (ch % 7) << 1);
+        }
+    }
+
+    for (unsigned int step = 0; step < 200; ++step)
+    {
+        for (unsigned int ch = 0; ch < 9; ++ch)
+        {
+            unsigned int bank = (step + ch) & 1 ? 0x100 : 0;
+            unsigned int fnum = 0x157 + ((step * 37 + ch * 11) & 0x1ff);
+            bool         on   = (step + ch) % 3 != 0;
+
+            WriteReg(bank + 0xa0 + ch, fnum & 0xff);
+            WriteReg(bank + 0xb0 + ch, (on ? 0x20 : 0) | (step % 8) << 2 | fnum >> 8);
+        }
+
+        WriteReg(0xbd, step & 0x20 ? 0xe0 | (step & 0x1f) : 0xc0);
+
+        int mismatch = Generate(rate / 70 + step % 3);
+
+        if (mismatch >= 0)
+        {
+            return mismatch;
+        }
+    }
+
+    return -1;
+}
+
+// Random writes to any register, mostly key on/off, between blocks of
+// up to 1/80 s, or 1/20 s now and then.  The chip runs at its native
+// rate whatever the output rate, so lengths are in time, not samples.
+
+static int RandomStream(unsigned int rate)
+{
+    for (unsigned int step = 0; step < 300; ++step)
+    {
+        unsigned int numwrites = Random() % 12;
+
+        for (unsigned int i = 0; i < numwrites; ++i)
+        {
+            unsigned int reg = Random() & 0x1ff;
+
+            if (Random() % 4 == 0)
+            {
+                reg = 0xb0 + Random() % 9 + (Random() & 1 ? 0x100 : 0);
+            }
+
+            WriteReg(reg, Random() & 0xff);
+        }
+
+        int mismatch = Generate(Random() % (step % 50 == 0 ? rate / 20 : rate / 80));
+
+        if (mismatch >= 0)
+        {
+            return mismatch;
+        }
+    }
+
+    return -1;
+}
+
+int main()
+{
+    // The chip's native rate first, where no resampling is done
+
+    static const unsigned int rates[] = {
+        49716, 44100, 48000, 22050, 11025, 96000, 8000, 1000
+    };
+    static const struct
+    {
+        const char *name;
+        int (*run)(unsigned int rate);
+    } streams[] = {
+        {"music",  MusicStream },
+        {"random", RandomStream},
+    };
+    int failures = 0;
+
+    for (const auto &stream : streams)
+    {
+        seed = 1;
+
+        for (unsigned int rate : rates)
+        {
+            OPL3_Reset(&chip, rate);
+            opl3_ref::OPL3_Reset(&refchip, rate);
+
+            int mismatch = stream.run(rate);
+
+            if (mismatch >= 0)
+            {
+                printf("%s, %u Hz: output differs at sample %d of a block\n",
+                       stream.name, rate, mismatch);
+                ++failures;
+            }
+            else
+            {
+                printf("%s, %u Hz: ok\n", stream.name, rate);
+            }
+        }
+    }
+
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,209 @@
+//
+// Copyright(C) 2005-2014 Simon Howard
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//     Regression test for the SIMD drawers in r_simd.cpp: runs each
+//     set this CPU supports and the scalar drawers over a range of
+//     span and column parameters, including negative fracs, odd
+//     lengths and a non-power-of-2 texture height, and checks that
+//     they draw exactly the same pixels.
+//
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "SDL.h"
+
+#include "crispy.hpp"
+#include "doomdef.hpp"
+#include "i_video.hpp"
+#include "r_local.hpp"
+#include "r_simd.hpp"
+#include "v_trans.hpp"
+
+#define TESTWIDTH  67
+#define TESTHEIGHT 67
+#define TESTTEXH   128
+
+static uint8_t      source[64 * 64 + TESTTEXH];
+static uint8_t      brightmap[256];
+static lighttable_t colormap[2][256];
+static uint8_t      testtranmap[256 * 256];
+static int          identity[TESTWIDTH];
+static pixel_t     *buffers[2];
+
+// Fixed pseudo-random numbers, the same everywhere unlike rand()
+
+static uint32_t seed;
+
+static int Random()
+{
+    seed = seed * 1103515245u + 12345u;
+    return static_cast<int>((seed >> 8) & 0x7fffff);
+}
+
+typedef void (*drawerfunc_t)(r_draw_t *);
+
+// Returns the first run that differs, or -1
+
+static int CompareDrawers(drawerfunc_t ref, drawerfunc_t test, bool span)
+{
+    const size_t size = static_cast<size_t>(SCREENWIDTH) * TESTHEIGHT;
+    r_draw_t     draw = *g_r_draw_globals;
+
+    seed = 1;
+
+    for (int run = 0; run < 256; run++)
+    {
+        const int a = Random() % TESTWIDTH;
+        const int b = Random() % TESTWIDTH;
+        const int c = Random();
+        const int d = Random();
+        const int e = Random() - 0x400000;
+        const int f = Random() - 0x400000;
+
+        for (int pass = 0; pass < 2; pass++)
+        {
+            std::memset(buffers[pass], 0, size * sizeof(pixel_t));
+
+            for (int i = 0; i < TESTHEIGHT; i++)
+                ylookup[i] = buffers[pass] + i * SCREENWIDTH;
+
+            if (span)
+            {
+                draw.ds_y           = a;
+                draw.ds_x1          = a < b ? a : b;
+                draw.ds_x2          = a < b ? b : a;
+                draw.ds_xfrac       = c << 8;
+                draw.ds_yfrac       = d << 8;
+                draw.ds_xstep       = e;
+                draw.ds_ystep       = f;
+                draw.ds_source      = source;
+                draw.ds_brightmap   = brightmap;
+                draw.ds_colormap[0] = colormap[0];
+                draw.ds_colormap[1] = colormap[1];
+            }
+            else
+            {
+                draw.dc_x           = a;
+                draw.dc_yl          = a < b ? a : b;
+                draw.dc_yh          = a < b ? b : a;
+                draw.dc_iscale      = (e & 0x3ffff) + 1;
+                draw.dc_texturemid  = f << 4;
+                draw.dc_texheight   = (run & 1) ? TESTTEXH : TESTTEXH - 28;
+                draw.dc_source      = source + (run & 2 ? TESTTEXH : 0);
+                draw.dc_brightmap   = brightmap;
+                draw.dc_colormap[0] = colormap[0];
+                draw.dc_colormap[1] = colormap[1];
+
+                if (ref == R_DrawTLColumn)
+                {
+                    // the translucent drawer does not wrap, so keep its
+                    //  texture rows within the source
+                    draw.dc_iscale     = (e & 0x7fff) + 1;
+                    draw.dc_texturemid = (TESTTEXH << FRACBITS) - (draw.dc_yl - centery) * draw.dc_iscale;
+                }
+            }
+
+            (pass ? test : ref)(&draw);
+        }
+
+        if (std::memcmp(buffers[0], buffers[1], size * sizeof(pixel_t)))
+        {
+            return run;
+        }
+    }
+
+    return -1;
+}
+
+int main(int, char **)
+{
+    int failures = 0;
+    int i;
+
+    // as set up by I_InitGraphics()
+    SCREENWIDTH  = ORIGWIDTH << crispy->hires;
+    SCREENHEIGHT = ORIGHEIGHT << crispy->hires;
+
+    const size_t size = static_cast<size_t>(SCREENWIDTH) * TESTHEIGHT;
+
+    seed = 1;
+
+    for (i = 0; i < static_cast<int>(sizeof(source)); i++)
+        source[i] = static_cast<uint8_t>(Random());
+    for (i = 0; i < static_cast<int>(sizeof(testtranmap)); i++)
+        testtranmap[i] = static_cast<uint8_t>(Random());
+    for (i = 0; i < 256; i++)
+    {
+        brightmap[i]   = static_cast<uint8_t>(Random() & 1);
+        colormap[0][i] = static_cast<lighttable_t>(Random());
+        colormap[1][i] = static_cast<lighttable_t>(Random());
+    }
+    for (i = 0; i < TESTWIDTH; i++)
+    {
+        identity[i]  = i;
+        columnofs[i] = i;
+    }
+
+    g_r_state_globals->flipviewwidth = identity;
+    tranmap                          = testtranmap;
+    centery                          = TESTHEIGHT / 2;
+
+    buffers[0] = static_cast<pixel_t *>(malloc(size * sizeof(pixel_t)));
+    buffers[1] = static_cast<pixel_t *>(malloc(size * sizeof(pixel_t)));
+
+    static const struct
+    {
+        const char  *name;
+        drawerfunc_t ref;
+        bool         span;
+    } drawers[] = {
+        {"column",   R_DrawColumn,   false},
+        {"tlcolumn", R_DrawTLColumn, false},
+        {"span",     R_DrawSpan,     true },
+    };
+
+    for (const simddrawers_t *set = simddrawers; set->name != nullptr; set++)
+    {
+        if (!set->supported())
+        {
+            printf("%s: not supported by this CPU, skipped\n", set->name);
+            continue;
+        }
+
+        const drawerfunc_t tests[] = { set->colfunc, set->tlcolfunc, set->spanfunc };
+
+        for (i = 0; i < static_cast<int>(sizeof(tests) / sizeof(*tests)); i++)
+        {
+            int mismatch = CompareDrawers(drawers[i].ref, tests[i], drawers[i].span);
+
+            if (mismatch >= 0)
+            {
+                printf("%s %s: output differs in run %d\n",
+                       set->name, drawers[i].name, mismatch);
+                ++failures;
+            }
+            else
+            {
+                printf("%s %s: ok\n", set->name, drawers[i].name);
+            }
+        }
+    }
+
+    free(buffers[0]);
+    free(buffers[1]);
+
+    return failures > 0 ? 1 : 0;
+}
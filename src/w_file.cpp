@@ -42,6 +42,16 @@ static wad_file_class_t *wad_file_classes[] = {
 
 wad_file_t *W_OpenFile(const char *path)
 {
+#ifdef HAVE_MMAP
+    //!
+    // @category obscure
+    //
+    // Read WAD files through stdio instead of mapping them into
+    // memory with mmap(), which is the default where available.
+    //
+
+    if (M_CheckParm("-nommap"))
+#else
     //!
     // @category obscure
     //
@@ -50,6 +60,7 @@ wad_file_t *W_OpenFile(const char *path)
     //
 
     if (!M_CheckParm("-mmap"))
+#endif
     {
         return stdc_wad_file.OpenFile(path);
     }
@@ -81,3 +92,12 @@ size_t W_Read(wad_file_t *wad, unsigned int offset,
 {
     return wad->file_class->Read(wad, offset, buffer, buffer_len);
 }
+
+void W_Advise(wad_file_t *wad, unsigned int offset,
+    size_t len, wad_advice_t advice)
+{
+    if (wad->file_class->Advise != nullptr)
+    {
+        wad->file_class->Advise(wad, offset, len, advice);
+    }
+}
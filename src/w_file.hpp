@@ -25,6 +25,15 @@
 
 using wad_file_t = struct _wad_file_s;
 
+// [crispy] expected access pattern of a range of a WAD file
+enum wad_advice_t
+{
+    WAD_ADVICE_NORMAL,
+    WAD_ADVICE_SEQUENTIAL, // read front to back, e.g. at startup
+    WAD_ADVICE_RANDOM,     // lumps picked here and there, e.g. in play
+    WAD_ADVICE_WILLNEED,   // about to be read, page it in now
+};
+
 typedef struct
 {
     // Open a file for reading.
@@ -37,6 +46,11 @@ typedef struct
     // provided buffer.  Returns the number of bytes read.
     size_t (*Read)(wad_file_t *file, unsigned int offset,
         void *buffer, size_t buffer_len);
+
+    // [crispy] Hint how the given range of a memory-mapped file is
+    // going to be accessed.  nullptr if the class cannot use hints.
+    void (*Advise)(wad_file_t *file, unsigned int offset,
+        size_t len, wad_advice_t advice);
 } wad_file_class_t;
 
 struct _wad_file_s {
@@ -70,4 +84,10 @@ void W_CloseFile(wad_file_t *wad);
 size_t W_Read(wad_file_t *wad, unsigned int offset,
     void *buffer, size_t buffer_len);
 
+// [crispy] Hint how the given range of the file is going to be
+// accessed.  Does nothing if the file is not memory-mapped.
+
+void W_Advise(wad_file_t *wad, unsigned int offset,
+    size_t len, wad_advice_t advice);
+
 #endif /* #ifndef __W_FILE__ */
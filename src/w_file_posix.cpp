@@ -20,12 +20,13 @@
 
 #ifdef HAVE_MMAP
 
-#include <errno.h>
+#include <cerrno>
+#include <cstring>
 #include <fcntl.h>
 #include <unistd.h>
 #include <sys/mman.h>
-#include <string.h>
 
+#include "memory.hpp"
 #include "m_misc.hpp"
 #include "w_file.hpp"
 #include "z_zone.hpp"
@@ -60,18 +61,19 @@ static void MapFile(posix_wad_file_t *wad, const char *filename)
         protection, flags,
         wad->handle, 0);
 
-    wad->wad.mapped = result;
-
-    if (result == nullptr)
+    if (result == MAP_FAILED)
     {
         fprintf(stderr, "W_POSIX_OpenFile: Unable to mmap() %s - %s\n",
             filename, strerror(errno));
+        result = nullptr;
     }
+
+    wad->wad.mapped = static_cast<uint8_t *>(result);
 }
 
-unsigned int GetFileLength(int handle)
+static unsigned int GetFileLength(int handle)
 {
-    return lseek(handle, 0, SEEK_END);
+    return static_cast<unsigned int>(lseek(handle, 0, SEEK_END));
 }
 
 static wad_file_t *W_POSIX_OpenFile(const char *path)
@@ -79,7 +81,7 @@ static wad_file_t *W_POSIX_OpenFile(const char *path)
     posix_wad_file_t *result;
     int               handle;
 
-    handle = open(path, 0);
+    handle = open(path, O_RDONLY);
 
     if (handle < 0)
     {
@@ -88,27 +90,35 @@ static wad_file_t *W_POSIX_OpenFile(const char *path)
 
     // Create a new posix_wad_file_t to hold the file handle.
 
-    result                 = Z_Malloc(sizeof(posix_wad_file_t), PU_STATIC, 0);
+    result                 = zmalloc<posix_wad_file_t *>(sizeof(posix_wad_file_t), PU_STATIC, 0);
     result->wad.file_class = &posix_wad_file;
+    result->wad.mapped     = nullptr;
     result->wad.length     = GetFileLength(handle);
     result->wad.path       = M_StringDuplicate(path);
     result->handle         = handle;
 
-    // Try to map the file into memory with mmap:
+    // Try to map the file into memory with mmap.  An empty file
+    // cannot be mapped, but there is nothing to read from it anyway.
 
-    MapFile(result, path);
+    if (result->wad.length > 0)
+    {
+        MapFile(result, path);
+    }
 
     return &result->wad;
 }
 
 static void W_POSIX_CloseFile(wad_file_t *wad)
 {
-    posix_wad_file_t *posix_wad;
-
-    posix_wad = (posix_wad_file_t *)wad;
+    auto *posix_wad = reinterpret_cast<posix_wad_file_t *>(wad);
 
     // If mapped, unmap it.
 
+    if (posix_wad->wad.mapped != nullptr)
+    {
+        munmap(posix_wad->wad.mapped, posix_wad->wad.length);
+    }
+
     // Close the file
 
     close(posix_wad->handle);
@@ -118,31 +128,25 @@ static void W_POSIX_CloseFile(wad_file_t *wad)
 // Read data from the specified position in the file into the
 // provided buffer.  Returns the number of bytes read.
 
-size_t W_POSIX_Read(wad_file_t *wad, unsigned int offset,
+static size_t W_POSIX_Read(wad_file_t *wad, unsigned int offset,
     void *buffer, size_t buffer_len)
 {
-    posix_wad_file_t *posix_wad;
-    byte *            byte_buffer;
-    size_t            bytes_read;
-    int               result;
-
-    posix_wad = (posix_wad_file_t *)wad;
-
-    // Jump to the specified position in the file.
-
-    lseek(posix_wad->handle, offset, SEEK_SET);
+    auto *  posix_wad   = reinterpret_cast<posix_wad_file_t *>(wad);
+    auto *  byte_buffer = static_cast<uint8_t *>(buffer);
+    size_t  bytes_read  = 0;
+    ssize_t result;
 
     // Read into the buffer.
 
-    bytes_read  = 0;
-    byte_buffer = buffer;
-
     while (buffer_len > 0)
     {
-        result = read(posix_wad->handle, byte_buffer, buffer_len);
+        result = pread(posix_wad->handle, byte_buffer, buffer_len, offset);
 
         if (result < 0)
         {
+            if (errno == EINTR)
+                continue;
+
             perror("W_POSIX_Read");
             break;
         }
@@ -154,18 +158,58 @@ size_t W_POSIX_Read(wad_file_t *wad, unsigned int offset,
         // Successfully read some bytes
 
         byte_buffer += result;
-        buffer_len -= result;
-        bytes_read += result;
+        buffer_len -= static_cast<size_t>(result);
+        bytes_read += static_cast<size_t>(result);
+        offset += static_cast<unsigned int>(result);
     }
 
     return bytes_read;
 }
 
+// [crispy] Tell the kernel how a range of the mapped file is going to
+// be accessed, so it can adjust its readahead or start paging it in.
+
+static void W_POSIX_Advise(wad_file_t *wad, unsigned int offset,
+    size_t len, wad_advice_t advice)
+{
+    static const int advices[] = {
+        MADV_NORMAL,     // WAD_ADVICE_NORMAL
+        MADV_SEQUENTIAL, // WAD_ADVICE_SEQUENTIAL
+        MADV_RANDOM,     // WAD_ADVICE_RANDOM
+        MADV_WILLNEED,   // WAD_ADVICE_WILLNEED
+    };
+    static uintptr_t pagemask;
+    uintptr_t        start, end;
+
+    if (wad->mapped == nullptr || offset >= wad->length)
+    {
+        return;
+    }
+
+    if (pagemask == 0)
+    {
+        pagemask = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE)) - 1;
+    }
+
+    if (len > wad->length - offset)
+    {
+        len = wad->length - offset;
+    }
+
+    // madvise() wants a page aligned address
+
+    start = reinterpret_cast<uintptr_t>(wad->mapped + offset) & ~pagemask;
+    end   = reinterpret_cast<uintptr_t>(wad->mapped + offset + len);
+
+    madvise(reinterpret_cast<void *>(start), end - start, advices[advice]);
+}
+
 
 wad_file_class_t posix_wad_file = {
     W_POSIX_OpenFile,
     W_POSIX_CloseFile,
     W_POSIX_Read,
+    W_POSIX_Advise,
 };
 
 
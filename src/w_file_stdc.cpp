@@ -83,4 +83,5 @@ wad_file_class_t stdc_wad_file = {
     W_StdC_OpenFile,
     W_StdC_CloseFile,
     W_StdC_Read,
+    nullptr,
 };
@@ -455,6 +455,47 @@ void W_ReleaseLumpName(const char *name)
     W_ReleaseLumpNum(W_GetNumForName(name));
 }
 
+//
+// [crispy] Hint how all the loaded WAD files are going to be accessed,
+// e.g. sequentially while the texture directory is being read at
+// startup, randomly while playing.
+//
+
+void W_AdviseAll(wad_advice_t advice)
+{
+    wad_file_t *last = nullptr;
+
+    // lumps from the same file are adjacent in the directory
+    for (size_t i = 0; i < numlumps; i++)
+    {
+        if (lumpinfo[i]->wad_file != last)
+        {
+            last = lumpinfo[i]->wad_file;
+            W_Advise(last, 0, last->length, advice);
+        }
+    }
+}
+
+//
+// [crispy] Start paging in a lump from a memory-mapped file that is
+// about to be read, so that the actual accesses don't block on disk.
+//
+
+void W_PrefetchLumpNum(lumpindex_t lumpnum)
+{
+    if (static_cast<unsigned>(lumpnum) >= numlumps)
+    {
+        I_Error("W_PrefetchLumpNum: %i >= numlumps", lumpnum);
+    }
+
+    lumpinfo_t *lump = lumpinfo[lumpnum];
+
+    if (lump->size > 0)
+    {
+        W_Advise(lump->wad_file, static_cast<unsigned int>(lump->position), lump->size, WAD_ADVICE_WILLNEED);
+    }
+}
+
 #if 0
 
 //
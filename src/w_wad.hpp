@@ -72,6 +72,9 @@ extern unsigned int W_LumpNameHash(const char *s);
 void W_ReleaseLumpNum(lumpindex_t lump);
 void W_ReleaseLumpName(const char *name);
 
+void W_AdviseAll(wad_advice_t advice);
+void W_PrefetchLumpNum(lumpindex_t lump);
+
 const char *W_WadNameForLump(const lumpinfo_t *lump);
 bool     W_IsIWADLump(const lumpinfo_t *lump);
 
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <array>
+#include <type_traits>
+#include <utility>
 #include <variant>
 
 template <std::size_t, class, class>
@@ -150,36 +153,54 @@ typedef struct thinker_s {
     think_t           function {};
 } thinker_t;
 
-constexpr void call_thinker(thinker_t *thinker)
+// Thinkers are dispatched through a table of trampolines indexed by
+// the variant's alternative, rather than through std::visit.  Every
+// parameter of a thinker callback is the thinker itself, cast to the
+// type the callback expects.
+
+template <class... Args>
+inline void invoke_thinker(void (*callback)(Args...), [[maybe_unused]] thinker_t *thinker)
+{
+    callback(reinterpret_cast<Args>(thinker)...);
+}
+
+template <std::size_t index>
+inline void call_thinker_alternative([[maybe_unused]] thinker_t *thinker)
+{
+    using hook_type = std::variant_alternative_t<index, action_hook>;
+
+    // null_hook and valid_hook have nothing to call
+    if constexpr (std::is_pointer_v<hook_type>)
+    {
+        invoke_thinker(*std::get_if<index>(&thinker->function), thinker);
+    }
+}
+
+template <std::size_t... indices>
+constexpr auto make_thinker_dispatch(std::index_sequence<indices...>)
+{
+    return std::array<void (*)(thinker_t *), sizeof...(indices)> { &call_thinker_alternative<indices>... };
+}
+
+inline constexpr auto thinker_dispatch = make_thinker_dispatch(std::make_index_sequence<std::variant_size_v<action_hook>>());
+
+inline void call_thinker(thinker_t *thinker)
+{
+    // mobjs are by far the most common thinkers, call them directly
+    if (const auto *callback = std::get_if<mobj_param_action>(&thinker->function))
+    {
+        (*callback)(reinterpret_cast<mobj_t *>(thinker));
+        return;
+    }
+
+    thinker_dispatch[thinker->function.index()](thinker);
+}
+
+// True if the thinker has been marked for removal by P_RemoveThinker().
+constexpr bool thinker_is_removed(const thinker_t *thinker)
 {
-    std::visit(
-        overloaded {
-            [&](const zero_param_action &callback) { callback(); },
-            [&](const mobj_param_action &callback) { callback(reinterpret_cast<mobj_t *>(thinker)); },
-            [&](const player_psp_param_action &callback) { callback(reinterpret_cast<player_t *>(thinker), reinterpret_cast<pspdef_t *>(thinker)); },
-            [&](const thinker_param_action &callback) { callback(thinker); },
-            [&](const floormove_param_action &callback) { callback(reinterpret_cast<floormove_t *>(thinker)); },
-            [&](const polyevent_param_action &callback) { callback(reinterpret_cast<polyevent_t *>(thinker)); },
-            [&](const plat_param_action &callback) { callback(reinterpret_cast<plat_t *>(thinker)); },
-            [&](const ceiling_param_action &callback) { callback(reinterpret_cast<ceiling_t *>(thinker)); },
-            [&](const light_param_action &callback) { callback(reinterpret_cast<light_t *>(thinker)); },
-            [&](const ssthinker_param_action &callback) { callback(reinterpret_cast<ssthinker_t *>(thinker)); },
-            [&](const vldoor_param_action &callback) { callback(reinterpret_cast<vldoor_t *>(thinker)); },
-            [&](const phase_param_action &callback) { callback(reinterpret_cast<phase_t *>(thinker)); },
-            [&](const acs_param_action &callback) { callback(reinterpret_cast<acs_t *>(thinker)); },
-            [&](const pillar_param_action &callback) { callback(reinterpret_cast<pillar_t *>(thinker)); },
-            [&](const polydoor_param_action &callback) { callback(reinterpret_cast<polydoor_t *>(thinker)); },
-            [&](const floorWaggle_param_action &callback) { callback(reinterpret_cast<floorWaggle_t *>(thinker)); },
-            [&](const lightflash_param_action &callback) { callback(reinterpret_cast<lightflash_t *>(thinker)); },
-            [&](const strobe_param_action &callback) { callback(reinterpret_cast<strobe_t *>(thinker)); },
-            [&](const glow_param_action &callback) { callback(reinterpret_cast<glow_t *>(thinker)); },
-            [&](const fireflicker_param_action &callback) { callback(reinterpret_cast<fireflicker_t *>(thinker)); },
-            [&](const slidedoor_param_action &callback) { callback(reinterpret_cast<slidedoor_t *>(thinker)); },
-            [&](const mobj_player_psp_param_action &callback) {callback(reinterpret_cast<mobj_t *>(thinker), reinterpret_cast<player_t *>(thinker), reinterpret_cast<pspdef_t *>(thinker)); },
-            [&](const auto &) { return; } 
-        },
-        thinker->function
-    );
+    const auto *hook = std::get_if<valid_hook>(&thinker->function);
+    return hook != nullptr && !hook->is_valid();
 }
 
 constexpr bool is_valid(const action_hook &hook)